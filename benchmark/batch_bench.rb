@@ -0,0 +1,82 @@
+# frozen_string_literal: true
+
+# Benchmarks batch and packed Context operations on one thread and on a
+# worker pool. Each reported op processes a whole batch of BENCH_BATCH_SIZE
+# entries (default 256); divide by the batch size to compare with the
+# single-item results.
+#
+# Run with: bundle exec rake bench
+
+require 'digest'
+require 'etc'
+require_relative 'bench_helper'
+
+batch_size = Integer(ENV.fetch('BENCH_BATCH_SIZE', 256))
+worker_counts = [1, Etc.nprocessors].uniq
+
+setup = Secp256k1::Context.create
+key_pairs = setup.generate_key_pairs(batch_size)
+private_keys = key_pairs.map(&:private_key)
+public_keys = key_pairs.map(&:public_key)
+private_key_data = private_keys.map(&:data).join
+hashes = Array.new(batch_size) { |i| Digest::SHA256.digest(i.to_s) }
+signatures = setup.sign_batch(private_keys, hashes)
+# BIP-32 test vector 1 master key
+xpub = 'xpub661MyMwAqRbcFtXgS5sYJABqqG9YLmC4Q1Rdap9gSE8NqtwybGhePY2gZ29ESFjqJ' \
+       'oCu1Rupje8YtGqsefD265TMg7usUDFdp6W1EGMcet8'
+verify_records = signatures.each_with_index.map do |signature, i|
+  signature.compact + public_keys[i].compressed + hashes[i]
+end.join.freeze
+
+if Secp256k1.have_recovery?
+  recoverable_signatures = private_keys.zip(hashes).map do |private_key, hash32|
+    setup.sign_recoverable(private_key, hash32)
+  end
+  compacts, recovery_ids = recoverable_signatures.map(&:compact).transpose
+  recover_records = compacts.each_with_index.map do |compact, i|
+    compact + recovery_ids[i].chr + hashes[i]
+  end.join.freeze
+end
+
+worker_counts.each do |workers|
+  context = Secp256k1::Context.create(workers: workers)
+  suffix = " (#{batch_size}, workers: #{workers})"
+
+  benchmarks = {
+    "Context#sign_batch#{suffix}" => -> { context.sign_batch(private_keys, hashes) },
+    "Context#verify_batch#{suffix}" => lambda do
+      context.verify_batch(signatures, public_keys, hashes)
+    end,
+    "Context#verify_packed#{suffix}" => -> { context.verify_packed(verify_records) },
+    "Context#public_keys_from_private_keys#{suffix}" => lambda do
+      context.public_keys_from_private_keys(private_keys)
+    end,
+    "Context#key_pairs_from_private_key_data#{suffix}" => lambda do
+      context.key_pairs_from_private_key_data(private_key_data)
+    end
+  }
+
+  if Secp256k1.have_recovery?
+    benchmarks.merge!(
+      "Context#recover_batch#{suffix}" => lambda do
+        context.recover_batch(recoverable_signatures, hashes)
+      end,
+      "Context#recover_packed#{suffix}" => -> { context.recover_packed(recover_records) },
+      "Context#recover_public_keys_batch#{suffix}" => lambda do
+        context.recover_public_keys_batch(compacts, recovery_ids, hashes)
+      end
+    )
+  end
+
+  benchmarks["Context#derive_children#{suffix}"] = lambda do
+    context.derive_children(xpub, 0...batch_size)
+  end
+
+  if Secp256k1.have_ecdh?
+    benchmarks["Context#ecdh_batch#{suffix}"] = lambda do
+      context.ecdh_batch(private_keys.first, public_keys)
+    end
+  end
+
+  Secp256k1::Bench.run("Batch operations (workers: #{workers})", benchmarks)
+end
@@ -0,0 +1,58 @@
+# frozen_string_literal: true
+
+require 'benchmark/ips'
+require 'rbsecp256k1'
+
+module Secp256k1
+  # Shared harness for the benchmark scripts in this directory.
+  #
+  # Each script builds a list of labelled blocks and passes it to {run}, which
+  # reports throughput with benchmark-ips followed by the number of Ruby
+  # objects allocated per call to each block.
+  module Bench
+    # Number of calls averaged over when counting allocations
+    ALLOCATION_ITERATIONS = 1_000
+
+    module_function
+
+    # Benchmarks each labelled block and prints ops/sec and allocations/op.
+    #
+    # Set BENCH_FILTER to a regular expression to only run matching labels,
+    # and BENCH_TIME / BENCH_WARMUP to change the number of seconds spent
+    # measuring and warming up each block.
+    #
+    # @param title [String] heading printed before the results.
+    # @param benchmarks [Hash{String => Proc}] blocks to benchmark by label.
+    def run(title, benchmarks)
+      filter = Regexp.new(ENV.fetch('BENCH_FILTER', ''))
+      benchmarks = benchmarks.select { |label, _| filter.match?(label) }
+      return if benchmarks.empty?
+
+      puts "== #{title}"
+      Benchmark.ips do |x|
+        x.config(
+          time: Float(ENV.fetch('BENCH_TIME', 2)),
+          warmup: Float(ENV.fetch('BENCH_WARMUP', 1))
+        )
+        benchmarks.each { |label, block| x.report(label, &block) }
+      end
+
+      puts
+      puts format('%-56<label>s %12<header>s', label: 'Allocations', header: 'objects/op')
+      benchmarks.each do |label, block|
+        puts format('%-56<label>s %12.2<count>f', label: label, count: allocations_per_op(&block))
+      end
+      puts
+    end
+
+    # Counts the Ruby objects allocated by each call to the given block.
+    #
+    # @return [Float] average number of objects allocated per call.
+    def allocations_per_op
+      yield
+      before = GC.stat(:total_allocated_objects)
+      ALLOCATION_ITERATIONS.times { yield }
+      (GC.stat(:total_allocated_objects) - before).fdiv(ALLOCATION_ITERATIONS)
+    end
+  end
+end
@@ -0,0 +1,62 @@
+# frozen_string_literal: true
+
+# Benchmarks single-item Context operations.
+#
+# Run with: bundle exec rake bench
+
+require 'digest'
+require 'securerandom'
+require_relative 'bench_helper'
+
+context = Secp256k1::Context.create
+key_pair = context.generate_key_pair
+private_key_data = key_pair.private_key.data
+hash32 = Digest::SHA256.digest('rbsecp256k1 benchmark')
+signature = context.sign(key_pair.private_key, hash32)
+seed32 = SecureRandom.random_bytes(32)
+message = 'rbsecp256k1 benchmark'
+
+benchmarks = {
+  'Context.new' => -> { Secp256k1::Context.new },
+  'Context#randomize' => -> { context.randomize(seed32) },
+  'Context#generate_key_pair' => -> { context.generate_key_pair },
+  'Context#key_pair_from_private_key' => lambda do
+    context.key_pair_from_private_key(private_key_data)
+  end,
+  'Context#sign' => -> { context.sign(key_pair.private_key, hash32) },
+  'Context#verify' => -> { context.verify(signature, key_pair.public_key, hash32) },
+  'Context#sign with Digest::SHA256' => lambda do
+    context.sign(key_pair.private_key, Digest::SHA256.digest(message))
+  end,
+  'Context#sign_message' => -> { context.sign_message(key_pair.private_key, message) },
+  'Context#sign_message (keccak256)' => lambda do
+    context.sign_message(key_pair.private_key, message, digest: :keccak256)
+  end
+}
+
+if Secp256k1.have_recovery?
+  recoverable_signature = context.sign_recoverable(key_pair.private_key, hash32)
+  compact, recovery_id = recoverable_signature.compact
+
+  benchmarks.merge!(
+    'Context#sign_recoverable' => lambda do
+      context.sign_recoverable(key_pair.private_key, hash32)
+    end,
+    'Context#recoverable_signature_from_compact' => lambda do
+      context.recoverable_signature_from_compact(compact, recovery_id)
+    end,
+    'RecoverableSignature#recover_public_key' => lambda do
+      recoverable_signature.recover_public_key(hash32)
+    end
+  )
+end
+
+if Secp256k1.have_ecdh?
+  other_key_pair = context.generate_key_pair
+
+  benchmarks['Context#ecdh'] = lambda do
+    context.ecdh(other_key_pair.public_key, key_pair.private_key)
+  end
+end
+
+Secp256k1::Bench.run('Context', benchmarks)
@@ -0,0 +1,305 @@
+// bench.c - Microbenchmarks for raw libsecp256k1 calls.
+//
+// Description:
+// Measures the libsecp256k1 operations wrapped by the Ruby extension so that
+// the Ruby benchmarks in the parent directory have a native baseline to be
+// compared against. Results are printed in operations per second.
+//
+// Build and run with: bundle exec rake bench:native
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <secp256k1.h>
+
+// Include optional modules when the headers are installed
+#if defined(__has_include)
+#if __has_include(<secp256k1_recovery.h>)
+#include <secp256k1_recovery.h>
+#define HAVE_SECP256K1_RECOVERY_H 1
+#endif
+#if __has_include(<secp256k1_ecdh.h>)
+#include <secp256k1_ecdh.h>
+#define HAVE_SECP256K1_ECDH_H 1
+#endif
+#endif // defined(__has_include)
+
+// Minimum number of seconds spent measuring each operation
+#define MIN_SECONDS 1.0
+
+// Number of operations run between checks of the clock
+#define ITERATIONS_PER_CHECK 64
+
+// Inputs shared by all benchmarked operations
+typedef struct BenchState_dummy {
+  secp256k1_context *ctx;
+  unsigned char private_key[32];
+  unsigned char hash32[32];
+  secp256k1_pubkey pubkey;
+  unsigned char compressed[33];
+  unsigned char uncompressed[65];
+  secp256k1_ecdsa_signature sig;
+  unsigned char compact[64];
+  unsigned char der[72];
+  size_t der_len;
+#ifdef HAVE_SECP256K1_RECOVERY_H
+  secp256k1_ecdsa_recoverable_signature recoverable_sig;
+#endif // HAVE_SECP256K1_RECOVERY_H
+} BenchState;
+
+typedef void (*BenchFunc)(BenchState *state);
+
+static double
+Now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * Runs a benchmark for at least MIN_SECONDS and prints its throughput.
+ *
+ * \param label name printed next to the result
+ * \param func operation to be measured
+ * \param state inputs passed to func
+ */
+static void
+Run(const char *label, BenchFunc func, BenchState *state)
+{
+  double start;
+  double elapsed;
+  long iterations = 0;
+  int i;
+
+  start = Now();
+  do
+  {
+    for (i = 0; i < ITERATIONS_PER_CHECK; i++)
+    {
+      func(state);
+    }
+    iterations += ITERATIONS_PER_CHECK;
+    elapsed = Now() - start;
+  } while (elapsed < MIN_SECONDS);
+
+  printf("%-56s %12.1f ops/sec\n", label, (double)iterations / elapsed);
+}
+
+static void
+ContextCreate_bench(BenchState *state)
+{
+  secp256k1_context_destroy(
+    secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY)
+  );
+}
+
+static void
+PubkeyCreate_bench(BenchState *state)
+{
+  secp256k1_pubkey pubkey;
+
+  secp256k1_ec_pubkey_create(state->ctx, &pubkey, state->private_key);
+}
+
+static void
+Sign_bench(BenchState *state)
+{
+  secp256k1_ecdsa_signature sig;
+
+  secp256k1_ecdsa_sign(
+    state->ctx, &sig, state->hash32, state->private_key, NULL, NULL
+  );
+}
+
+static void
+Verify_bench(BenchState *state)
+{
+  secp256k1_ecdsa_verify(state->ctx, &(state->sig), state->hash32, &(state->pubkey));
+}
+
+static void
+PubkeyParseCompressed_bench(BenchState *state)
+{
+  secp256k1_pubkey pubkey;
+
+  secp256k1_ec_pubkey_parse(state->ctx, &pubkey, state->compressed, 33);
+}
+
+static void
+PubkeyParseUncompressed_bench(BenchState *state)
+{
+  secp256k1_pubkey pubkey;
+
+  secp256k1_ec_pubkey_parse(state->ctx, &pubkey, state->uncompressed, 65);
+}
+
+static void
+PubkeySerializeCompressed_bench(BenchState *state)
+{
+  unsigned char output[33];
+  size_t output_len = sizeof(output);
+
+  secp256k1_ec_pubkey_serialize(
+    state->ctx, output, &output_len, &(state->pubkey), SECP256K1_EC_COMPRESSED
+  );
+}
+
+static void
+PubkeySerializeUncompressed_bench(BenchState *state)
+{
+  unsigned char output[65];
+  size_t output_len = sizeof(output);
+
+  secp256k1_ec_pubkey_serialize(
+    state->ctx, output, &output_len, &(state->pubkey), SECP256K1_EC_UNCOMPRESSED
+  );
+}
+
+static void
+SignatureParseCompact_bench(BenchState *state)
+{
+  secp256k1_ecdsa_signature sig;
+
+  secp256k1_ecdsa_signature_parse_compact(state->ctx, &sig, state->compact);
+}
+
+static void
+SignatureParseDer_bench(BenchState *state)
+{
+  secp256k1_ecdsa_signature sig;
+
+  secp256k1_ecdsa_signature_parse_der(
+    state->ctx, &sig, state->der, state->der_len
+  );
+}
+
+static void
+SignatureSerializeCompact_bench(BenchState *state)
+{
+  unsigned char output[64];
+
+  secp256k1_ecdsa_signature_serialize_compact(state->ctx, output, &(state->sig));
+}
+
+static void
+SignatureSerializeDer_bench(BenchState *state)
+{
+  unsigned char output[72];
+  size_t output_len = sizeof(output);
+
+  secp256k1_ecdsa_signature_serialize_der(
+    state->ctx, output, &output_len, &(state->sig)
+  );
+}
+
+static void
+SignatureNormalize_bench(BenchState *state)
+{
+  secp256k1_ecdsa_signature sig;
+
+  secp256k1_ecdsa_signature_normalize(state->ctx, &sig, &(state->sig));
+}
+
+#ifdef HAVE_SECP256K1_RECOVERY_H
+static void
+SignRecoverable_bench(BenchState *state)
+{
+  secp256k1_ecdsa_recoverable_signature sig;
+
+  secp256k1_ecdsa_sign_recoverable(
+    state->ctx, &sig, state->hash32, state->private_key, NULL, NULL
+  );
+}
+
+static void
+Recover_bench(BenchState *state)
+{
+  secp256k1_pubkey pubkey;
+
+  secp256k1_ecdsa_recover(
+    state->ctx, &pubkey, &(state->recoverable_sig), state->hash32
+  );
+}
+#endif // HAVE_SECP256K1_RECOVERY_H
+
+#ifdef HAVE_SECP256K1_ECDH_H
+static void
+Ecdh_bench(BenchState *state)
+{
+  unsigned char output[32];
+
+  secp256k1_ecdh(
+    state->ctx, output, &(state->pubkey), state->private_key, NULL, NULL
+  );
+}
+#endif // HAVE_SECP256K1_ECDH_H
+
+int
+main(void)
+{
+  BenchState state;
+  size_t len;
+
+  memset(&state, 0, sizeof(state));
+  memset(state.private_key, 0x42, sizeof(state.private_key));
+  memset(state.hash32, 0x24, sizeof(state.hash32));
+
+  state.ctx = secp256k1_context_create(
+    SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY
+  );
+
+  if (secp256k1_ec_pubkey_create(state.ctx, &state.pubkey, state.private_key) != 1 ||
+      secp256k1_ecdsa_sign(state.ctx, &state.sig, state.hash32, state.private_key, NULL, NULL) != 1)
+  {
+    fprintf(stderr, "failed to set up benchmark inputs\n");
+    return 1;
+  }
+
+  len = sizeof(state.compressed);
+  secp256k1_ec_pubkey_serialize(
+    state.ctx, state.compressed, &len, &state.pubkey, SECP256K1_EC_COMPRESSED
+  );
+  len = sizeof(state.uncompressed);
+  secp256k1_ec_pubkey_serialize(
+    state.ctx, state.uncompressed, &len, &state.pubkey, SECP256K1_EC_UNCOMPRESSED
+  );
+  secp256k1_ecdsa_signature_serialize_compact(state.ctx, state.compact, &state.sig);
+  state.der_len = sizeof(state.der);
+  secp256k1_ecdsa_signature_serialize_der(
+    state.ctx, state.der, &state.der_len, &state.sig
+  );
+
+  printf("== libsecp256k1\n");
+  Run("secp256k1_context_create", ContextCreate_bench, &state);
+  Run("secp256k1_ec_pubkey_create", PubkeyCreate_bench, &state);
+  Run("secp256k1_ecdsa_sign", Sign_bench, &state);
+  Run("secp256k1_ecdsa_verify", Verify_bench, &state);
+
+#ifdef HAVE_SECP256K1_RECOVERY_H
+  secp256k1_ecdsa_sign_recoverable(
+    state.ctx, &state.recoverable_sig, state.hash32, state.private_key, NULL, NULL
+  );
+  Run("secp256k1_ecdsa_sign_recoverable", SignRecoverable_bench, &state);
+  Run("secp256k1_ecdsa_recover", Recover_bench, &state);
+#endif // HAVE_SECP256K1_RECOVERY_H
+
+#ifdef HAVE_SECP256K1_ECDH_H
+  Run("secp256k1_ecdh", Ecdh_bench, &state);
+#endif // HAVE_SECP256K1_ECDH_H
+
+  Run("secp256k1_ec_pubkey_parse (compressed)", PubkeyParseCompressed_bench, &state);
+  Run("secp256k1_ec_pubkey_parse (uncompressed)", PubkeyParseUncompressed_bench, &state);
+  Run("secp256k1_ec_pubkey_serialize (compressed)", PubkeySerializeCompressed_bench, &state);
+  Run("secp256k1_ec_pubkey_serialize (uncompressed)", PubkeySerializeUncompressed_bench, &state);
+  Run("secp256k1_ecdsa_signature_parse_compact", SignatureParseCompact_bench, &state);
+  Run("secp256k1_ecdsa_signature_parse_der", SignatureParseDer_bench, &state);
+  Run("secp256k1_ecdsa_signature_serialize_compact", SignatureSerializeCompact_bench, &state);
+  Run("secp256k1_ecdsa_signature_serialize_der", SignatureSerializeDer_bench, &state);
+  Run("secp256k1_ecdsa_signature_normalize", SignatureNormalize_bench, &state);
+
+  secp256k1_context_destroy(state.ctx);
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+# frozen_string_literal: true
+
+# Benchmarks parsing and serialization of keys and signatures.
+#
+# Run with: bundle exec rake bench
+
+require 'digest'
+require_relative 'bench_helper'
+
+context = Secp256k1::Context.create
+key_pair = context.generate_key_pair
+public_key = key_pair.public_key
+compressed = public_key.compressed
+uncompressed = public_key.uncompressed
+private_key_data = key_pair.private_key.data
+hash32 = Digest::SHA256.digest('rbsecp256k1 benchmark')
+signature = context.sign(key_pair.private_key, hash32)
+compact = signature.compact
+der_encoded = signature.der_encoded
+buffer = String.new(capacity: 128, encoding: Encoding::BINARY)
+
+benchmarks = {
+  'PublicKey.from_data (compressed)' => -> { Secp256k1::PublicKey.from_data(compressed) },
+  'PublicKey.from_data (uncompressed)' => -> { Secp256k1::PublicKey.from_data(uncompressed) },
+  'PublicKey#compressed' => -> { public_key.compressed },
+  'PublicKey#uncompressed' => -> { public_key.uncompressed },
+  'PublicKey#write_compressed' => -> { public_key.write_compressed(buffer, 0) },
+  'PrivateKey.from_data' => -> { Secp256k1::PrivateKey.from_data(private_key_data) },
+  'Signature.from_compact' => -> { Secp256k1::Signature.from_compact(compact) },
+  'Signature.from_der_encoded' => -> { Secp256k1::Signature.from_der_encoded(der_encoded) },
+  'Signature#compact' => -> { signature.compact },
+  'Signature#der_encoded' => -> { signature.der_encoded },
+  'Signature#write_compact' => -> { signature.write_compact(buffer, 0) },
+  'Signature#write_der_encoded' => -> { signature.write_der_encoded(buffer, 0) },
+  'Signature#normalized' => -> { signature.normalized }
+}
+
+if Secp256k1.have_recovery?
+  recoverable_signature = context.sign_recoverable(key_pair.private_key, hash32)
+
+  benchmarks.merge!(
+    'RecoverableSignature#compact' => -> { recoverable_signature.compact },
+    'RecoverableSignature#write_compact' => lambda do
+      recoverable_signature.write_compact(buffer, 0)
+    end
+  )
+end
+
+Secp256k1::Bench.run('Serialization', benchmarks)
@@ -6,14 +6,42 @@ require 'zip'
 
 # Recipe for downloading and building libsecp256k1 as part of installation
 class Secp256k1Recipe < MiniPortile
-  # Hard-coded URL for libsecp256k1 zipfile (HEAD of master as of 26-11-2018)
-  LIBSECP256K1_ZIP_URL = 'https://github.com/bitcoin-core/secp256k1/archive/e34ceb333b1c0e6f4115ecbb80c632ac1042fa49.zip'
+  # URL for libsecp256k1 zipfile (HEAD of master as of 26-11-2018 by default)
+  LIBSECP256K1_ZIP_URL = ENV.fetch(
+    'LIBSECP256K1_ZIP_URL',
+    'https://github.com/bitcoin-core/secp256k1/archive/e34ceb333b1c0e6f4115ecbb80c632ac1042fa49.zip'
+  )
 
   # Expected SHA-256 of the zipfile above (computed using sha256sum)
-  LIBSECP256K1_SHA256 = 'd87d3ca7ebc42edbabb0f38e79205040b24b09b3e6d1c9ac89585de9bf302143'
+  LIBSECP256K1_SHA256 = ENV.fetch(
+    'LIBSECP256K1_SHA256',
+    'd87d3ca7ebc42edbabb0f38e79205040b24b09b3e6d1c9ac89585de9bf302143'
+  )
 
   WITH_RECOVERY = ENV.fetch('WITH_RECOVERY', '1') == '1'
   WITH_ECDH = ENV.fetch('WITH_ECDH', '1') == '1'
+  WITH_SCHNORRSIG = ENV.fetch('WITH_SCHNORRSIG', '1') == '1'
+
+  # Optional configure settings for tuning the library, left to libsecp256k1's
+  # defaults when unset. Each is only understood by the releases noted.
+  TUNING_OPTIONS = {
+    # Precomputed table size for verification (0.2.0 and later)
+    'ECMULT_WINDOW' => '--with-ecmult-window',
+    # Precomputed table precision for signing (0.2.0 to 0.4.x)
+    'ECMULT_GEN_PRECISION' => '--with-ecmult-gen-precision',
+    # Precomputed table size in KiB for signing (0.5.0 and later)
+    'ECMULT_GEN_KB' => '--with-ecmult-gen-kb',
+    # Assembly optimizations: x86_64, arm32, no, or auto
+    'WITH_ASM' => '--with-asm'
+  }.freeze
+
+  # Configure options enabling each optional module, keyed by the setting that
+  # controls it. Modules newer than the fetched commit are skipped.
+  MODULE_OPTIONS = {
+    'WITH_RECOVERY' => %w[--enable-module-recovery],
+    'WITH_ECDH' => %w[--enable-module-ecdh],
+    'WITH_SCHNORRSIG' => %w[--enable-module-extrakeys --enable-module-schnorrsig]
+  }.freeze
 
   def initialize
     super('libsecp256k1', '0.0.0')
@@ -30,6 +58,23 @@ class Secp256k1Recipe < MiniPortile
 
     configure_options << "--enable-module-recovery" if WITH_RECOVERY
     configure_options << "--enable-module-ecdh" if WITH_ECDH
+    if WITH_SCHNORRSIG
+      configure_options << "--enable-module-extrakeys"
+      configure_options << "--enable-module-schnorrsig"
+    end
+
+    TUNING_OPTIONS.each do |variable, option|
+      configure_options << "#{option}=#{ENV[variable]}" if ENV[variable]
+    end
+  end
+
+  # Commits before release 0.2.0 use GMP for field inversion when it is
+  # installed, releases have no GMP dependency.
+  #
+  # @return [Boolean] true if the installed library must be linked with GMP.
+  def needs_gmp?
+    pc_file = File.join(path, 'lib', 'pkgconfig', 'libsecp256k1.pc')
+    File.exist?(pc_file) && File.read(pc_file).include?('-lgmp')
   end
 
   def configure
@@ -42,10 +87,46 @@ class Secp256k1Recipe < MiniPortile
       execute('autogen', %w[./autogen.sh])
     end
 
+    check_configure_options
     super
   end
 
+  # Checks the tuning and module options against those the fetched configure
+  # script understands. configure only warns about unknown options, so an
+  # unsupported setting would otherwise be silently ignored.
+  def check_configure_options
+    help = IO.popen(%w[sh ./configure --help], chdir: work_path, &:read)
+    supported = lambda do |option|
+      help.match?(/^\s*#{Regexp.escape(option)}(?=[=\[\s])/)
+    end
+
+    TUNING_OPTIONS.each do |variable, option|
+      next if ENV[variable].nil? || supported.call(option)
+
+      abort "#{variable} is not supported by the libsecp256k1 being built, " \
+            "its configure script has no #{option} option"
+    end
+
+    MODULE_OPTIONS.each do |variable, options|
+      unsupported = (options & configure_options).reject(&supported)
+      next if unsupported.empty?
+
+      if ENV.key?(variable)
+        abort "#{variable} is not supported by the libsecp256k1 being built, " \
+              "its configure script has no #{unsupported.join(' or ')} option"
+      end
+
+      message("skipping #{unsupported.join(', ')}, not supported by the " \
+              "libsecp256k1 being built\n")
+      self.configure_options -= options
+    end
+  end
+
   def download
+    if ENV.key?('LIBSECP256K1_ZIP_URL') && !ENV.key?('LIBSECP256K1_SHA256')
+      abort 'LIBSECP256K1_SHA256 must be set when LIBSECP256K1_ZIP_URL is'
+    end
+
     download_file_http(LIBSECP256K1_ZIP_URL, @tarball)
     verify_file(local_path: @tarball, sha256: LIBSECP256K1_SHA256)
   end
@@ -103,13 +184,49 @@ else
 
   # Also need to make sure we add the library as part of the build
   have_library("secp256k1")
-  have_library("gmp")
+  have_library("gmp") if recipe.needs_gmp?
 end
 
+# Check for the context and private key APIs of libsecp256k1 0.2.0 and later,
+# which deprecate the names used by older versions
+have_var('secp256k1_context_static', 'secp256k1.h')
+have_func('secp256k1_selftest', 'secp256k1.h')
+have_func('secp256k1_ec_seckey_tweak_add', 'secp256k1.h')
+
 # Check if we have the libsecp256k1 recoverable signature header.
 have_header('secp256k1_recovery.h')
 
 # Check if we have EC Diffie-Hellman functionality
 have_header('secp256k1_ecdh.h')
 
+# Check if we have Schnorr signature (BIP-340) functionality
+have_header('secp256k1_schnorrsig.h')
+
+# Check if we have native threads for the batch worker pool
+have_header('pthread.h')
+
+# Check if stores of public keys and signatures can be memory-mapped
+have_func('mmap', 'sys/mman.h')
+
+# Check if we have a monotonic clock for timing instrumented contexts
+have_func('clock_gettime', 'time.h')
+
+# Check if typed data payloads can be embedded in the object slot (Ruby 3.3+)
+have_const('RUBY_TYPED_EMBEDDABLE', 'ruby.h')
+
+# Check if the extension can be used from Ractors (Ruby 3.0+)
+have_func('rb_ext_ractor_safe', 'ruby.h')
+have_const('RUBY_TYPED_FROZEN_SHAREABLE', 'ruby.h')
+
+# Check if IO::Buffer objects can be read from and written to (Ruby 3.1+)
+if have_header('ruby/io/buffer.h')
+  have_func('rb_io_buffer_get_bytes_for_reading', 'ruby/io/buffer.h')
+  have_func('rb_io_buffer_get_bytes_for_writing', 'ruby/io/buffer.h')
+end
+
+# Check if other binary inputs can be read through memory views (Ruby 3.0+)
+if have_header('ruby/memory_view.h')
+  have_func('rb_memory_view_get', 'ruby/memory_view.h')
+end
+
 create_makefile('rbsecp256k1')
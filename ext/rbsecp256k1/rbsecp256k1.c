@@ -8,8 +8,21 @@
 // Dependencies:
 //   * libsecp256k1
 #include <ruby.h>
+#include <ruby/thread.h>
 #include <secp256k1.h>
 
+// libsecp256k1 0.2.0 and later deprecate the names of the context without
+// precomputed tables and of the private key tweaks. The new names are used
+// throughout and mapped back to the old ones for older releases.
+#ifndef HAVE_SECP256K1_CONTEXT_STATIC
+#define secp256k1_context_static secp256k1_context_no_precomp
+#endif // HAVE_SECP256K1_CONTEXT_STATIC
+
+#ifndef HAVE_SECP256K1_EC_SECKEY_TWEAK_ADD
+#define secp256k1_ec_seckey_tweak_add secp256k1_ec_privkey_tweak_add
+#define secp256k1_ec_seckey_tweak_mul secp256k1_ec_privkey_tweak_mul
+#endif // HAVE_SECP256K1_EC_SECKEY_TWEAK_ADD
+
 // Include recoverable signatures functionality if available
 #ifdef HAVE_SECP256K1_RECOVERY_H
 #include <secp256k1_recovery.h>
@@ -20,6 +33,47 @@
 #include <secp256k1_ecdh.h>
 #endif // HAVE_SECP256K1_ECDH_H
 
+// Include Schnorr signature (BIP-340) and x-only public key functionality
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+#include <secp256k1_extrakeys.h>
+#include <secp256k1_schnorrsig.h>
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
+// Include IO::Buffer used for binary inputs and as an output buffer
+#ifdef HAVE_RUBY_IO_BUFFER_H
+#include <ruby/io/buffer.h>
+#endif // HAVE_RUBY_IO_BUFFER_H
+
+// Include memory views used to read other binary inputs in place
+#ifdef HAVE_RB_MEMORY_VIEW_GET
+#include <ruby/memory_view.h>
+#endif // HAVE_RB_MEMORY_VIEW_GET
+
+// Include monotonic clock used to time instrumented operations
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif // HAVE_CLOCK_GETTIME
+
+// Include file I/O used to dump and load stores of public keys and signatures
+#include <errno.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif // HAVE_UNISTD_H
+
+// Include memory mapping used to load stores of public keys and signatures
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // HAVE_MMAP
+
+// Include native threads used by the batch worker pool
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#endif // HAVE_PTHREAD_H
+
 // High-level design:
 //
 // The Ruby wrapper is divided into the following hierarchical organization:
@@ -28,18 +82,27 @@
 // |--  Context
 // |--  KeyPair
 // |--  PublicKey
+// |--  PublicKeyArray
 // |--  PrivateKey
 // |--  RecoverableSignature
 // |--  SharedSecret
 // |--  Signature
+// |--  SignatureArray
 //
 // The Context class contains most of the methods that invoke libsecp256k1.
 // The KayPair, PublicKey, PrivateKey, RecoverableSignature, SharedSecret, and
-// Signature objects act as data objects and are passed to various
-// methods. Contexts are thread safe and can be used across
-// applications. Context initialization is expensive so it is recommended that
-// a single context be initialized and used throughout an application when
-// possible.
+// Signature objects act as data objects and are passed to various methods.
+// PublicKeyArray and SignatureArray store many parsed keys and signatures
+// contiguously for use with the batch methods. Contexts are thread safe and
+// can be used across applications. Context initialization is expensive so it
+// is recommended that a single context be initialized and used throughout an
+// application when possible.
+//
+// Curve operations (signing, verification, recovery, and ECDH) copy their
+// inputs onto the C stack and run without holding the GVL so that multiple
+// Ruby threads sharing a context can use multiple cores. Batch operations
+// additionally split their work across a native worker pool owned by the
+// context when it is created with more than one worker.
 //
 // Exception Hierarchy:
 //
@@ -61,6 +124,13 @@ const size_t COMPRESSED_PUBKEY_SIZE_BYTES = 33;
 // Size of a compact signature in bytes
 const size_t COMPACT_SIG_SIZE_BYTES = 64;
 
+// Size of a packed verification record: compact signature, compressed public
+// key, and 32-byte hash.
+#define VERIFY_PACKED_RECORD_SIZE (64 + 33 + 32)
+// Size of a packed recovery record: compact signature, recovery ID byte, and
+// 32-byte hash.
+#define RECOVER_PACKED_RECORD_SIZE (64 + 1 + 32)
+
 // Globally define our module and its associated classes so we can instantiate
 // objects from anywhere. The use of global variables seems to be inline with
 // how the Ruby project builds its own extension gems.
@@ -73,6 +143,8 @@ static VALUE Secp256k1_KeyPair_class;
 static VALUE Secp256k1_PublicKey_class;
 static VALUE Secp256k1_PrivateKey_class;
 static VALUE Secp256k1_Signature_class;
+static VALUE Secp256k1_PublicKeyArray_class;
+static VALUE Secp256k1_SignatureArray_class;
 
 #ifdef HAVE_SECP256K1_RECOVERY_H
 static VALUE Secp256k1_RecoverableSignature_class;
@@ -82,32 +154,101 @@ static VALUE Secp256k1_RecoverableSignature_class;
 static VALUE Secp256k1_SharedSecret_class;
 #endif // HAVE_SECP256K1_ECDH_H
 
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+static VALUE Secp256k1_XOnlyPublicKey_class;
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
 // Forward definitions for all structures
+typedef struct WorkerPool_dummy WorkerPool;
+
+// Operations counted by contexts created with stats: true
+enum {
+  STATS_SIGN,
+  STATS_VERIFY,
+  STATS_SIGN_RECOVERABLE,
+  STATS_RECOVER,
+  STATS_ECDH,
+  STATS_PUBLIC_KEY_CREATE,
+  STATS_SIGN_SCHNORR,
+  STATS_VERIFY_SCHNORR,
+  STATS_PUBLIC_KEY_TWEAK,
+  STATS_OP_COUNT
+};
+
+// Names of the operations above as keys of Context#stats
+static const char *STATS_OP_NAMES[STATS_OP_COUNT] = {
+  "sign",
+  "verify",
+  "sign_recoverable",
+  "recover",
+  "ecdh",
+  "public_key_create",
+  "sign_schnorr",
+  "verify_schnorr",
+  "public_key_tweak"
+};
+
+// Counters for one operation, updated atomically where supported since a
+// shared context may be used from several Ractors at once.
+typedef struct OpStats_dummy {
+  unsigned long long calls; // Number of entries processed
+  unsigned long long failures; // Entries that failed or did not verify
+  unsigned long long nanoseconds; // Time spent in libsecp256k1
+} OpStats;
+
 typedef struct Context_dummy {
   secp256k1_context *ctx; // Context used by libsecp256k1 library
+  unsigned int capabilities; // SECP256K1_FLAGS_BIT_CONTEXT_* tables built
+  WorkerPool *pool; // Worker pool for batch operations, NULL if single worker
+  OpStats *stats; // Per-operation counters, NULL unless instrumented
 } Context;
 
-typedef struct KeyPair_dummy {
-  VALUE public_key;
-  VALUE private_key;
-} KeyPair;
+// Flags indicating which serialized forms of a public key have been cached
+#define PUBLIC_KEY_COMPRESSED_CACHED 0x1
+#define PUBLIC_KEY_UNCOMPRESSED_CACHED 0x2
 
 typedef struct PublicKey_dummy {
   secp256k1_pubkey pubkey; // Opaque object containing public key data
+  unsigned char compressed[33]; // Cached compressed serialization
+  unsigned char uncompressed[65]; // Cached uncompressed serialization
+  int cached; // PUBLIC_KEY_*_CACHED flags for the serializations above
 } PublicKey;
 
 typedef struct PrivateKey_dummy {
   unsigned char data[32]; // Bytes comprising the private key data
 } PrivateKey;
 
+typedef struct KeyPair_dummy {
+  PublicKey public_key_data; // Public key of the pair
+  PrivateKey private_key_data; // Private key of the pair
+  VALUE public_key; // Secp256k1::PublicKey wrapper, Qnil until first read
+  VALUE private_key; // Secp256k1::PrivateKey wrapper, Qnil until first read
+} KeyPair;
+
 typedef struct Signature_dummy {
   secp256k1_ecdsa_signature sig; // Signature object, contains 64-byte signature
 } Signature;
 
+typedef struct PublicKeyArray_dummy {
+  secp256k1_pubkey *pubkeys; // Parsed public keys stored back to back
+  long size; // Number of public keys stored
+  long capacity; // Number of public keys pubkeys has room for
+  void *backing; // Loaded store pubkeys points into, NULL if heap allocated
+  size_t backing_len; // Length of backing in bytes
+} PublicKeyArray;
+
+typedef struct SignatureArray_dummy {
+  secp256k1_ecdsa_signature *sigs; // Parsed signatures stored back to back
+  long size; // Number of signatures stored
+  long capacity; // Number of signatures sigs has room for
+  void *backing; // Loaded store sigs points into, NULL if heap allocated
+  size_t backing_len; // Length of backing in bytes
+} SignatureArray;
+
 #ifdef HAVE_SECP256K1_RECOVERY_H
 typedef struct RecoverableSignature_dummy {
   secp256k1_ecdsa_recoverable_signature sig; // Recoverable signature object
-  secp256k1_context *ctx;
+  VALUE context; // Secp256k1::Context used for public key recovery
 } RecoverableSignature;
 #endif // HAVE_SECP256K1_RECOVERY_H
 
@@ -117,10 +258,311 @@ typedef struct SharedSecret_dummy {
 } SharedSecret;
 #endif // HAVE_SECP256K1_ECDH_H
 
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+typedef struct XOnlyPublicKey_dummy {
+  secp256k1_xonly_pubkey pubkey; // Opaque object containing x-only key data
+  unsigned char data[32]; // 32-byte BIP-340 serialization of pubkey
+} XOnlyPublicKey;
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
+//
+// Native worker pool
+//
+// Batch operations are split into chunks of entries which are claimed by the
+// calling thread and the worker threads of a context's pool until none
+// remain. Worker threads only ever touch the plain C data of a batch, never
+// Ruby objects, and the calling thread waits without the GVL until every
+// claimed chunk is finished.
+//
+
+// Function applied to the entries in the range [begin, end) of a batch
+typedef void (*BatchFunc)(void *data, long begin, long end);
+
+// Minimum number of entries in a batch before it is split across workers
+#define BATCH_PARALLEL_MIN_ENTRIES 16
+
+// Minimum number of entries in a batch before it is handed to a fiber scheduler
+#define BATCH_OFFLOAD_MIN_ENTRIES 16
+
+// Upper bound on the number of workers a context may be created with
+#define MAX_WORKERS 1024
+
+#ifdef HAVE_PTHREAD_H
+
+struct WorkerPool_dummy {
+  long worker_count; // Total number of threads used, including the caller
+  long thread_count; // Number of worker threads actually started
+  pthread_t *threads; // Worker threads, NULL until first started
+  pid_t pid; // Process that started the worker threads
+  pthread_mutex_t submit_lock; // Held for the duration of a batch
+  pthread_mutex_t lock; // Protects all of the fields below
+  pthread_cond_t work_available; // Signalled when a batch is submitted
+  pthread_cond_t work_done; // Signalled when the last running chunk finishes
+  BatchFunc func; // Function applied to the current batch
+  void *data; // Data passed to func
+  long count; // Number of entries in the current batch
+  long next; // First entry not yet claimed by any thread
+  long chunk_size; // Number of entries claimed at a time
+  long active; // Number of threads currently running a chunk
+  int shutdown; // Non-zero once worker threads should exit
+};
+
+/**
+ * Claims and runs chunks of the current batch until none remain.
+ *
+ * Must be called with pool->lock held, which is also held on return.
+ *
+ * \param pool worker pool whose current batch is processed
+ */
+static void
+WorkerPool_run_chunks(WorkerPool *pool)
+{
+  BatchFunc func;
+  void *data;
+  long begin;
+  long end;
+
+  while (pool->next < pool->count)
+  {
+    func = pool->func;
+    data = pool->data;
+    begin = pool->next;
+    end = begin + pool->chunk_size;
+    if (end > pool->count)
+    {
+      end = pool->count;
+    }
+
+    pool->next = end;
+    pool->active++;
+    pthread_mutex_unlock(&(pool->lock));
+
+    func(data, begin, end);
+
+    pthread_mutex_lock(&(pool->lock));
+    pool->active--;
+  }
+
+  if (pool->active == 0)
+  {
+    pthread_cond_broadcast(&(pool->work_done));
+  }
+}
+
+static void*
+WorkerPool_thread_main(void *in_pool)
+{
+  WorkerPool *pool = (WorkerPool*)in_pool;
+
+  pthread_mutex_lock(&(pool->lock));
+  while (!pool->shutdown)
+  {
+    if (pool->next < pool->count)
+    {
+      WorkerPool_run_chunks(pool);
+    }
+    else
+    {
+      pthread_cond_wait(&(pool->work_available), &(pool->lock));
+    }
+  }
+  pthread_mutex_unlock(&(pool->lock));
+
+  return NULL;
+}
+
+/**
+ * Starts the worker threads of a pool.
+ *
+ * Must be called with WorkerPool_prepare_lock held. If some threads cannot be
+ * created the pool runs with the ones that were, and if none can be the pool
+ * is left unstarted and batches run on the calling thread.
+ *
+ * \param pool worker pool to be started
+ */
+static void
+WorkerPool_start(WorkerPool *pool)
+{
+  sigset_t all_signals;
+  sigset_t old_signals;
+  long i;
+
+  // Uses malloc(3) since the Ruby allocator raises on failure, which would
+  // leave WorkerPool_prepare_lock held.
+  pool->thread_count = 0;
+  pool->threads = malloc((pool->worker_count - 1) * sizeof(pthread_t));
+  if (pool->threads == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_init(&(pool->submit_lock), NULL);
+  pthread_mutex_init(&(pool->lock), NULL);
+  pthread_cond_init(&(pool->work_available), NULL);
+  pthread_cond_init(&(pool->work_done), NULL);
+  pool->func = NULL;
+  pool->data = NULL;
+  pool->count = 0;
+  pool->next = 0;
+  pool->active = 0;
+  pool->shutdown = 0;
+
+  // Block all signals in worker threads so they are only ever delivered to
+  // threads owned by the Ruby VM.
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_signals);
+  for (i = 0; i < pool->worker_count - 1; i++)
+  {
+    if (pthread_create(&(pool->threads[i]),
+                       NULL,
+                       WorkerPool_thread_main,
+                       pool) != 0)
+    {
+      break;
+    }
+  }
+  pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+  pool->thread_count = i;
+  pool->pid = getpid();
+}
+
+// Serializes starting pools. Holding the GVL is not enough once a frozen
+// context is shared between Ractors, each of which runs under its own lock.
+static pthread_mutex_t WorkerPool_prepare_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Ensures the worker threads of a pool are running in this process.
+ *
+ * Threads are started lazily on the first batch. Threads do not survive
+ * fork(2), so a child process that inherits a started pool discards its
+ * inherited state and starts fresh threads. Must be called while holding the
+ * GVL.
+ *
+ * \param pool worker pool to be prepared
+ */
+static void
+WorkerPool_prepare(WorkerPool *pool)
+{
+  pthread_mutex_lock(&WorkerPool_prepare_lock);
+
+  if (pool->threads == NULL || pool->pid != getpid())
+  {
+    if (pool->threads != NULL)
+    {
+      free(pool->threads);
+      pool->threads = NULL;
+    }
+
+    WorkerPool_start(pool);
+  }
+
+  pthread_mutex_unlock(&WorkerPool_prepare_lock);
+}
+
+/**
+ * Runs func over every entry of a batch using all threads of the pool.
+ *
+ * The calling thread participates in the batch and returns once every entry
+ * has been processed. Should be called without holding the GVL.
+ *
+ * \param pool started worker pool
+ * \param func function applied to ranges of entries
+ * \param data data passed through to func
+ * \param count number of entries in the batch
+ */
+static void
+WorkerPool_run(WorkerPool *pool, BatchFunc func, void *data, long count)
+{
+  pthread_mutex_lock(&(pool->submit_lock));
+  pthread_mutex_lock(&(pool->lock));
+
+  pool->func = func;
+  pool->data = data;
+  pool->count = count;
+  pool->next = 0;
+  // Several chunks per thread keeps threads busy when some finish early
+  pool->chunk_size = count / ((pool->thread_count + 1) * 4);
+  if (pool->chunk_size < 1)
+  {
+    pool->chunk_size = 1;
+  }
+  pthread_cond_broadcast(&(pool->work_available));
+
+  WorkerPool_run_chunks(pool);
+  while (pool->active > 0)
+  {
+    pthread_cond_wait(&(pool->work_done), &(pool->lock));
+  }
+
+  pool->func = NULL;
+  pool->data = NULL;
+  pool->count = 0;
+  pool->next = 0;
+
+  pthread_mutex_unlock(&(pool->lock));
+  pthread_mutex_unlock(&(pool->submit_lock));
+}
+
+/**
+ * Stops all worker threads and frees the pool.
+ *
+ * \param pool worker pool to be destroyed
+ */
+static void
+WorkerPool_destroy(WorkerPool *pool)
+{
+  long i;
+
+  // Threads inherited from a parent process no longer exist
+  if (pool->threads != NULL && pool->pid == getpid())
+  {
+    pthread_mutex_lock(&(pool->lock));
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&(pool->work_available));
+    pthread_mutex_unlock(&(pool->lock));
+
+    for (i = 0; i < pool->thread_count; i++)
+    {
+      pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&(pool->work_done));
+    pthread_cond_destroy(&(pool->work_available));
+    pthread_mutex_destroy(&(pool->lock));
+    pthread_mutex_destroy(&(pool->submit_lock));
+  }
+
+  free(pool->threads);
+  xfree(pool);
+}
+
+#endif // HAVE_PTHREAD_H
+
 //
 // Typed data definitions
 //
 
+// Small data objects are allocated inline in their Ruby object slot when the
+// interpreter supports it, avoiding a second heap allocation per object. Their
+// payload is then accounted for by the slot size, so size functions only
+// report memory held outside of the object.
+#ifdef HAVE_CONST_RUBY_TYPED_EMBEDDABLE
+#define EMBEDDED_DATA_FLAGS (RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_EMBEDDABLE)
+#define EMBEDDED_DATA_SIZE(type) 0
+#else
+#define EMBEDDED_DATA_FLAGS RUBY_TYPED_FREE_IMMEDIATELY
+#define EMBEDDED_DATA_SIZE(type) sizeof(type)
+#endif // HAVE_CONST_RUBY_TYPED_EMBEDDABLE
+
+// No object is written to once frozen, so frozen objects may be shared between
+// Ractors. Objects that fill caches lazily fill them all when frozen.
+#ifdef HAVE_CONST_RUBY_TYPED_FROZEN_SHAREABLE
+#define SHAREABLE_DATA_FLAGS RUBY_TYPED_FROZEN_SHAREABLE
+#else
+#define SHAREABLE_DATA_FLAGS 0
+#endif // HAVE_CONST_RUBY_TYPED_FROZEN_SHAREABLE
+
 // Context
 static void
 Context_free(void* in_context)
@@ -128,46 +570,74 @@ Context_free(void* in_context)
   Context *context;
   context = (Context*)in_context;
   secp256k1_context_destroy(context->ctx);
+#ifdef HAVE_PTHREAD_H
+  if (context->pool != NULL)
+  {
+    WorkerPool_destroy(context->pool);
+  }
+#endif // HAVE_PTHREAD_H
+  xfree(context->stats);
   xfree(context);
 }
 
+static size_t
+Context_memsize(const void *in_context)
+{
+  const Context *context = (const Context*)in_context;
+  size_t size = sizeof(Context);
+
+  if (context->stats != NULL)
+  {
+    size += STATS_OP_COUNT * sizeof(OpStats);
+  }
+
+#ifdef HAVE_PTHREAD_H
+  if (context->pool != NULL)
+  {
+    size += sizeof(WorkerPool);
+    if (context->pool->threads != NULL)
+    {
+      size += (context->pool->worker_count - 1) * sizeof(pthread_t);
+    }
+  }
+#endif // HAVE_PTHREAD_H
+
+  return size;
+}
+
 static const rb_data_type_t Context_DataType = {
   "Context",
-  { 0, Context_free, 0 },
+  { 0, Context_free, Context_memsize },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  RUBY_TYPED_FREE_IMMEDIATELY | SHAREABLE_DATA_FLAGS
 };
 
 // PublicKey
-static void
-PublicKey_free(void *in_public_key)
+static size_t
+PublicKey_memsize(const void *in_public_key)
 {
-  PublicKey *public_key;
-  public_key = (PublicKey*)in_public_key;
-  xfree(public_key);
+  return EMBEDDED_DATA_SIZE(PublicKey);
 }
 
 static const rb_data_type_t PublicKey_DataType = {
   "PublicKey",
-  { 0, PublicKey_free, 0 },
+  { 0, RUBY_TYPED_DEFAULT_FREE, PublicKey_memsize },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
 };
 
 // PrivateKey
-static void
-PrivateKey_free(void *in_private_key)
+static size_t
+PrivateKey_memsize(const void *in_private_key)
 {
-  PrivateKey *private_key;
-  private_key = (PrivateKey*)in_private_key;
-  xfree(private_key);
+  return EMBEDDED_DATA_SIZE(PrivateKey);
 }
 
 static const rb_data_type_t PrivateKey_DataType = {
   "PrivateKey",
-  { 0, PrivateKey_free, 0 },
+  { 0, RUBY_TYPED_DEFAULT_FREE, PrivateKey_memsize },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
 };
 
 // KeyPair
@@ -176,79 +646,203 @@ KeyPair_mark(void *in_key_pair)
 {
   KeyPair *key_pair = (KeyPair*)in_key_pair;
 
-  // Mark both contained objects to ensure they are properly garbage collected
+  // Mark the wrappers that have been created so they stay alive with the pair
   rb_gc_mark(key_pair->public_key);
   rb_gc_mark(key_pair->private_key);
 }
 
-static void
-KeyPair_free(void *self)
+static size_t
+KeyPair_memsize(const void *in_key_pair)
 {
-  xfree(self);
+  return EMBEDDED_DATA_SIZE(KeyPair);
 }
 
 static const rb_data_type_t KeyPair_DataType = {
   "KeyPair",
-  { KeyPair_mark, KeyPair_free, 0 },
+  { KeyPair_mark, RUBY_TYPED_DEFAULT_FREE, KeyPair_memsize },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
 };
 
 // Signature
-static void
-Signature_free(void *in_signature)
+static size_t
+Signature_memsize(const void *in_signature)
 {
-  Signature *signature = (Signature*)in_signature;
-  xfree(signature);
+  return EMBEDDED_DATA_SIZE(Signature);
 }
 
 static const rb_data_type_t Signature_DataType = {
   "Signature",
-  { 0, Signature_free, 0 },
+  { 0, RUBY_TYPED_DEFAULT_FREE, Signature_memsize },
+  0, 0,
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
+};
+
+/**
+ * Releases the contents of a store loaded into a PublicKeyArray or
+ * SignatureArray.
+ *
+ * \param in_backing mapped or read store
+ * \param in_backing_len length of in_backing in bytes
+ */
+static void
+ReleaseBacking(void *in_backing, size_t in_backing_len)
+{
+#ifdef HAVE_MMAP
+  munmap(in_backing, in_backing_len);
+#else
+  xfree(in_backing);
+#endif // HAVE_MMAP
+}
+
+// PublicKeyArray
+static void
+PublicKeyArray_free(void *in_public_key_array)
+{
+  PublicKeyArray *public_key_array = (PublicKeyArray*)in_public_key_array;
+
+  if (public_key_array->backing != NULL)
+  {
+    ReleaseBacking(public_key_array->backing, public_key_array->backing_len);
+  }
+  else
+  {
+    xfree(public_key_array->pubkeys);
+  }
+  xfree(public_key_array);
+}
+
+// Mapped stores are backed by the page cache, so only heap memory is counted
+static size_t
+PublicKeyArray_memsize(const void *in_public_key_array)
+{
+  const PublicKeyArray *public_key_array = (
+    (const PublicKeyArray*)in_public_key_array
+  );
+
+#ifdef HAVE_MMAP
+  if (public_key_array->backing != NULL)
+  {
+    return sizeof(PublicKeyArray);
+  }
+#endif // HAVE_MMAP
+
+  return sizeof(PublicKeyArray) +
+         public_key_array->capacity * sizeof(secp256k1_pubkey);
+}
+
+static const rb_data_type_t PublicKeyArray_DataType = {
+  "PublicKeyArray",
+  { 0, PublicKeyArray_free, PublicKeyArray_memsize },
+  0, 0,
+  RUBY_TYPED_FREE_IMMEDIATELY | SHAREABLE_DATA_FLAGS
+};
+
+// SignatureArray
+static void
+SignatureArray_free(void *in_signature_array)
+{
+  SignatureArray *signature_array = (SignatureArray*)in_signature_array;
+
+  if (signature_array->backing != NULL)
+  {
+    ReleaseBacking(signature_array->backing, signature_array->backing_len);
+  }
+  else
+  {
+    xfree(signature_array->sigs);
+  }
+  xfree(signature_array);
+}
+
+static size_t
+SignatureArray_memsize(const void *in_signature_array)
+{
+  const SignatureArray *signature_array = (
+    (const SignatureArray*)in_signature_array
+  );
+
+#ifdef HAVE_MMAP
+  if (signature_array->backing != NULL)
+  {
+    return sizeof(SignatureArray);
+  }
+#endif // HAVE_MMAP
+
+  return sizeof(SignatureArray) +
+         signature_array->capacity * sizeof(secp256k1_ecdsa_signature);
+}
+
+static const rb_data_type_t SignatureArray_DataType = {
+  "SignatureArray",
+  { 0, SignatureArray_free, SignatureArray_memsize },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  RUBY_TYPED_FREE_IMMEDIATELY | SHAREABLE_DATA_FLAGS
 };
 
 // RecoverableSignature
 #ifdef HAVE_SECP256K1_RECOVERY_H
 static void
-RecoverableSignature_free(void *in_recoverable_signature)
+RecoverableSignature_mark(void *in_recoverable_signature)
 {
   RecoverableSignature *recoverable_signature = (
     (RecoverableSignature*)in_recoverable_signature
   );
 
-  secp256k1_context_destroy(recoverable_signature->ctx);
-  xfree(recoverable_signature);
+  // Mark the owning context so it outlives every signature that references it
+  rb_gc_mark(recoverable_signature->context);
+}
+
+static size_t
+RecoverableSignature_memsize(const void *in_recoverable_signature)
+{
+  return EMBEDDED_DATA_SIZE(RecoverableSignature);
 }
 
 static const rb_data_type_t RecoverableSignature_DataType = {
   "RecoverableSignature",
-  { 0, RecoverableSignature_free, 0 },
+  {
+    RecoverableSignature_mark,
+    RUBY_TYPED_DEFAULT_FREE,
+    RecoverableSignature_memsize
+  },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
 };
 #endif // HAVE_SECP256K1_RECOVERY_H
 
 // SharedSecret
 #ifdef HAVE_SECP256K1_ECDH_H
-static void
-SharedSecret_free(void *in_shared_secret)
+static size_t
+SharedSecret_memsize(const void *in_shared_secret)
 {
-  SharedSecret *shared_secret;
-
-  shared_secret = (SharedSecret*)in_shared_secret;
-  xfree(shared_secret);
+  return EMBEDDED_DATA_SIZE(SharedSecret);
 }
 
 static const rb_data_type_t SharedSecret_DataType = {
   "SharedSecret",
-  { 0, SharedSecret_free, 0 },
+  { 0, RUBY_TYPED_DEFAULT_FREE, SharedSecret_memsize },
   0, 0,
-  RUBY_TYPED_FREE_IMMEDIATELY
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
 };
 #endif // HAVE_SECP256K1_ECDH_H
 
+// XOnlyPublicKey
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+static size_t
+XOnlyPublicKey_memsize(const void *in_x_only_public_key)
+{
+  return EMBEDDED_DATA_SIZE(XOnlyPublicKey);
+}
+
+static const rb_data_type_t XOnlyPublicKey_DataType = {
+  "XOnlyPublicKey",
+  { 0, RUBY_TYPED_DEFAULT_FREE, XOnlyPublicKey_memsize },
+  0, 0,
+  EMBEDDED_DATA_FLAGS | SHAREABLE_DATA_FLAGS
+};
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
 /**
  * Macro: SUCCESS
  * 
@@ -269,1221 +863,7745 @@ typedef enum ResultT_dummy {
   RESULT_FAILURE
 } ResultT;
 
+// Message digests computed natively by the sign_message family of methods
+typedef enum DigestT_dummy {
+  DIGEST_SHA256,
+  DIGEST_DOUBLE_SHA256,
+  DIGEST_KECCAK256
+} DigestT;
+
+// SHA-256 round constants (FIPS 180-4 section 4.2.2)
+static const uint32_t SHA256_K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
 /**
- * Computes the ECDSA signature of the given 32-byte SHA-256 hash.
+ * Runs the SHA-256 compression function over one 64-byte block.
  *
- * \param in_context libsecp256k1 context
- * \param in_hash32 32-byte SHA-256 hash
- * \param in_private_key Private key to be used for signing
- * \param out_signature Signature produced during the signing proccess
- * \return RESULT_SUCCESS if the hash and signature were computed successfully,
- *   RESULT_FAILURE if signing failed or DER encoding failed.
+ * \param io_state eight word hash state to be updated
+ * \param in_block 64-byte message block
  */
-static ResultT
-SignData(secp256k1_context *in_context,
-         unsigned char *in_hash32,
-         unsigned char *in_private_key,
-         secp256k1_ecdsa_signature *out_signature)
+static void
+Sha256Transform(uint32_t *io_state, const unsigned char *in_block)
 {
-  // Sign the hash of the data
-  if (secp256k1_ecdsa_sign(in_context,
-                           out_signature,
-                           in_hash32,
-                           in_private_key,
-                           NULL,
-                           NULL) == 1)
+  uint32_t w[64];
+  uint32_t a, b, c, d, e, f, g, h, t1, t2;
+  int i;
+
+  for (i = 0; i < 16; i++)
   {
-    return RESULT_SUCCESS;
+    w[i] = ((uint32_t)in_block[i * 4] << 24) |
+           ((uint32_t)in_block[i * 4 + 1] << 16) |
+           ((uint32_t)in_block[i * 4 + 2] << 8) |
+           (uint32_t)in_block[i * 4 + 3];
+  }
+  for (i = 16; i < 64; i++)
+  {
+    w[i] = w[i - 16] +
+           (SHA256_ROTR(w[i - 15], 7) ^ SHA256_ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) +
+           w[i - 7] +
+           (SHA256_ROTR(w[i - 2], 17) ^ SHA256_ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10));
   }
 
-  return RESULT_FAILURE;
-}
+  a = io_state[0]; b = io_state[1]; c = io_state[2]; d = io_state[3];
+  e = io_state[4]; f = io_state[5]; g = io_state[6]; h = io_state[7];
 
-#ifdef HAVE_SECP256K1_RECOVERY_H
+  for (i = 0; i < 64; i++)
+  {
+    t1 = h +
+         (SHA256_ROTR(e, 6) ^ SHA256_ROTR(e, 11) ^ SHA256_ROTR(e, 25)) +
+         ((e & f) ^ (~e & g)) +
+         SHA256_K[i] +
+         w[i];
+    t2 = (SHA256_ROTR(a, 2) ^ SHA256_ROTR(a, 13) ^ SHA256_ROTR(a, 22)) +
+         ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+
+  io_state[0] += a; io_state[1] += b; io_state[2] += c; io_state[3] += d;
+  io_state[4] += e; io_state[5] += f; io_state[6] += g; io_state[7] += h;
+}
 
 /**
- * Computes the recoverable ECDSA signature of the given data.
- *
- * ECDSA signing involves the following steps:
- *   1. Compute the 32-byte SHA-256 hash of the given data.
- *   2. Sign the 32-byte hash using the private key provided.
+ * Computes the SHA-256 hash of the given data.
  *
- * \param in_context libsecp256k1 context
- * \param in_hash32 32-byte SHA-256 hash to sign
- * \param in_private_key Private key to be used for signing
- * \param out_signature Recoverable signature computed
- * \return RESULT_SUCCESS if the hash and signature were computed successfully,
- *   RESULT_FAILURE if signing failed or DER encoding failed.
+ * \param in_data data to be hashed
+ * \param in_len length of in_data in bytes
+ * \param out_hash32 32-byte hash of in_data
  */
-static ResultT
-RecoverableSignData(secp256k1_context *in_context,
-                    unsigned char *in_hash32,
-                    unsigned char *in_private_key,
-                    secp256k1_ecdsa_recoverable_signature *out_signature)
+static void
+Sha256(const unsigned char *in_data, size_t in_len, unsigned char *out_hash32)
 {
-  if (secp256k1_ecdsa_sign_recoverable(in_context,
-                                       out_signature,
-                                       in_hash32,
-                                       in_private_key,
-                                       NULL,
-                                       NULL) == 1)
+  uint32_t state[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+  unsigned char block[64];
+  uint64_t bit_len = (uint64_t)in_len * 8;
+  size_t remaining;
+  int i;
+
+  for (remaining = in_len; remaining >= 64; remaining -= 64, in_data += 64)
   {
-    return RESULT_SUCCESS;
+    Sha256Transform(state, in_data);
   }
 
-  return RESULT_FAILURE;
-}
-
-#endif // HAVE_SECP256K1_RECOVERY_H
+  // Final block(s): remaining bytes, 0x80, zero padding, 64-bit length
+  MEMZERO(block, unsigned char, 64);
+  MEMCPY(block, in_data, unsigned char, remaining);
+  block[remaining] = 0x80;
+  if (remaining >= 56)
+  {
+    Sha256Transform(state, block);
+    MEMZERO(block, unsigned char, 64);
+  }
+  for (i = 0; i < 8; i++)
+  {
+    block[63 - i] = (unsigned char)(bit_len >> (i * 8));
+  }
+  Sha256Transform(state, block);
+
+  for (i = 0; i < 8; i++)
+  {
+    out_hash32[i * 4] = (unsigned char)(state[i] >> 24);
+    out_hash32[i * 4 + 1] = (unsigned char)(state[i] >> 16);
+    out_hash32[i * 4 + 2] = (unsigned char)(state[i] >> 8);
+    out_hash32[i * 4 + 3] = (unsigned char)state[i];
+  }
+}
+
+// Keccak-f[1600] round constants
+static const uint64_t KECCAK_RC[24] = {
+  0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+  0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+  0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+  0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+  0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+  0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+  0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+  0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+// Keccak-f[1600] rotation offsets and lane permutation in pi order
+static const int KECCAK_ROTC[24] = {
+  1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+  27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
+};
+static const int KECCAK_PILN[24] = {
+  10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+  15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
+};
+
+#define KECCAK_ROTL(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+/**
+ * Applies the Keccak-f[1600] permutation to a sponge state.
+ *
+ * \param io_state 25 lane sponge state to be permuted
+ */
+static void
+KeccakF1600(uint64_t *io_state)
+{
+  uint64_t bc[5];
+  uint64_t t;
+  int round, i, j;
+
+  for (round = 0; round < 24; round++)
+  {
+    // Theta
+    for (i = 0; i < 5; i++)
+    {
+      bc[i] = io_state[i] ^ io_state[i + 5] ^ io_state[i + 10] ^
+              io_state[i + 15] ^ io_state[i + 20];
+    }
+    for (i = 0; i < 5; i++)
+    {
+      t = bc[(i + 4) % 5] ^ KECCAK_ROTL(bc[(i + 1) % 5], 1);
+      for (j = 0; j < 25; j += 5)
+      {
+        io_state[j + i] ^= t;
+      }
+    }
+
+    // Rho and pi
+    t = io_state[1];
+    for (i = 0; i < 24; i++)
+    {
+      j = KECCAK_PILN[i];
+      bc[0] = io_state[j];
+      io_state[j] = KECCAK_ROTL(t, KECCAK_ROTC[i]);
+      t = bc[0];
+    }
+
+    // Chi
+    for (j = 0; j < 25; j += 5)
+    {
+      for (i = 0; i < 5; i++)
+      {
+        bc[i] = io_state[j + i];
+      }
+      for (i = 0; i < 5; i++)
+      {
+        io_state[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+      }
+    }
+
+    // Iota
+    io_state[0] ^= KECCAK_RC[round];
+  }
+}
+
+/**
+ * Computes the Keccak-256 hash of the given data.
+ *
+ * This is the original Keccak submission padding used by Ethereum, not the
+ * standardized SHA3-256 which uses a different domain separation byte.
+ *
+ * \param in_data data to be hashed
+ * \param in_len length of in_data in bytes
+ * \param out_hash32 32-byte hash of in_data
+ */
+static void
+Keccak256(const unsigned char *in_data, size_t in_len, unsigned char *out_hash32)
+{
+  enum { RATE = 136 };
+  uint64_t state[25];
+  unsigned char block[RATE];
+  size_t remaining;
+  int i;
+
+  MEMZERO(state, uint64_t, 25);
+
+  for (remaining = in_len; ; remaining -= RATE, in_data += RATE)
+  {
+    if (remaining < RATE)
+    {
+      // Pad the final block with Keccak's 0x01 ... 0x80 multi-rate padding
+      MEMZERO(block, unsigned char, RATE);
+      MEMCPY(block, in_data, unsigned char, remaining);
+      block[remaining] |= 0x01;
+      block[RATE - 1] |= 0x80;
+      in_data = block;
+    }
+
+    for (i = 0; i < RATE / 8; i++)
+    {
+      state[i] ^= (uint64_t)in_data[i * 8] |
+                  ((uint64_t)in_data[i * 8 + 1] << 8) |
+                  ((uint64_t)in_data[i * 8 + 2] << 16) |
+                  ((uint64_t)in_data[i * 8 + 3] << 24) |
+                  ((uint64_t)in_data[i * 8 + 4] << 32) |
+                  ((uint64_t)in_data[i * 8 + 5] << 40) |
+                  ((uint64_t)in_data[i * 8 + 6] << 48) |
+                  ((uint64_t)in_data[i * 8 + 7] << 56);
+    }
+    KeccakF1600(state);
+
+    if (in_data == block)
+    {
+      break;
+    }
+  }
+
+  for (i = 0; i < 32; i++)
+  {
+    out_hash32[i] = (unsigned char)(state[i / 8] >> (8 * (i % 8)));
+  }
+}
+
+/**
+ * Computes the selected digest of the given data.
+ *
+ * \param in_digest digest algorithm to use
+ * \param in_data data to be hashed
+ * \param in_len length of in_data in bytes
+ * \param out_hash32 32-byte digest of in_data
+ */
+static void
+Digest(DigestT in_digest,
+       const unsigned char *in_data,
+       size_t in_len,
+       unsigned char *out_hash32)
+{
+  switch (in_digest)
+  {
+    case DIGEST_KECCAK256:
+      Keccak256(in_data, in_len, out_hash32);
+      break;
+    case DIGEST_DOUBLE_SHA256:
+      {
+        unsigned char inner[32];
+
+        Sha256(in_data, in_len, inner);
+        Sha256(inner, 32, out_hash32);
+      }
+      break;
+    default:
+      Sha256(in_data, in_len, out_hash32);
+      break;
+  }
+}
+
+// SHA-512 round constants
+static const uint64_t SHA512_K[80] = {
+  0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+  0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+  0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+  0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+  0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+  0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+  0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+  0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+  0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+  0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+  0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+  0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+  0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+  0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+  0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+  0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+  0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+  0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+  0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+  0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+  0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+  0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+  0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+  0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+  0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+  0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+  0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+// SHA-512 initial hash state
+static const uint64_t SHA512_INIT[8] = {
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+  0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+  0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+#define SHA512_ROTR(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+/**
+ * Runs the SHA-512 compression function over one 128-byte block.
+ *
+ * \param io_state eight word hash state to be updated
+ * \param in_block 128-byte message block
+ */
+static void
+Sha512Transform(uint64_t *io_state, const unsigned char *in_block)
+{
+  uint64_t w[80];
+  uint64_t a, b, c, d, e, f, g, h, t1, t2;
+  int i;
+  int j;
+
+  for (i = 0; i < 16; i++)
+  {
+    w[i] = 0;
+    for (j = 0; j < 8; j++)
+    {
+      w[i] = (w[i] << 8) | in_block[i * 8 + j];
+    }
+  }
+  for (i = 16; i < 80; i++)
+  {
+    w[i] = w[i - 16] +
+           (SHA512_ROTR(w[i - 15], 1) ^ SHA512_ROTR(w[i - 15], 8) ^ (w[i - 15] >> 7)) +
+           w[i - 7] +
+           (SHA512_ROTR(w[i - 2], 19) ^ SHA512_ROTR(w[i - 2], 61) ^ (w[i - 2] >> 6));
+  }
+
+  a = io_state[0]; b = io_state[1]; c = io_state[2]; d = io_state[3];
+  e = io_state[4]; f = io_state[5]; g = io_state[6]; h = io_state[7];
+
+  for (i = 0; i < 80; i++)
+  {
+    t1 = h +
+         (SHA512_ROTR(e, 14) ^ SHA512_ROTR(e, 18) ^ SHA512_ROTR(e, 41)) +
+         ((e & f) ^ (~e & g)) +
+         SHA512_K[i] +
+         w[i];
+    t2 = (SHA512_ROTR(a, 28) ^ SHA512_ROTR(a, 34) ^ SHA512_ROTR(a, 39)) +
+         ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+
+  io_state[0] += a; io_state[1] += b; io_state[2] += c; io_state[3] += d;
+  io_state[4] += e; io_state[5] += f; io_state[6] += g; io_state[7] += h;
+}
+
+/**
+ * Finishes a SHA-512 hash whose leading whole blocks were already processed.
+ *
+ * \param in_state hash state after the leading blocks
+ * \param in_tail bytes following the leading blocks, fewer than 128
+ * \param in_tail_len length of in_tail in bytes
+ * \param in_total_len length of the whole message in bytes
+ * \param out_hash64 64-byte hash of the message
+ */
+static void
+Sha512Finish(const uint64_t *in_state,
+             const unsigned char *in_tail,
+             size_t in_tail_len,
+             uint64_t in_total_len,
+             unsigned char *out_hash64)
+{
+  uint64_t state[8];
+  unsigned char block[128];
+  int i;
+
+  MEMCPY(state, in_state, uint64_t, 8);
+
+  // Final block(s): tail bytes, 0x80, zero padding, 128-bit length
+  MEMZERO(block, unsigned char, 128);
+  MEMCPY(block, in_tail, unsigned char, in_tail_len);
+  block[in_tail_len] = 0x80;
+  if (in_tail_len >= 112)
+  {
+    Sha512Transform(state, block);
+    MEMZERO(block, unsigned char, 128);
+  }
+  for (i = 0; i < 8; i++)
+  {
+    block[127 - i] = (unsigned char)((in_total_len * 8) >> (i * 8));
+  }
+  block[119] = (unsigned char)(in_total_len >> 61);
+  Sha512Transform(state, block);
+
+  for (i = 0; i < 64; i++)
+  {
+    out_hash64[i] = (unsigned char)(state[i / 8] >> (56 - 8 * (i % 8)));
+  }
+}
+
+// HMAC-SHA512 keyed once and reused for many short messages
+typedef struct HmacSha512_dummy {
+  uint64_t inner[8]; // SHA-512 state after the key XOR ipad block
+  uint64_t outer[8]; // SHA-512 state after the key XOR opad block
+} HmacSha512;
+
+/**
+ * Precomputes the inner and outer HMAC-SHA512 states for a key.
+ *
+ * \param out_hmac states to be initialized
+ * \param in_key HMAC key, at most 128 bytes
+ * \param in_key_len length of in_key in bytes
+ */
+static void
+HmacSha512_init(HmacSha512 *out_hmac,
+                const unsigned char *in_key,
+                size_t in_key_len)
+{
+  unsigned char pad[128];
+  size_t i;
+
+  MEMCPY(out_hmac->inner, SHA512_INIT, uint64_t, 8);
+  MEMCPY(out_hmac->outer, SHA512_INIT, uint64_t, 8);
+
+  MEMZERO(pad, unsigned char, 128);
+  MEMCPY(pad, in_key, unsigned char, in_key_len);
+  for (i = 0; i < 128; i++)
+  {
+    pad[i] ^= 0x36;
+  }
+  Sha512Transform(out_hmac->inner, pad);
+  for (i = 0; i < 128; i++)
+  {
+    pad[i] ^= 0x36 ^ 0x5c;
+  }
+  Sha512Transform(out_hmac->outer, pad);
+}
+
+/**
+ * Computes the HMAC-SHA512 of a short message using precomputed key states.
+ *
+ * \param in_hmac states from HmacSha512_init
+ * \param in_data message to authenticate, fewer than 128 bytes
+ * \param in_len length of in_data in bytes
+ * \param out_mac64 64-byte message authentication code
+ */
+static void
+HmacSha512_mac(const HmacSha512 *in_hmac,
+               const unsigned char *in_data,
+               size_t in_len,
+               unsigned char *out_mac64)
+{
+  unsigned char inner_hash[64];
+
+  Sha512Finish(in_hmac->inner, in_data, in_len, 128 + in_len, inner_hash);
+  Sha512Finish(in_hmac->outer, inner_hash, 64, 128 + 64, out_mac64);
+}
+
+// Base58 alphabet used by Bitcoin
+static const char BASE58_ALPHABET[] =
+  "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+/**
+ * Decodes a Base58Check string of a known length.
+ *
+ * \param in_encoded Base58 characters
+ * \param in_encoded_len number of characters in in_encoded
+ * \param out_data decoded payload without the checksum
+ * \param in_data_len exact length of the payload in bytes, at most 128
+ * \return 1 if the string decodes to in_data_len bytes and its checksum
+ *   matches, 0 otherwise
+ */
+static int
+Base58CheckDecode(const char *in_encoded,
+                  long in_encoded_len,
+                  unsigned char *out_data,
+                  long in_data_len)
+{
+  unsigned char decoded[128 + 4];
+  unsigned char checksum[32];
+  const char *digit;
+  long decoded_len;
+  long leading_ones;
+  long i;
+  long j;
+  unsigned int carry;
+
+  decoded_len = in_data_len + 4;
+  MEMZERO(decoded, unsigned char, decoded_len);
+
+  for (leading_ones = 0;
+       leading_ones < in_encoded_len && in_encoded[leading_ones] == '1';
+       leading_ones++);
+
+  for (i = 0; i < in_encoded_len; i++)
+  {
+    digit = memchr(BASE58_ALPHABET, in_encoded[i], 58);
+    if (digit == NULL)
+    {
+      return 0;
+    }
+
+    carry = (unsigned int)(digit - BASE58_ALPHABET);
+    for (j = decoded_len - 1; j >= 0; j--)
+    {
+      carry += 58 * (unsigned int)decoded[j];
+      decoded[j] = (unsigned char)carry;
+      carry >>= 8;
+    }
+    if (carry != 0)
+    {
+      return 0;
+    }
+  }
+
+  // Each leading '1' encodes exactly one leading zero byte
+  for (i = 0; i < decoded_len && decoded[i] == 0; i++);
+  if (i != leading_ones)
+  {
+    return 0;
+  }
+
+  Digest(DIGEST_DOUBLE_SHA256, decoded, in_data_len, checksum);
+  if (memcmp(checksum, decoded + in_data_len, 4) != 0)
+  {
+    return 0;
+  }
+
+  MEMCPY(out_data, decoded, unsigned char, in_data_len);
+
+  return 1;
+}
+
+// Nonce generation options accepted by the ECDSA signing methods
+typedef struct NonceOptions_dummy {
+  unsigned char data[32]; // Extra entropy mixed into RFC6979
+  int has_data; // Non-zero if data is passed to RFC6979
+} NonceOptions;
+
+/**
+ * Computes the ECDSA signature of the given 32-byte SHA-256 hash.
+ *
+ * \param in_context libsecp256k1 context
+ * \param in_hash32 32-byte SHA-256 hash
+ * \param in_private_key Private key to be used for signing
+ * \param in_nonce nonce generation options, or NULL for plain RFC6979
+ * \param out_signature Signature produced during the signing proccess
+ * \return RESULT_SUCCESS if the hash and signature were computed successfully,
+ *   RESULT_FAILURE if signing failed or DER encoding failed.
+ */
+static ResultT
+SignData(const secp256k1_context *in_context,
+         unsigned char *in_hash32,
+         unsigned char *in_private_key,
+         const NonceOptions *in_nonce,
+         secp256k1_ecdsa_signature *out_signature)
+{
+  // Sign the hash of the data
+  if (secp256k1_ecdsa_sign(in_context,
+                           out_signature,
+                           in_hash32,
+                           in_private_key,
+                           NULL,
+                           in_nonce && in_nonce->has_data ?
+                             in_nonce->data : NULL) == 1)
+  {
+    return RESULT_SUCCESS;
+  }
+
+  return RESULT_FAILURE;
+}
+
+#ifdef HAVE_SECP256K1_RECOVERY_H
+
+/**
+ * Computes the recoverable ECDSA signature of the given data.
+ *
+ * ECDSA signing involves the following steps:
+ *   1. Compute the 32-byte SHA-256 hash of the given data.
+ *   2. Sign the 32-byte hash using the private key provided.
+ *
+ * \param in_context libsecp256k1 context
+ * \param in_hash32 32-byte SHA-256 hash to sign
+ * \param in_private_key Private key to be used for signing
+ * \param in_nonce nonce generation options, or NULL for plain RFC6979
+ * \param out_signature Recoverable signature computed
+ * \return RESULT_SUCCESS if the hash and signature were computed successfully,
+ *   RESULT_FAILURE if signing failed or DER encoding failed.
+ */
+static ResultT
+RecoverableSignData(const secp256k1_context *in_context,
+                    unsigned char *in_hash32,
+                    unsigned char *in_private_key,
+                    const NonceOptions *in_nonce,
+                    secp256k1_ecdsa_recoverable_signature *out_signature)
+{
+  if (secp256k1_ecdsa_sign_recoverable(in_context,
+                                       out_signature,
+                                       in_hash32,
+                                       in_private_key,
+                                       NULL,
+                                       in_nonce && in_nonce->has_data ?
+                                         in_nonce->data : NULL) == 1)
+  {
+    return RESULT_SUCCESS;
+  }
+
+  return RESULT_FAILURE;
+}
+
+#endif // HAVE_SECP256K1_RECOVERY_H
+
+/**
+ * Returns the compressed serialization of a public key, serializing and
+ * caching it on first use.
+ *
+ * \param in_public_key public key to be serialized
+ * \return 33-byte compressed serialization owned by in_public_key
+ */
+static const unsigned char*
+PublicKey_compressed_data(PublicKey *in_public_key)
+{
+  size_t serialized_pubkey_len = COMPRESSED_PUBKEY_SIZE_BYTES;
+
+  if (!(in_public_key->cached & PUBLIC_KEY_COMPRESSED_CACHED))
+  {
+    secp256k1_ec_pubkey_serialize(secp256k1_context_static,
+                                  in_public_key->compressed,
+                                  &serialized_pubkey_len,
+                                  &(in_public_key->pubkey),
+                                  SECP256K1_EC_COMPRESSED);
+    in_public_key->cached |= PUBLIC_KEY_COMPRESSED_CACHED;
+  }
+
+  return in_public_key->compressed;
+}
+
+/**
+ * Returns the uncompressed serialization of a public key, serializing and
+ * caching it on first use.
+ *
+ * \param in_public_key public key to be serialized
+ * \return 65-byte uncompressed serialization owned by in_public_key
+ */
+static const unsigned char*
+PublicKey_uncompressed_data(PublicKey *in_public_key)
+{
+  size_t serialized_pubkey_len = UNCOMPRESSED_PUBKEY_SIZE_BYTES;
+
+  if (!(in_public_key->cached & PUBLIC_KEY_UNCOMPRESSED_CACHED))
+  {
+    secp256k1_ec_pubkey_serialize(secp256k1_context_static,
+                                  in_public_key->uncompressed,
+                                  &serialized_pubkey_len,
+                                  &(in_public_key->pubkey),
+                                  SECP256K1_EC_UNCOMPRESSED);
+    in_public_key->cached |= PUBLIC_KEY_UNCOMPRESSED_CACHED;
+  }
+
+  return in_public_key->uncompressed;
+}
+
+/**
+ * Writes serialized data into a caller-provided buffer.
+ *
+ * Strings are appended to when no offset is given and grow as needed when
+ * writing at an offset. IO::Buffer objects are never resized, so an offset is
+ * required and the data must fit.
+ *
+ * \param in_buffer String or IO::Buffer to write into
+ * \param in_offset Integer byte offset to write at, or nil to append
+ * \param in_data serialized data to be written
+ * \param in_data_len length of in_data in bytes
+ * \return Integer offset just past the written data
+ * \raise Secp256k1::Error if the offset is invalid or the data does not fit
+ * \raise TypeError if in_buffer is not a String or IO::Buffer
+ */
+static VALUE
+WriteToBuffer(VALUE in_buffer,
+              VALUE in_offset,
+              const unsigned char *in_data,
+              long in_data_len)
+{
+  long offset;
+
+  if (RB_TYPE_P(in_buffer, T_STRING))
+  {
+    if (NIL_P(in_offset))
+    {
+      rb_str_cat(in_buffer, (const char*)in_data, in_data_len);
+      return LONG2NUM(RSTRING_LEN(in_buffer));
+    }
+
+    offset = NUM2LONG(in_offset);
+    if (offset < 0 || offset > RSTRING_LEN(in_buffer))
+    {
+      rb_raise(Secp256k1_Error_class, "offset is outside of the buffer");
+    }
+
+    if (offset + in_data_len > RSTRING_LEN(in_buffer))
+    {
+      rb_str_resize(in_buffer, offset + in_data_len);
+    }
+    else
+    {
+      rb_str_modify(in_buffer);
+    }
+
+    MEMCPY(RSTRING_PTR(in_buffer) + offset, in_data, unsigned char, in_data_len);
+    return LONG2NUM(offset + in_data_len);
+  }
+
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_WRITING
+  if (rb_obj_is_kind_of(in_buffer, rb_cIOBuffer))
+  {
+    void *base;
+    size_t size;
+
+    if (NIL_P(in_offset))
+    {
+      rb_raise(
+        Secp256k1_Error_class,
+        "offset is required when writing to an IO::Buffer"
+      );
+    }
+
+    offset = NUM2LONG(in_offset);
+    rb_io_buffer_get_bytes_for_writing(in_buffer, &base, &size);
+    if (offset < 0 ||
+        (size_t)offset > size ||
+        size - (size_t)offset < (size_t)in_data_len)
+    {
+      rb_raise(Secp256k1_Error_class, "buffer is too small");
+    }
+
+    MEMCPY((unsigned char*)base + offset, in_data, unsigned char, in_data_len);
+    return LONG2NUM(offset + in_data_len);
+  }
+#endif // HAVE_RB_IO_BUFFER_GET_BYTES_FOR_WRITING
+
+  rb_raise(
+    rb_eTypeError,
+    "wrong argument type %s (expected String or IO::Buffer)",
+    rb_obj_classname(in_buffer)
+  );
+}
+
+/**
+ * Borrows the bytes of a String or IO::Buffer without copying them.
+ *
+ * \param in_object object to read from
+ * \param out_data set to the first byte of the object's data
+ * \param out_len set to the length of the object's data in bytes
+ * \return 1 if in_object is a String or IO::Buffer, 0 otherwise
+ */
+static int
+BorrowBytes(VALUE in_object, const unsigned char **out_data, long *out_len)
+{
+  if (RB_TYPE_P(in_object, T_STRING))
+  {
+    *out_data = (const unsigned char*)RSTRING_PTR(in_object);
+    *out_len = RSTRING_LEN(in_object);
+    return 1;
+  }
+
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+  if (rb_obj_is_kind_of(in_object, rb_cIOBuffer))
+  {
+    const void *base;
+    size_t size;
+
+    rb_io_buffer_get_bytes_for_reading(in_object, &base, &size);
+    *out_data = (const unsigned char*)base;
+    *out_len = (long)size;
+    return 1;
+  }
+#endif // HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+
+  return 0;
+}
+
+/**
+ * Reads the bytes of a binary input argument.
+ *
+ * Strings and IO::Buffer objects are read in place. Any other object that
+ * exports a memory view has at most in_scratch_len bytes copied into
+ * in_scratch so that the view is released before returning and cannot leak
+ * if the caller raises. Callers must check out_len before reading, as only
+ * the first in_scratch_len bytes of a larger memory view are available.
+ *
+ * \param in_object String, IO::Buffer, or memory view to read from
+ * \param in_scratch storage for bytes copied out of a memory view
+ * \param in_scratch_len size of in_scratch in bytes
+ * \param out_len set to the length of the input in bytes
+ * \return pointer to the input bytes, valid until Ruby code next runs
+ * \raise TypeError if in_object cannot be read as binary data
+ */
+static const unsigned char*
+InputBytes(VALUE in_object,
+           unsigned char *in_scratch,
+           long in_scratch_len,
+           long *out_len)
+{
+  const unsigned char *data;
+
+  if (BorrowBytes(in_object, &data, out_len))
+  {
+    return data;
+  }
+
+#ifdef HAVE_RB_MEMORY_VIEW_GET
+  {
+    rb_memory_view_t view;
+
+    if (rb_memory_view_get(in_object, &view, RUBY_MEMORY_VIEW_SIMPLE))
+    {
+      *out_len = (long)view.byte_size;
+      MEMCPY(
+        in_scratch,
+        view.data,
+        unsigned char,
+        *out_len < in_scratch_len ? *out_len : in_scratch_len
+      );
+      rb_memory_view_release(&view);
+      return in_scratch;
+    }
+  }
+#endif // HAVE_RB_MEMORY_VIEW_GET
+
+  rb_raise(
+    rb_eTypeError,
+    "wrong argument type %s (expected String, IO::Buffer, or memory view)",
+    rb_obj_classname(in_object)
+  );
+}
+
+/**
+ * Reads the digest: keyword argument of the *_message methods.
+ *
+ * \param in_opts keyword arguments hash, or Qnil
+ * \param in_allow_rest if non-zero the digest: key is removed and any other
+ *   keys are left for the caller to parse, otherwise other keys are rejected
+ * \return selected digest, DIGEST_SHA256 if none was given
+ * \raise ArgumentError if the digest is not supported or an unknown keyword
+ *   was given
+ */
+static DigestT
+DigestOption(VALUE in_opts, int in_allow_rest)
+{
+  static ID kwarg_id;
+  static ID sha256_id;
+  static ID double_sha256_id;
+  static ID keccak256_id;
+  VALUE digest;
+  ID digest_id;
+
+  if (!kwarg_id)
+  {
+    CONST_ID(kwarg_id, "digest");
+    CONST_ID(sha256_id, "sha256");
+    CONST_ID(double_sha256_id, "double_sha256");
+    CONST_ID(keccak256_id, "keccak256");
+  }
+
+  digest = Qundef;
+  rb_get_kwargs(in_opts, &kwarg_id, 0, in_allow_rest ? -2 : 1, &digest);
+  if (digest == Qundef)
+  {
+    return DIGEST_SHA256;
+  }
+
+  if (SYMBOL_P(digest))
+  {
+    digest_id = SYM2ID(digest);
+    if (digest_id == sha256_id)
+    {
+      return DIGEST_SHA256;
+    }
+    if (digest_id == double_sha256_id)
+    {
+      return DIGEST_DOUBLE_SHA256;
+    }
+    if (digest_id == keccak256_id)
+    {
+      return DIGEST_KECCAK256;
+    }
+  }
+
+  rb_raise(
+    rb_eArgError,
+    "unsupported digest %"PRIsVALUE" (expected :sha256, :double_sha256, or :keccak256)",
+    rb_inspect(digest)
+  );
+}
+
+/**
+ * Hashes a message argument in place.
+ *
+ * Strings, IO::Buffer objects, and memory views are hashed directly from
+ * their own storage without being copied.
+ *
+ * \param in_message String, IO::Buffer, or memory view to be hashed
+ * \param in_digest digest algorithm to use
+ * \param out_hash32 32-byte digest of the message
+ * \raise TypeError if in_message cannot be read as binary data
+ */
+static void
+HashMessage(VALUE in_message, DigestT in_digest, unsigned char *out_hash32)
+{
+  const unsigned char *data;
+  long data_len;
+
+  if (BorrowBytes(in_message, &data, &data_len))
+  {
+    Digest(in_digest, data, (size_t)data_len, out_hash32);
+    return;
+  }
+
+#ifdef HAVE_RB_MEMORY_VIEW_GET
+  {
+    rb_memory_view_t view;
+
+    if (rb_memory_view_get(in_message, &view, RUBY_MEMORY_VIEW_SIMPLE))
+    {
+      Digest(
+        in_digest,
+        (const unsigned char*)view.data,
+        (size_t)view.byte_size,
+        out_hash32
+      );
+      rb_memory_view_release(&view);
+      return;
+    }
+  }
+#endif // HAVE_RB_MEMORY_VIEW_GET
+
+  rb_raise(
+    rb_eTypeError,
+    "wrong argument type %s (expected String, IO::Buffer, or memory view)",
+    rb_obj_classname(in_message)
+  );
+}
+
+/**
+ * Reads the normalize: keyword argument of signature parsing and verification.
+ *
+ * \param in_opts keyword arguments hash, or Qnil
+ * \return non-zero if signatures should be normalized to lower-S form
+ * \raise ArgumentError if an unknown keyword was given
+ */
+static int
+NormalizeOption(VALUE in_opts)
+{
+  static ID kwarg_id;
+  VALUE normalize;
+
+  if (!kwarg_id)
+  {
+    CONST_ID(kwarg_id, "normalize");
+  }
+
+  normalize = Qundef;
+  rb_get_kwargs(in_opts, &kwarg_id, 0, 1, &normalize);
+
+  return normalize != Qundef && RTEST(normalize);
+}
+
+// Atomic counter updates, falling back to plain updates under the GVL on
+// compilers without the __atomic builtins.
+#ifdef __ATOMIC_RELAXED
+#define STATS_ADD(counter, value) \
+  __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+#define STATS_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define STATS_TAKE(counter) __atomic_exchange_n(&(counter), 0, __ATOMIC_RELAXED)
+#else
+#define STATS_ADD(counter, value) ((counter) += (value))
+#define STATS_LOAD(counter) (counter)
+#define STATS_TAKE(counter) StatsTake(&(counter))
+
+static unsigned long long
+StatsTake(unsigned long long *in_counter)
+{
+  unsigned long long value = *in_counter;
+
+  *in_counter = 0;
+  return value;
+}
+#endif // __ATOMIC_RELAXED
+
+/**
+ * Reads the monotonic clock used to time instrumented operations.
+ *
+ * \return current time in nanoseconds, or 0 if no monotonic clock exists
+ */
+static unsigned long long
+StatsClock(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long)now.tv_sec * 1000000000ULL +
+         (unsigned long long)now.tv_nsec;
+#else
+  return 0;
+#endif // HAVE_CLOCK_GETTIME
+}
+
+/**
+ * Marks the start of an operation timed by StatsRecord.
+ *
+ * \param in_context context the operation will use
+ * \return start time to pass to StatsRecord, 0 if in_context is not
+ *   instrumented
+ */
+static unsigned long long
+StatsStart(Context *in_context)
+{
+  return in_context->stats != NULL ? StatsClock() : 0;
+}
+
+/**
+ * Adds a finished operation to the counters of an instrumented context.
+ *
+ * Does nothing for contexts created without stats: true, so callers only
+ * need to compute failure counts when in_context->stats is set.
+ *
+ * \param in_context context the operation used
+ * \param in_op STATS_* operation performed
+ * \param in_calls number of entries processed
+ * \param in_failures number of entries that failed
+ * \param in_start value returned by StatsStart before the operation
+ */
+static void
+StatsRecord(Context *in_context,
+            int in_op,
+            long in_calls,
+            long in_failures,
+            unsigned long long in_start)
+{
+  OpStats *stats;
+
+  if (in_context->stats == NULL)
+  {
+    return;
+  }
+
+  stats = &(in_context->stats[in_op]);
+  STATS_ADD(stats->calls, (unsigned long long)in_calls);
+  STATS_ADD(stats->failures, (unsigned long long)in_failures);
+  STATS_ADD(stats->nanoseconds, StatsClock() - in_start);
+}
+
+/**
+ * Counts the failed entries in the output of a packed batch operation.
+ *
+ * Packed operations mark a failed entry by zeroing its output, and no
+ * successful output starts with a zero byte.
+ *
+ * \param in_output output buffer of the batch
+ * \param in_count number of entries in the batch
+ * \param in_stride size of each entry's output in bytes
+ * \return number of entries whose output starts with a zero byte
+ */
+static long
+CountPackedFailures(const unsigned char *in_output,
+                    long in_count,
+                    size_t in_stride)
+{
+  long failures = 0;
+  long i;
+
+  for (i = 0; i < in_count; i++)
+  {
+    failures += in_output[i * in_stride] == 0;
+  }
+
+  return failures;
+}
+
+/**
+ * Ensures a context has the precomputed tables needed for an operation.
+ *
+ * libsecp256k1 aborts the process when an operation is attempted on a context
+ * that was created without the tables it needs, so operations check the
+ * context's capabilities up front and raise instead.
+ *
+ * \param in_context context the operation will use
+ * \param in_capability SECP256K1_FLAGS_BIT_CONTEXT_SIGN or
+ *   SECP256K1_FLAGS_BIT_CONTEXT_VERIFY
+ * \raise Secp256k1::Error if in_context lacks in_capability
+ */
+static void
+RequireCapability(Context *in_context, unsigned int in_capability)
+{
+  if (in_context->capabilities & in_capability)
+  {
+    return;
+  }
+
+  rb_raise(
+    Secp256k1_Error_class,
+    "context was not created with the :%s capability",
+    in_capability == SECP256K1_FLAGS_BIT_CONTEXT_SIGN ? "sign" : "verify"
+  );
+}
+
+/**
+ * Reads the nonce keyword arguments of a signing method.
+ *
+ * `extra_entropy:` is mixed into the RFC6979 nonce derivation.
+ *
+ * \param out_nonce nonce options to be filled in
+ * \param in_opts keyword arguments hash, or Qnil
+ * \raise Secp256k1::Error if extra_entropy is not 32 bytes
+ */
+static void
+NonceOptions_init(NonceOptions *out_nonce, VALUE in_opts)
+{
+  static ID kwarg_id;
+  VALUE extra_entropy;
+  unsigned char scratch[32];
+  const unsigned char *bytes;
+  long bytes_len;
+
+  if (!kwarg_id)
+  {
+    CONST_ID(kwarg_id, "extra_entropy");
+  }
+
+  out_nonce->has_data = 0;
+  extra_entropy = Qundef;
+  rb_get_kwargs(in_opts, &kwarg_id, 0, 1, &extra_entropy);
+  if (extra_entropy == Qundef || NIL_P(extra_entropy))
+  {
+    return;
+  }
+
+  bytes = InputBytes(extra_entropy, scratch, sizeof(scratch), &bytes_len);
+  if (bytes_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "extra_entropy must be 32 bytes in length");
+  }
+
+  MEMCPY(out_nonce->data, bytes, unsigned char, 32);
+  out_nonce->has_data = 1;
+}
+
+/**
+ * Randomizes the signing tables of a context with the given seed.
+ *
+ * \param in_context context to be randomized
+ * \param in_seed32 Ruby string containing 32 bytes of random data
+ * \raise Secp256k1::Error if the seed is not 32 bytes or randomization fails
+ */
+static void
+RandomizeContext(Context *in_context, VALUE in_seed32)
+{
+  Check_Type(in_seed32, T_STRING);
+  if (RSTRING_LEN(in_seed32) != 32)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "context_randomization_bytes must be 32 bytes in length"
+    );
+  }
+
+  if (secp256k1_context_randomize(
+        in_context->ctx, (unsigned char*)RSTRING_PTR(in_seed32)) != 1)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "context randomization failed"
+    );
+  }
+}
+
+/**
+ * Runs the given function without holding the Ruby global VM lock (GVL).
+ *
+ * libsecp256k1 never calls back into Ruby, so curve operations can run in
+ * parallel with other Ruby threads. Callers must copy their inputs out of Ruby
+ * objects beforehand since other threads may modify those objects while the
+ * lock is released.
+ *
+ * \param in_func function to be called without the GVL
+ * \param in_args arguments passed through to in_func
+ */
+static void
+WithoutGVL(void *(*in_func)(void*), void *in_args)
+{
+  rb_thread_call_without_gvl(in_func, in_args, NULL, NULL);
+}
+
+// Arguments for running a batch operation without the GVL
+typedef struct BatchArgs_dummy {
+  WorkerPool *pool; // Pool to split the batch across, NULL to run inline
+  BatchFunc func; // Function applied to ranges of entries
+  void *data; // Data passed through to func
+  long count; // Number of entries in the batch
+} BatchArgs;
+
+static void*
+RunBatch_without_gvl(void *in_args)
+{
+  BatchArgs *args = (BatchArgs*)in_args;
+
+#ifdef HAVE_PTHREAD_H
+  if (args->pool != NULL)
+  {
+    WorkerPool_run(args->pool, args->func, args->data, args->count);
+    return NULL;
+  }
+#endif // HAVE_PTHREAD_H
+
+  args->func(args->data, 0, args->count);
+
+  return NULL;
+}
+
+/**
+ * Runs a batch operation without the GVL.
+ *
+ * The batch is split across the context's worker pool if it has one and the
+ * batch is large enough, otherwise it runs entirely on the calling thread.
+ * All data used by func must have been copied out of Ruby objects.
+ *
+ * When called from a fiber whose scheduler implements blocking_operation_wait
+ * (Ruby 3.5+), large batches are offloaded to the scheduler so other fibers
+ * on the thread keep running until the batch finishes.
+ *
+ * \param in_context context owning the worker pool
+ * \param in_func function applied to ranges of entries
+ * \param in_data data passed through to in_func
+ * \param in_count number of entries in the batch
+ */
+static void
+RunBatch(Context *in_context, BatchFunc in_func, void *in_data, long in_count)
+{
+  BatchArgs args;
+
+  args.pool = NULL;
+  args.func = in_func;
+  args.data = in_data;
+  args.count = in_count;
+
+#ifdef HAVE_PTHREAD_H
+  if (in_context->pool != NULL && in_count >= BATCH_PARALLEL_MIN_ENTRIES)
+  {
+    WorkerPool_prepare(in_context->pool);
+    if (in_context->pool->thread_count > 0)
+    {
+      args.pool = in_context->pool;
+    }
+  }
+#endif // HAVE_PTHREAD_H
+
+#ifdef RB_NOGVL_OFFLOAD_SAFE
+  if (in_count >= BATCH_OFFLOAD_MIN_ENTRIES)
+  {
+    rb_nogvl(RunBatch_without_gvl, &args, NULL, NULL, RB_NOGVL_OFFLOAD_SAFE);
+    return;
+  }
+#endif // RB_NOGVL_OFFLOAD_SAFE
+
+  WithoutGVL(RunBatch_without_gvl, &args);
+}
+
+// Arguments for running a batch over a locked buffer
+typedef struct LockedBatchArgs_dummy {
+  Context *context; // Context owning the worker pool
+  BatchFunc func; // Function applied to ranges of entries
+  void *data; // Data passed through to func
+  long count; // Number of entries in the batch
+} LockedBatchArgs;
+
+static VALUE
+RunLockedBatch_body(VALUE in_args)
+{
+  LockedBatchArgs *args = (LockedBatchArgs*)in_args;
+
+  RunBatch(args->context, args->func, args->data, args->count);
+
+  return Qnil;
+}
+
+static VALUE
+UnlockBuffer(VALUE in_buffer)
+{
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+  if (!RB_TYPE_P(in_buffer, T_STRING))
+  {
+    rb_io_buffer_unlock(in_buffer);
+    return Qnil;
+  }
+#endif // HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+
+  rb_str_unlocktmp(in_buffer);
+
+  return Qnil;
+}
+
+/**
+ * Calls a function while a String or IO::Buffer is locked.
+ *
+ * Unfrozen strings and IO::Buffer objects are locked against modification
+ * until in_body returns or raises, so that neither other threads nor Ruby code
+ * called by in_body can resize or free them. Frozen strings cannot be modified
+ * and are used as-is, which allows the same string to be shared by concurrent
+ * callers.
+ *
+ * \param in_buffer String or IO::Buffer to lock
+ * \param in_body function called with the buffer locked
+ * \param in_args argument passed through to in_body
+ * \return value returned by in_body
+ */
+static VALUE
+WithLockedBuffer(VALUE in_buffer, VALUE (*in_body)(VALUE), VALUE in_args)
+{
+  if (RB_TYPE_P(in_buffer, T_STRING) && OBJ_FROZEN(in_buffer))
+  {
+    return in_body(in_args);
+  }
+
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+  if (RB_TYPE_P(in_buffer, T_STRING))
+  {
+    rb_str_locktmp(in_buffer);
+  }
+  else
+  {
+    rb_io_buffer_lock(in_buffer);
+  }
+#else
+  rb_str_locktmp(in_buffer);
+#endif // HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+
+  return rb_ensure(in_body, in_args, UnlockBuffer, in_buffer);
+}
+
+/**
+ * Runs a batch operation that reads directly from a String or IO::Buffer.
+ *
+ * The buffer is locked with WithLockedBuffer so that other threads cannot
+ * resize or free it while the GVL is released.
+ *
+ * \param in_context context owning the worker pool
+ * \param in_buffer String or IO::Buffer read by in_func
+ * \param in_func function applied to ranges of entries
+ * \param in_data data passed through to in_func
+ * \param in_count number of entries in the batch
+ */
+static void
+RunBatchOverBuffer(Context *in_context,
+                   VALUE in_buffer,
+                   BatchFunc in_func,
+                   void *in_data,
+                   long in_count)
+{
+  LockedBatchArgs args;
+
+  args.context = in_context;
+  args.func = in_func;
+  args.data = in_data;
+  args.count = in_count;
+
+  WithLockedBuffer(in_buffer, RunLockedBatch_body, (VALUE)&args);
+}
+
+// Arguments for deriving a public key without the GVL
+typedef struct PublicKeyCreateArgs_dummy {
+  const secp256k1_context *ctx; // Context used for key derivation
+  unsigned char private_key[32]; // Copy of the private key data
+  secp256k1_pubkey pubkey; // Public key derived from private key
+  int result; // Return value of secp256k1_ec_pubkey_create
+} PublicKeyCreateArgs;
+
+static void*
+PublicKeyCreate_without_gvl(void *in_args)
+{
+  PublicKeyCreateArgs *args = (PublicKeyCreateArgs*)in_args;
+
+  args->result = secp256k1_ec_pubkey_create(
+    args->ctx, &(args->pubkey), args->private_key
+  );
+
+  return NULL;
+}
+
+// Arguments for computing a signature without the GVL
+typedef struct SignDataArgs_dummy {
+  const secp256k1_context *ctx; // Context used for signing
+  unsigned char hash32[32]; // Copy of the 32-byte hash being signed
+  unsigned char private_key[32]; // Copy of the private key data
+  NonceOptions nonce; // Nonce generation options
+  secp256k1_ecdsa_signature signature; // Signature produced
+  ResultT result; // Result of signing
+} SignDataArgs;
+
+static void*
+SignData_without_gvl(void *in_args)
+{
+  SignDataArgs *args = (SignDataArgs*)in_args;
+
+  args->result = SignData(
+    args->ctx,
+    args->hash32,
+    args->private_key,
+    &(args->nonce),
+    &(args->signature)
+  );
+
+  return NULL;
+}
+
+// Arguments for verifying a signature without the GVL
+typedef struct VerifyArgs_dummy {
+  const secp256k1_context *ctx; // Context used for verification
+  secp256k1_ecdsa_signature signature; // Copy of signature being verified
+  secp256k1_pubkey pubkey; // Copy of public key to verify against
+  unsigned char hash32[32]; // Copy of the 32-byte hash that was signed
+  int result; // Return value of secp256k1_ecdsa_verify
+} VerifyArgs;
+
+static void*
+Verify_without_gvl(void *in_args)
+{
+  VerifyArgs *args = (VerifyArgs*)in_args;
+
+  args->result = secp256k1_ecdsa_verify(
+    args->ctx, &(args->signature), args->hash32, &(args->pubkey)
+  );
+
+  return NULL;
+}
+
+// Single entry of a batch verification
+typedef struct VerifyBatchItem_dummy {
+  secp256k1_ecdsa_signature signature; // Copy of signature being verified
+  secp256k1_pubkey pubkey; // Copy of public key to verify against
+  unsigned char hash32[32]; // Copy of the 32-byte hash that was signed
+  int result; // Return value of secp256k1_ecdsa_verify
+} VerifyBatchItem;
+
+// Arguments for verifying a batch of signatures
+typedef struct VerifyBatchArgs_dummy {
+  const secp256k1_context *ctx; // Context used for verification
+  VerifyBatchItem *items; // Entries to be verified
+  int fail_fast; // Stop at the first invalid signature if non-zero
+  volatile int failed; // Set once any signature is found to be invalid
+} VerifyBatchArgs;
+
+static void
+VerifyBatch_range(void *in_args, long begin, long end)
+{
+  VerifyBatchArgs *args = (VerifyBatchArgs*)in_args;
+  VerifyBatchItem *item;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    if (args->fail_fast && args->failed)
+    {
+      return;
+    }
+
+    item = &(args->items[i]);
+    item->result = secp256k1_ecdsa_verify(
+      args->ctx, &(item->signature), item->hash32, &(item->pubkey)
+    );
+
+    if (item->result != 1)
+    {
+      args->failed = 1;
+    }
+  }
+}
+
+// Arguments for verifying packed records
+typedef struct VerifyPackedArgs_dummy {
+  const secp256k1_context *ctx; // Context used for verification
+  const unsigned char *records; // Packed verification records
+  int normalize; // Normalize signatures to lower-S form before verifying
+  unsigned char *results; // One result byte per record
+} VerifyPackedArgs;
+
+static void
+VerifyPacked_range(void *in_args, long begin, long end)
+{
+  VerifyPackedArgs *args = (VerifyPackedArgs*)in_args;
+  const unsigned char *record;
+  secp256k1_ecdsa_signature signature;
+  secp256k1_pubkey pubkey;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    record = args->records + i * VERIFY_PACKED_RECORD_SIZE;
+    if (secp256k1_ecdsa_signature_parse_compact(secp256k1_context_static,
+                                                &signature,
+                                                record) != 1)
+    {
+      args->results[i] = 0;
+      continue;
+    }
+
+    if (args->normalize)
+    {
+      secp256k1_ecdsa_signature_normalize(
+        secp256k1_context_static, &signature, &signature
+      );
+    }
+
+    args->results[i] = (
+      secp256k1_ec_pubkey_parse(secp256k1_context_static,
+                                &pubkey,
+                                record + 64,
+                                33) == 1 &&
+      secp256k1_ecdsa_verify(args->ctx,
+                             &signature,
+                             record + 64 + 33,
+                             &pubkey) == 1
+    );
+  }
+}
+
+// Single entry of a batch signing
+typedef struct SignBatchItem_dummy {
+  unsigned char private_key[32]; // Copy of the private key data
+  unsigned char hash32[32]; // Copy of the 32-byte hash being signed
+  secp256k1_ecdsa_signature signature; // Signature produced
+  ResultT result; // Result of signing
+} SignBatchItem;
+
+// Arguments for signing a batch of hashes
+typedef struct SignBatchArgs_dummy {
+  const secp256k1_context *ctx; // Context used for signing
+  SignBatchItem *items; // Entries to be signed
+} SignBatchArgs;
+
+static void
+SignBatch_range(void *in_args, long begin, long end)
+{
+  SignBatchArgs *args = (SignBatchArgs*)in_args;
+  SignBatchItem *item;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    item = &(args->items[i]);
+    item->result = SignData(
+      args->ctx, item->hash32, item->private_key, NULL, &(item->signature)
+    );
+  }
+}
+
+// Single entry of a batch public key derivation
+typedef struct PublicKeyBatchItem_dummy {
+  unsigned char private_key[32]; // Copy of the private key data
+  secp256k1_pubkey pubkey; // Public key derived from private key
+  int result; // Return value of secp256k1_ec_pubkey_create
+} PublicKeyBatchItem;
+
+// Arguments for deriving a batch of public keys
+typedef struct PublicKeyBatchArgs_dummy {
+  const secp256k1_context *ctx; // Context used for key derivation
+  PublicKeyBatchItem *items; // Entries to be derived
+} PublicKeyBatchArgs;
+
+static void
+PublicKeyBatch_range(void *in_args, long begin, long end)
+{
+  PublicKeyBatchArgs *args = (PublicKeyBatchArgs*)in_args;
+  PublicKeyBatchItem *item;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    item = &(args->items[i]);
+    item->result = secp256k1_ec_pubkey_create(
+      args->ctx, &(item->pubkey), item->private_key
+    );
+  }
+}
+
+// Operations that tweak a key by a 32-byte scalar
+typedef enum TweakT_dummy {
+  TWEAK_ADD, // Add the tweak (times the generator for public keys)
+  TWEAK_MUL // Multiply by the tweak
+} TweakT;
+
+// Arguments for tweaking a public key without the GVL
+typedef struct PublicKeyTweakArgs_dummy {
+  const secp256k1_context *ctx; // Context used for the tweak
+  TweakT tweak_op; // Operation to apply
+  secp256k1_pubkey pubkey; // Copy of the public key, tweaked in place
+  unsigned char tweak[32]; // Copy of the tweak
+  int result; // Return value of the libsecp256k1 tweak function
+} PublicKeyTweakArgs;
+
+static void*
+PublicKeyTweak_without_gvl(void *in_args)
+{
+  PublicKeyTweakArgs *args = (PublicKeyTweakArgs*)in_args;
+
+  if (args->tweak_op == TWEAK_MUL)
+  {
+    args->result = secp256k1_ec_pubkey_tweak_mul(
+      args->ctx, &(args->pubkey), args->tweak
+    );
+  }
+  else
+  {
+    args->result = secp256k1_ec_pubkey_tweak_add(
+      args->ctx, &(args->pubkey), args->tweak
+    );
+  }
+
+  return NULL;
+}
+
+// Arguments for deriving BIP-32 child public keys of one extended public key
+typedef struct DeriveChildrenArgs_dummy {
+  const secp256k1_context *ctx; // Context used for the tweaks
+  HmacSha512 hmac; // HMAC-SHA512 keyed with the parent chain code
+  unsigned char parent[33]; // Compressed parent public key
+  secp256k1_pubkey parent_pubkey; // Parsed parent public key
+  unsigned long first_index; // Child index of the first entry
+  secp256k1_pubkey *pubkeys; // Child public keys derived
+  int *results; // Return value of secp256k1_ec_pubkey_tweak_add per child
+} DeriveChildrenArgs;
+
+static void
+DeriveChildren_range(void *in_args, long begin, long end)
+{
+  DeriveChildrenArgs *args = (DeriveChildrenArgs*)in_args;
+  unsigned char data[33 + 4];
+  unsigned char mac[64];
+  unsigned long index;
+  long i;
+
+  MEMCPY(data, args->parent, unsigned char, 33);
+  for (i = begin; i < end; i++)
+  {
+    // I = HMAC-SHA512(chain code, serP(K) || ser32(index)), child = K + I_L*G
+    index = args->first_index + (unsigned long)i;
+    data[33] = (unsigned char)(index >> 24);
+    data[34] = (unsigned char)(index >> 16);
+    data[35] = (unsigned char)(index >> 8);
+    data[36] = (unsigned char)index;
+    HmacSha512_mac(&(args->hmac), data, sizeof(data), mac);
+
+    args->pubkeys[i] = args->parent_pubkey;
+    args->results[i] = secp256k1_ec_pubkey_tweak_add(
+      args->ctx, &(args->pubkeys[i]), mac
+    );
+  }
+}
+
+#ifdef HAVE_SECP256K1_RECOVERY_H
+
+// Arguments for computing a recoverable signature without the GVL
+typedef struct RecoverableSignDataArgs_dummy {
+  const secp256k1_context *ctx; // Context used for signing
+  unsigned char hash32[32]; // Copy of the 32-byte hash being signed
+  unsigned char private_key[32]; // Copy of the private key data
+  NonceOptions nonce; // Nonce generation options
+  secp256k1_ecdsa_recoverable_signature signature; // Signature produced
+  ResultT result; // Result of signing
+} RecoverableSignDataArgs;
+
+static void*
+RecoverableSignData_without_gvl(void *in_args)
+{
+  RecoverableSignDataArgs *args = (RecoverableSignDataArgs*)in_args;
+
+  args->result = RecoverableSignData(
+    args->ctx,
+    args->hash32,
+    args->private_key,
+    &(args->nonce),
+    &(args->signature)
+  );
+
+  return NULL;
+}
+
+// Arguments for recovering a public key without the GVL
+typedef struct RecoverArgs_dummy {
+  const secp256k1_context *ctx; // Context used for recovery
+  secp256k1_ecdsa_recoverable_signature signature; // Copy of signature
+  unsigned char hash32[32]; // Copy of the 32-byte hash that was signed
+  secp256k1_pubkey pubkey; // Recovered public key
+  int result; // Return value of secp256k1_ecdsa_recover
+} RecoverArgs;
+
+static void*
+Recover_without_gvl(void *in_args)
+{
+  RecoverArgs *args = (RecoverArgs*)in_args;
+
+  args->result = secp256k1_ecdsa_recover(
+    args->ctx, &(args->pubkey), &(args->signature), args->hash32
+  );
+
+  return NULL;
+}
+
+// Single entry of a batch public key recovery
+typedef struct RecoverBatchItem_dummy {
+  secp256k1_ecdsa_recoverable_signature signature; // Copy of signature
+  unsigned char hash32[32]; // Copy of the 32-byte hash that was signed
+  secp256k1_pubkey pubkey; // Recovered public key
+  int result; // Return value of secp256k1_ecdsa_recover
+} RecoverBatchItem;
+
+// Arguments for recovering a batch of public keys
+typedef struct RecoverBatchArgs_dummy {
+  const secp256k1_context *ctx; // Context used for recovery
+  RecoverBatchItem *items; // Entries to be recovered
+} RecoverBatchArgs;
+
+// Arguments for recovering public keys from packed records
+typedef struct RecoverPackedArgs_dummy {
+  const secp256k1_context *ctx; // Context used for recovery
+  const unsigned char *records; // Packed recovery records
+  unsigned char *public_keys; // Uncompressed public key output per record
+} RecoverPackedArgs;
+
+static void
+RecoverPacked_range(void *in_args, long begin, long end)
+{
+  RecoverPackedArgs *args = (RecoverPackedArgs*)in_args;
+  const unsigned char *record;
+  unsigned char *output;
+  secp256k1_ecdsa_recoverable_signature signature;
+  secp256k1_pubkey pubkey;
+  size_t output_len;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    record = args->records + i * RECOVER_PACKED_RECORD_SIZE;
+    output = args->public_keys + i * UNCOMPRESSED_PUBKEY_SIZE_BYTES;
+    output_len = UNCOMPRESSED_PUBKEY_SIZE_BYTES;
+
+    // Recovery IDs must be checked first, libsecp256k1 treats them as an
+    // illegal argument rather than a parse failure.
+    if (record[64] > 3 ||
+        secp256k1_ecdsa_recoverable_signature_parse_compact(
+          secp256k1_context_static, &signature, record, record[64]) != 1 ||
+        secp256k1_ecdsa_recover(
+          args->ctx, &pubkey, &signature, record + 65) != 1)
+    {
+      memset(output, 0, UNCOMPRESSED_PUBKEY_SIZE_BYTES);
+      continue;
+    }
+
+    secp256k1_ec_pubkey_serialize(secp256k1_context_static,
+                                  output,
+                                  &output_len,
+                                  &pubkey,
+                                  SECP256K1_EC_UNCOMPRESSED);
+  }
+}
+
+static void
+RecoverBatch_range(void *in_args, long begin, long end)
+{
+  RecoverBatchArgs *args = (RecoverBatchArgs*)in_args;
+  RecoverBatchItem *item;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    item = &(args->items[i]);
+    item->result = secp256k1_ecdsa_recover(
+      args->ctx, &(item->pubkey), &(item->signature), item->hash32
+    );
+  }
+}
+
+#endif // HAVE_SECP256K1_RECOVERY_H
+
+#ifdef HAVE_SECP256K1_ECDH_H
+
+/**
+ * ECDH hash function that outputs the x-coordinate of the shared point.
+ *
+ * Lets callers feed the raw coordinate into their own key derivation function
+ * instead of the SHA-256 of the compressed point libsecp256k1 uses by default.
+ *
+ * \param out_output 32-byte x-coordinate of the shared point
+ * \param in_x32 x-coordinate of the shared point
+ * \param in_y32 y-coordinate of the shared point, unused
+ * \param in_data unused
+ * \return 1 always
+ */
+static int
+EcdhHashXCoordinate(unsigned char *out_output,
+                    const unsigned char *in_x32,
+                    const unsigned char *in_y32,
+                    void *in_data)
+{
+  MEMCPY(out_output, in_x32, unsigned char, 32);
+
+  return 1;
+}
+
+// Arguments for computing an EC Diffie-Hellman secret without the GVL
+typedef struct EcdhArgs_dummy {
+  const secp256k1_context *ctx; // Context used for ECDH
+  secp256k1_pubkey pubkey; // Copy of public key (point)
+  unsigned char private_key[32]; // Copy of private key (scalar)
+  secp256k1_ecdh_hash_function hashfp; // NULL for the libsecp256k1 default
+  unsigned char output[32]; // Shared secret produced
+  int result; // Return value of secp256k1_ecdh
+} EcdhArgs;
+
+static void*
+Ecdh_without_gvl(void *in_args)
+{
+  EcdhArgs *args = (EcdhArgs*)in_args;
+
+  args->result = secp256k1_ecdh(
+    args->ctx,
+    args->output,
+    &(args->pubkey),
+    args->private_key,
+    args->hashfp,
+    NULL
+  );
+
+  return NULL;
+}
+
+// Arguments for computing shared secrets of one private key against many
+// public keys
+typedef struct EcdhBatchArgs_dummy {
+  const secp256k1_context *ctx; // Context used for ECDH
+  unsigned char private_key[32]; // Copy of private key (scalar)
+  secp256k1_ecdh_hash_function hashfp; // NULL for the libsecp256k1 default
+  const secp256k1_pubkey *pubkeys; // Copies of the public keys (points)
+  unsigned char *output; // 32 bytes of output per public key
+  int *results; // Return value of secp256k1_ecdh per public key
+} EcdhBatchArgs;
+
+static void
+EcdhBatch_range(void *in_args, long begin, long end)
+{
+  EcdhBatchArgs *args = (EcdhBatchArgs*)in_args;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    args->results[i] = secp256k1_ecdh(
+      args->ctx,
+      args->output + i * 32,
+      &(args->pubkeys[i]),
+      args->private_key,
+      args->hashfp,
+      NULL
+    );
+  }
+}
+
+#endif // HAVE_SECP256K1_ECDH_H
+
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+
+// Arguments for computing a Schnorr signature without the GVL
+typedef struct SchnorrSignArgs_dummy {
+  const secp256k1_context *ctx; // Context used for signing
+  unsigned char private_key[32]; // Copy of the private key data
+  unsigned char message32[32]; // Copy of the 32-byte message to sign
+  unsigned char aux_rand32[32]; // Copy of the auxiliary randomness
+  int has_aux_rand; // Non-zero if aux_rand32 should be used
+  unsigned char signature[64]; // BIP-340 signature produced
+  int result; // Zero if key pair creation or signing failed
+} SchnorrSignArgs;
+
+static void*
+SchnorrSign_without_gvl(void *in_args)
+{
+  SchnorrSignArgs *args = (SchnorrSignArgs*)in_args;
+  secp256k1_keypair keypair;
+
+  args->result = secp256k1_keypair_create(
+    args->ctx, &keypair, args->private_key
+  );
+  if (args->result == 1)
+  {
+    args->result = secp256k1_schnorrsig_sign32(
+      args->ctx,
+      args->signature,
+      args->message32,
+      &keypair,
+      args->has_aux_rand ? args->aux_rand32 : NULL
+    );
+  }
+
+  // The key pair holds a copy of the private key
+  memset(&keypair, 0, sizeof(keypair));
+
+  return NULL;
+}
+
+// Arguments for verifying a Schnorr signature without the GVL
+typedef struct SchnorrVerifyArgs_dummy {
+  const secp256k1_context *ctx; // Context used for verification
+  unsigned char signature[64]; // Copy of the signature being verified
+  unsigned char message32[32]; // Copy of the 32-byte message that was signed
+  secp256k1_xonly_pubkey pubkey; // Copy of the x-only public key
+  int result; // Return value of secp256k1_schnorrsig_verify
+} SchnorrVerifyArgs;
+
+static void*
+SchnorrVerify_without_gvl(void *in_args)
+{
+  SchnorrVerifyArgs *args = (SchnorrVerifyArgs*)in_args;
+
+  args->result = secp256k1_schnorrsig_verify(
+    args->ctx, args->signature, args->message32, 32, &(args->pubkey)
+  );
+
+  return NULL;
+}
+
+// Arguments for verifying a batch of Schnorr signatures
+typedef struct SchnorrVerifyBatchArgs_dummy {
+  const secp256k1_context *ctx; // Context used for verification
+  SchnorrVerifyArgs *items; // Entries to be verified
+} SchnorrVerifyBatchArgs;
+
+static void
+SchnorrVerifyBatch_range(void *in_args, long begin, long end)
+{
+  SchnorrVerifyBatchArgs *args = (SchnorrVerifyBatchArgs*)in_args;
+  long i;
+
+  for (i = begin; i < end; i++)
+  {
+    SchnorrVerify_without_gvl(&(args->items[i]));
+  }
+}
+
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
+//
+// Secp256k1::PublicKey class interface
+//
+
+static VALUE
+PublicKey_alloc(VALUE klass)
+{
+  PublicKey *public_key;
+
+  return TypedData_Make_Struct(
+    klass, PublicKey, &PublicKey_DataType, public_key
+  );
+}
+
+/**
+ * Derives the public key of a private key.
+ *
+ * \param in_context context to derive the public key with
+ * \param private_key_data 32-byte private key
+ * \param out_pubkey derived public key
+ * \raise Secp256k1::DeserializationError if the private key is invalid
+ */
+static void
+DerivePublicKey(Context *in_context,
+                const unsigned char *private_key_data,
+                secp256k1_pubkey *out_pubkey)
+{
+  PublicKeyCreateArgs args;
+  unsigned long long start;
+
+  RequireCapability(in_context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
+
+  args.ctx = in_context->ctx;
+  MEMCPY(args.private_key, private_key_data, unsigned char, 32);
+  start = StatsStart(in_context);
+  WithoutGVL(PublicKeyCreate_without_gvl, &args);
+  StatsRecord(
+    in_context, STATS_PUBLIC_KEY_CREATE, 1, args.result != 1, start
+  );
+
+  if (args.result != 1)
+  {
+    rb_raise(Secp256k1_DeserializationError_class, "invalid private key data");
+  }
+
+  *out_pubkey = args.pubkey;
+}
+
+static VALUE
+PublicKey_create_from_data(unsigned char *in_public_key_data,
+                           unsigned int in_public_key_data_len)
+{
+  PublicKey *public_key;
+  VALUE result;
+
+  result = PublicKey_alloc(Secp256k1_PublicKey_class);
+  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+
+  if (secp256k1_ec_pubkey_parse(secp256k1_context_static,
+                                &(public_key->pubkey),
+                                in_public_key_data,
+                                in_public_key_data_len) != 1)
+  {
+    rb_raise(Secp256k1_DeserializationError_class, "invalid public key data");
+  }
+
+  // Successfully parsed compressed and plain uncompressed data is already in
+  // canonical form, so it can seed the cache. Hybrid encodings are not.
+  if (in_public_key_data_len == COMPRESSED_PUBKEY_SIZE_BYTES)
+  {
+    MEMCPY(public_key->compressed,
+           in_public_key_data,
+           unsigned char,
+           COMPRESSED_PUBKEY_SIZE_BYTES);
+    public_key->cached |= PUBLIC_KEY_COMPRESSED_CACHED;
+  }
+  else if (in_public_key_data[0] == 0x04)
+  {
+    MEMCPY(public_key->uncompressed,
+           in_public_key_data,
+           unsigned char,
+           UNCOMPRESSED_PUBKEY_SIZE_BYTES);
+    public_key->cached |= PUBLIC_KEY_UNCOMPRESSED_CACHED;
+  }
+
+  return result;
+}
+
+/**
+ * Loads a public key from compressed or uncompressed binary data.
+ *
+ * @param in_public_key_data [String, IO::Buffer] compressed or uncompressed
+ *   public key data.
+ * @return [Secp256k1::PublicKey] public key derived from data.
+ * @raise [Secp256k1::DeserializationError] if public key data is invalid.
+ */
+static VALUE
+PublicKey_from_data(VALUE klass, VALUE in_public_key_data)
+{
+  unsigned char scratch[65];
+  const unsigned char *public_key_data;
+  long public_key_data_len;
+
+  public_key_data = InputBytes(
+    in_public_key_data, scratch, sizeof(scratch), &public_key_data_len
+  );
+  if (public_key_data_len > (long)sizeof(scratch))
+  {
+    rb_raise(Secp256k1_DeserializationError_class, "invalid public key data");
+  }
+
+  return PublicKey_create_from_data(
+    (unsigned char*)public_key_data,
+    (int)public_key_data_len
+  );
+}
+
+/**
+ * @return [String] binary string containing the uncompressed representation
+ *   of this public key.
+ */
+static VALUE
+PublicKey_uncompressed(VALUE self)
+{
+  PublicKey *public_key;
+
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+
+  return rb_str_new(
+    (const char*)PublicKey_uncompressed_data(public_key),
+    UNCOMPRESSED_PUBKEY_SIZE_BYTES
+  );
+}
+
+/**
+ * @return [String] binary string containing the compressed representation of
+ *   this public key.
+ */
+static VALUE
+PublicKey_compressed(VALUE self)
+{
+  PublicKey *public_key;
+
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+
+  return rb_str_new(
+    (const char*)PublicKey_compressed_data(public_key),
+    COMPRESSED_PUBKEY_SIZE_BYTES
+  );
+}
+
+/**
+ * Writes the uncompressed representation of this public key into a buffer.
+ *
+ * @param buffer [String,IO::Buffer] buffer to write into.
+ * @param offset [Integer,nil] (Optional) byte offset to write at. Omit to
+ *   append to a String buffer.
+ * @return [Integer] offset just past the 65 bytes written.
+ * @raise [Secp256k1::Error] if the offset is invalid or the data does not fit
+ *   in an IO::Buffer.
+ */
+static VALUE
+PublicKey_write_uncompressed(int argc, const VALUE *argv, VALUE self)
+{
+  PublicKey *public_key;
+  VALUE buffer;
+  VALUE offset;
+
+  rb_scan_args(argc, argv, "11", &buffer, &offset);
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+
+  return WriteToBuffer(buffer,
+                       offset,
+                       PublicKey_uncompressed_data(public_key),
+                       UNCOMPRESSED_PUBKEY_SIZE_BYTES);
+}
+
+/**
+ * Writes the compressed representation of this public key into a buffer.
+ *
+ * @param buffer [String,IO::Buffer] buffer to write into.
+ * @param offset [Integer,nil] (Optional) byte offset to write at. Omit to
+ *   append to a String buffer.
+ * @return [Integer] offset just past the 33 bytes written.
+ * @raise [Secp256k1::Error] if the offset is invalid or the data does not fit
+ *   in an IO::Buffer.
+ */
+static VALUE
+PublicKey_write_compressed(int argc, const VALUE *argv, VALUE self)
+{
+  PublicKey *public_key;
+  VALUE buffer;
+  VALUE offset;
+
+  rb_scan_args(argc, argv, "11", &buffer, &offset);
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+
+  return WriteToBuffer(buffer,
+                       offset,
+                       PublicKey_compressed_data(public_key),
+                       COMPRESSED_PUBKEY_SIZE_BYTES);
+}
+
+/**
+ * Compares two public keys.
+ *
+ * Public keys are considered equal if their compressed representations match.
+ *
+ * @param other [Secp256k1::PublicKey] public key to compare.
+ * @return [Boolean] true if the public keys are identical, false otherwise.
+ */
+static VALUE
+PublicKey_equals(VALUE self, VALUE other)
+{
+  PublicKey *lhs;
+  PublicKey *rhs;
+
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, lhs);
+  TypedData_Get_Struct(other, PublicKey, &PublicKey_DataType, rhs);
+
+  if (memcmp(PublicKey_compressed_data(lhs),
+             PublicKey_compressed_data(rhs),
+             COMPRESSED_PUBKEY_SIZE_BYTES) == 0)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
+}
+
+/**
+ * Compares two public keys for use as hash keys.
+ *
+ * @param other [Object] object to compare.
+ * @return [Boolean] true if other is a public key equal to this one, false
+ *   otherwise.
+ */
+static VALUE
+PublicKey_eql(VALUE self, VALUE other)
+{
+  if (!rb_typeddata_is_kind_of(other, &PublicKey_DataType))
+  {
+    return Qfalse;
+  }
+
+  return PublicKey_equals(self, other);
+}
+
+/**
+ * Computes a hash value for this public key.
+ *
+ * Public keys that are equal have the same hash value.
+ *
+ * @return [Integer] hash of the compressed representation of this key.
+ */
+static VALUE
+PublicKey_hash(VALUE self)
+{
+  PublicKey *public_key;
+
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+
+  return ST2FIX(
+    rb_memhash(PublicKey_compressed_data(public_key),
+               COMPRESSED_PUBKEY_SIZE_BYTES)
+  );
+}
+
+/**
+ * Freezes this public key so it can be shared between Ractors.
+ *
+ * Both serializations are cached first, so reading a frozen public key never
+ * writes to it.
+ *
+ * @return [Secp256k1::PublicKey] this public key.
+ */
+static VALUE
+PublicKey_freeze(VALUE self)
+{
+  PublicKey *public_key;
+
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+  PublicKey_compressed_data(public_key);
+  PublicKey_uncompressed_data(public_key);
+
+  return rb_call_super(0, NULL);
+}
+
+//
+// Secp256k1::PrivateKey class interface
+//
+
+static VALUE
+PrivateKey_alloc(VALUE klass)
+{
+  PrivateKey *private_key;
+
+  return TypedData_Make_Struct(
+    klass, PrivateKey, &PrivateKey_DataType, private_key
+  );
+}
+
+static VALUE
+PrivateKey_create(unsigned char *in_private_key_data)
+{
+  PrivateKey *private_key;
+  VALUE result;
+
+  if (secp256k1_ec_seckey_verify(secp256k1_context_static,
+                                 in_private_key_data) != 1)
+  {
+    rb_raise(Secp256k1_Error_class, "invalid private key data");
+  }
+
+  result = PrivateKey_alloc(Secp256k1_PrivateKey_class);
+  TypedData_Get_Struct(result, PrivateKey, &PrivateKey_DataType, private_key);
+  MEMCPY(private_key->data, in_private_key_data, char, 32);
+
+  return result;
+}
+
+/**
+ * Returns the binary private key data.
+ *
+ * A new string is created on each call, so private keys that are only used
+ * for signing never copy their secret into a Ruby string.
+ *
+ * @return [String] 32-byte binary string containing the private key.
+ */
+static VALUE
+PrivateKey_data(VALUE self)
+{
+  PrivateKey *private_key;
+
+  TypedData_Get_Struct(self, PrivateKey, &PrivateKey_DataType, private_key);
+
+  return rb_str_new((char*)private_key->data, 32);
+}
+
+/**
+ * Load a private key from binary data.
+ *
+ * @param in_private_key_data [String] 32 byte binary string of private key
+ *   data.
+ * @return [Secp256k1::PrivateKey] private key loaded from the given data.
+ * @raise [Secp256k1::Error] if private key data is not 32 bytes or is invalid.
+ */
+static VALUE
+PrivateKey_from_data(VALUE klass, VALUE in_private_key_data)
+{
+  unsigned char *private_key_data;
+
+  Check_Type(in_private_key_data, T_STRING);
+  if (RSTRING_LEN(in_private_key_data) != 32)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "private key data must be 32 bytes in length"
+    );
+  }
+
+  private_key_data = (unsigned char*)StringValuePtr(in_private_key_data);
+  return PrivateKey_create(private_key_data);
+}
+
+/**
+ * Compare two private keys.
+ *
+ * Private keys are considered equal if their data fields are identical.
+ *
+ * @param other [Secp256k1::PrivateKey] private key to compare. 
+ * @return [Boolean] true if they are equal, false otherwise.
+ */
+static VALUE
+PrivateKey_equals(VALUE self, VALUE other)
+{
+  PrivateKey *lhs;
+  PrivateKey *rhs;
+
+  TypedData_Get_Struct(self, PrivateKey, &PrivateKey_DataType, lhs);
+  TypedData_Get_Struct(other, PrivateKey, &PrivateKey_DataType, rhs);
+
+  if (memcmp(lhs->data, rhs->data, 32) == 0)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
+}
+
+/**
+ * Compare two private keys for use as hash keys.
+ *
+ * @param other [Object] object to compare.
+ * @return [Boolean] true if other is a private key equal to this one, false
+ *   otherwise.
+ */
+static VALUE
+PrivateKey_eql(VALUE self, VALUE other)
+{
+  if (!rb_typeddata_is_kind_of(other, &PrivateKey_DataType))
+  {
+    return Qfalse;
+  }
+
+  return PrivateKey_equals(self, other);
+}
+
+/**
+ * Computes a hash value for this private key.
+ *
+ * Private keys that are equal have the same hash value.
+ *
+ * @return [Integer] hash of the private key data.
+ */
+static VALUE
+PrivateKey_hash(VALUE self)
+{
+  PrivateKey *private_key;
+
+  TypedData_Get_Struct(self, PrivateKey, &PrivateKey_DataType, private_key);
+
+  return ST2FIX(rb_memhash(private_key->data, 32));
+}
+
+//
+// Secp256k1::KeyPair class interface
+//
+
+static VALUE
+KeyPair_alloc(VALUE klass)
+{
+  KeyPair *key_pair;
+  VALUE result;
+
+  result = TypedData_Make_Struct(klass, KeyPair, &KeyPair_DataType, key_pair);
+  key_pair->public_key = Qnil;
+  key_pair->private_key = Qnil;
+
+  return result;
+}
+
+/**
+ * Default constructor.
+ *
+ * @param in_public_key [Secp256k1::PublicKey] public key
+ * @param in_private_key [Secp256k1::PrivateKey] private key
+ * @return [Secp256k1::KeyPair] newly initialized key pair.
+ */
+static VALUE
+KeyPair_initialize(VALUE self, VALUE in_public_key, VALUE in_private_key)
+{
+  KeyPair *key_pair;
+  PublicKey *public_key;
+  PrivateKey *private_key;
+
+  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, key_pair);
+  TypedData_Get_Struct(in_public_key, PublicKey, &PublicKey_DataType, public_key);
+  TypedData_Get_Struct(
+    in_private_key, PrivateKey, &PrivateKey_DataType, private_key
+  );
+
+  key_pair->public_key_data = *public_key;
+  key_pair->private_key_data = *private_key;
+  key_pair->public_key = in_public_key;
+  key_pair->private_key = in_private_key;
+
+  return self;
+}
+
+/**
+ * Creates a new key pair from raw key data.
+ *
+ * Only the key pair object itself is allocated. The PublicKey and PrivateKey
+ * objects are created the first time they are read.
+ *
+ * \param in_pubkey public key of the key pair
+ * \param in_private_key_data 32-byte private key matching in_pubkey
+ * \return newly created Secp256k1::KeyPair
+ */
+static VALUE
+KeyPair_create(const secp256k1_pubkey *in_pubkey,
+               const unsigned char *in_private_key_data)
+{
+  KeyPair *key_pair;
+  VALUE result;
+
+  result = KeyPair_alloc(Secp256k1_KeyPair_class);
+  TypedData_Get_Struct(result, KeyPair, &KeyPair_DataType, key_pair);
+
+  key_pair->public_key_data.pubkey = *in_pubkey;
+  MEMCPY(
+    key_pair->private_key_data.data, in_private_key_data, unsigned char, 32
+  );
+
+  return result;
+}
+
+/**
+ * @return [Secp256k1::PublicKey] public key of this key pair.
+ */
+static VALUE
+KeyPair_public_key(VALUE self)
+{
+  KeyPair *key_pair;
+  PublicKey *public_key;
+  VALUE result;
+
+  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, key_pair);
+  if (NIL_P(key_pair->public_key))
+  {
+    result = PublicKey_alloc(Secp256k1_PublicKey_class);
+    TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+    *public_key = key_pair->public_key_data;
+    key_pair->public_key = result;
+  }
+
+  return key_pair->public_key;
+}
+
+/**
+ * @return [Secp256k1::PrivateKey] private key of this key pair.
+ */
+static VALUE
+KeyPair_private_key(VALUE self)
+{
+  KeyPair *key_pair;
+  PrivateKey *private_key;
+  VALUE result;
+
+  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, key_pair);
+  if (NIL_P(key_pair->private_key))
+  {
+    result = PrivateKey_alloc(Secp256k1_PrivateKey_class);
+    TypedData_Get_Struct(result, PrivateKey, &PrivateKey_DataType, private_key);
+    *private_key = key_pair->private_key_data;
+    key_pair->private_key = result;
+  }
+
+  return key_pair->private_key;
+}
+
+/**
+ * Compare two key pairs.
+ *
+ * Two key pairs are equal if they have the same public and private key.
+ *
+ * @param other [Secp256k1::KeyPair] key pair to compare to.
+ * @return [Boolean] true if the keys match, false otherwise.
+ */
+static VALUE
+KeyPair_equals(VALUE self, VALUE other)
+{
+  KeyPair *lhs;
+  KeyPair *rhs;
+
+  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, lhs);
+  TypedData_Get_Struct(other, KeyPair, &KeyPair_DataType, rhs);
+
+  if (memcmp(lhs->private_key_data.data, rhs->private_key_data.data, 32) == 0 &&
+      memcmp(PublicKey_compressed_data(&(lhs->public_key_data)),
+             PublicKey_compressed_data(&(rhs->public_key_data)),
+             COMPRESSED_PUBKEY_SIZE_BYTES) == 0)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
+}
+
+/**
+ * Compare two key pairs for use as hash keys.
+ *
+ * @param other [Object] object to compare to.
+ * @return [Boolean] true if other is a key pair equal to this one, false
+ *   otherwise.
+ */
+static VALUE
+KeyPair_eql(VALUE self, VALUE other)
+{
+  if (!rb_typeddata_is_kind_of(other, &KeyPair_DataType))
+  {
+    return Qfalse;
+  }
+
+  return KeyPair_equals(self, other);
+}
+
+/**
+ * Computes a hash value for this key pair.
+ *
+ * Key pairs that are equal have the same hash value.
+ *
+ * @return [Integer] hash of the public and private key data.
+ */
+static VALUE
+KeyPair_hash(VALUE self)
+{
+  KeyPair *key_pair;
+  st_index_t hash;
+
+  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, key_pair);
+
+  hash = rb_hash_start(rb_memhash(key_pair->private_key_data.data, 32));
+  hash = rb_hash_uint(
+    hash,
+    rb_memhash(PublicKey_compressed_data(&(key_pair->public_key_data)),
+               COMPRESSED_PUBKEY_SIZE_BYTES)
+  );
+
+  return ST2FIX(rb_hash_end(hash));
+}
+
+/**
+ * Freezes this key pair along with its public and private keys so it can be
+ * shared between Ractors.
+ *
+ * @return [Secp256k1::KeyPair] this key pair.
+ */
+static VALUE
+KeyPair_freeze(VALUE self)
+{
+  KeyPair *key_pair;
+  static ID freeze_id;
+
+  if (!freeze_id)
+  {
+    CONST_ID(freeze_id, "freeze");
+  }
+
+  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, key_pair);
+  PublicKey_compressed_data(&(key_pair->public_key_data));
+
+  // Dispatch to #freeze rather than calling rb_obj_freeze so PublicKey#freeze
+  // caches both serializations before the public key becomes read-only
+  rb_funcall(KeyPair_public_key(self), freeze_id, 0);
+  rb_funcall(KeyPair_private_key(self), freeze_id, 0);
+
+  return rb_call_super(0, NULL);
+}
+
+/**
+ * Reads a DER length at the start of a buffer.
+ *
+ * \param in_data first byte of the length
+ * \param in_len number of bytes available
+ * \param out_value decoded length
+ * \return number of bytes the length occupies, 0 if it is truncated, longer
+ *   than the bytes following it, or too large to describe a signature
+ */
+static long
+ReadDerLength(const unsigned char *in_data, long in_len, size_t *out_value)
+{
+  size_t value;
+  long length_bytes;
+  long i;
+
+  if (in_len < 1)
+  {
+    return 0;
+  }
+
+  if (in_data[0] < 0x80)
+  {
+    value = in_data[0];
+    length_bytes = 0;
+  }
+  else
+  {
+    // Two length bytes describe far more than the largest signature
+    length_bytes = in_data[0] & 0x7f;
+    if (length_bytes == 0 || length_bytes > 2 || length_bytes >= in_len)
+    {
+      return 0;
+    }
+
+    value = 0;
+    for (i = 1; i <= length_bytes; i++)
+    {
+      value = (value << 8) | in_data[i];
+    }
+  }
+
+  if (value > (size_t)(in_len - 1 - length_bytes))
+  {
+    return 0;
+  }
+
+  *out_value = value;
+
+  return 1 + length_bytes;
+}
+
+/**
+ * Parses an integer of a lax DER signature into 32 big-endian bytes.
+ *
+ * \param in_data buffer holding the signature
+ * \param in_len number of bytes in in_data
+ * \param io_pos offset of the integer tag, advanced past the integer
+ * \param out_value32 integer value, left-padded with zeros
+ * \param out_overflow set to 1 if the value does not fit in 32 bytes
+ * \return 1 if the integer is structurally valid, 0 otherwise
+ */
+static int
+ReadLaxDerInteger(const unsigned char *in_data,
+                  long in_len,
+                  long *io_pos,
+                  unsigned char *out_value32,
+                  int *out_overflow)
+{
+  size_t value_len;
+  long pos;
+  long length_bytes;
+  long value_pos;
+
+  pos = *io_pos;
+  if (pos >= in_len || in_data[pos] != 0x02)
+  {
+    return 0;
+  }
+  pos++;
+
+  if (pos >= in_len)
+  {
+    return 0;
+  }
+  if (in_data[pos] < 0x80)
+  {
+    value_len = in_data[pos++];
+  }
+  else
+  {
+    // Long form lengths may have any number of leading zero bytes
+    length_bytes = in_data[pos++] & 0x7f;
+    if (length_bytes > in_len - pos)
+    {
+      return 0;
+    }
+    while (length_bytes > 0 && in_data[pos] == 0)
+    {
+      pos++;
+      length_bytes--;
+    }
+    if (length_bytes > 4)
+    {
+      return 0;
+    }
+    value_len = 0;
+    while (length_bytes > 0)
+    {
+      value_len = (value_len << 8) | in_data[pos++];
+      length_bytes--;
+    }
+  }
+  if (value_len > (size_t)(in_len - pos))
+  {
+    return 0;
+  }
+
+  value_pos = pos;
+  *io_pos = pos + (long)value_len;
+
+  while (value_len > 0 && in_data[value_pos] == 0)
+  {
+    value_pos++;
+    value_len--;
+  }
+  if (value_len > 32)
+  {
+    *out_overflow = 1;
+  }
+  else
+  {
+    MEMCPY(out_value32 + 32 - value_len, in_data + value_pos, unsigned char, value_len);
+  }
+
+  return 1;
+}
+
+/**
+ * Parses the DER encoded signature at the start of a buffer.
+ *
+ * In strict mode the signature must be valid DER and its extent is given by
+ * the length of the enclosing sequence. Lax mode accepts the malformed
+ * encodings found in historical Bitcoin transactions in the same way as
+ * ecdsa_signature_parse_der_lax from libsecp256k1's contrib directory: the
+ * sequence length is ignored, integers may be padded or use long form
+ * lengths, and values that do not fit in 32 bytes or overflow the curve order
+ * produce a signature of zeros that never verifies. The signature then ends
+ * after its S value.
+ *
+ * \param in_data first byte of the signature
+ * \param in_len number of bytes available, may exceed the signature length
+ * \param in_lax parse lax DER if non-zero
+ * \param out_signature parsed signature
+ * \return number of bytes the signature occupies, 0 if it is invalid
+ */
+static long
+ParseDerSignature(const unsigned char *in_data,
+                  long in_len,
+                  int in_lax,
+                  secp256k1_ecdsa_signature *out_signature)
+{
+  unsigned char compact[64];
+  size_t sequence_len;
+  long header_len;
+  long pos;
+  int overflow;
+
+  if (in_len < 2 || in_data[0] != 0x30)
+  {
+    return 0;
+  }
+
+  if (!in_lax)
+  {
+    header_len = ReadDerLength(in_data + 1, in_len - 1, &sequence_len);
+    if (header_len == 0)
+    {
+      return 0;
+    }
+
+    pos = 1 + header_len + (long)sequence_len;
+    if (secp256k1_ecdsa_signature_parse_der(secp256k1_context_static,
+                                            out_signature,
+                                            in_data,
+                                            pos) != 1)
+    {
+      return 0;
+    }
+
+    return pos;
+  }
+
+  // Like ecdsa_signature_parse_der_lax, skip the sequence length without
+  // decoding it, only requiring its length bytes to be present
+  header_len = 1;
+  if (in_data[1] & 0x80)
+  {
+    header_len += in_data[1] & 0x7f;
+    if (header_len > in_len - 1)
+    {
+      return 0;
+    }
+  }
+
+  MEMZERO(compact, unsigned char, 64);
+  overflow = 0;
+  pos = 1 + header_len;
+  if (!ReadLaxDerInteger(in_data, in_len, &pos, compact, &overflow) ||
+      !ReadLaxDerInteger(in_data, in_len, &pos, compact + 32, &overflow))
+  {
+    return 0;
+  }
+
+  if (overflow ||
+      secp256k1_ecdsa_signature_parse_compact(secp256k1_context_static,
+                                              out_signature,
+                                              compact) != 1)
+  {
+    MEMZERO(compact, unsigned char, 64);
+    secp256k1_ecdsa_signature_parse_compact(
+      secp256k1_context_static, out_signature, compact
+    );
+  }
+
+  return pos;
+}
+
+/**
+ * Reads the lax: keyword argument of the streaming DER parsers.
+ *
+ * \param in_opts keyword arguments hash, or Qnil
+ * \return non-zero if lax DER should be accepted
+ * \raise ArgumentError if an unknown keyword was given
+ */
+static int
+LaxDerOption(VALUE in_opts)
+{
+  static ID kwarg_id;
+  VALUE lax;
+
+  if (!kwarg_id)
+  {
+    CONST_ID(kwarg_id, "lax");
+  }
+
+  lax = Qundef;
+  rb_get_kwargs(in_opts, &kwarg_id, 0, 1, &lax);
+
+  return lax != Qundef && RTEST(lax);
+}
+
+/**
+ * Borrows the bytes of a String or IO::Buffer argument.
+ *
+ * \param in_buffer object to read from
+ * \param out_data set to the first byte of the object's data
+ * \param out_len set to the length of the object's data in bytes
+ * \raise TypeError if in_buffer is not a String or IO::Buffer
+ */
+static void
+RequireBorrowBytes(VALUE in_buffer,
+                   const unsigned char **out_data,
+                   long *out_len)
+{
+  if (!BorrowBytes(in_buffer, out_data, out_len))
+  {
+    rb_raise(
+      rb_eTypeError,
+      "wrong argument type %s (expected String or IO::Buffer)",
+      rb_obj_classname(in_buffer)
+    );
+  }
+}
+
+//
+// On-disk stores
+//
+// A PublicKeyArray or SignatureArray can be dumped to a file holding its
+// 64-byte entries exactly as libsecp256k1 keeps them in memory. Loading the
+// file maps it instead of parsing every entry again. Files start with a
+// 128-byte header followed by the entries:
+//
+//   offset  size  field
+//   0       8     magic "RBSECPST"
+//   8       4     format version (STORE_VERSION), little-endian
+//   12      4     kind of entries (StoreKindT), little-endian
+//   16      8     number of entries, little-endian
+//   24      64    reference entry as parsed by the writer
+//   88      32    SHA-256 of the entries
+//   120     8     reserved, zero
+//
+// The in-memory layout of parsed keys and signatures depends on how
+// libsecp256k1 was built, so a store is only loaded if its reference entry
+// matches the same entry parsed by the reader.
+//
+
+#define STORE_MAGIC "RBSECPST"
+#define STORE_VERSION 1
+#define STORE_HEADER_SIZE 128
+#define STORE_ENTRY_SIZE 64
+
+// Number of temporary file names tried before a dump gives up
+#define STORE_TEMP_ATTEMPTS 100
+
+// Only Windows distinguishes binary files
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif // O_BINARY
+
+typedef enum StoreKindT_dummy {
+  STORE_PUBLIC_KEYS = 1, // Entries are secp256k1_pubkey structs
+  STORE_SIGNATURES = 2 // Entries are secp256k1_ecdsa_signature structs
+} StoreKindT;
+
+// Compressed generator point, the reference entry of public key stores
+static const unsigned char STORE_REFERENCE_PUBLIC_KEY[33] = {
+  0x02, 0x79, 0xbe, 0x66, 0x7e, 0xf9, 0xdc, 0xbb, 0xac, 0x55, 0xa0, 0x62,
+  0x95, 0xce, 0x87, 0x0b, 0x07, 0x02, 0x9b, 0xfc, 0xdb, 0x2d, 0xce, 0x28,
+  0xd9, 0x59, 0xf2, 0x81, 0x5b, 0x16, 0xf8, 0x17, 0x98
+};
+
+/**
+ * Computes the reference entry of a kind of store.
+ *
+ * Signature stores use the compact signature whose bytes count up from 1,
+ * which keeps r and s distinct and below the curve order.
+ *
+ * \param in_kind kind of store
+ * \param out_reference 64-byte reference entry
+ */
+static void
+StoreReference(StoreKindT in_kind, unsigned char *out_reference)
+{
+  secp256k1_pubkey pubkey;
+  secp256k1_ecdsa_signature sig;
+  unsigned char compact[64];
+  int i;
+
+  if (in_kind == STORE_PUBLIC_KEYS)
+  {
+    secp256k1_ec_pubkey_parse(secp256k1_context_static,
+                              &pubkey,
+                              STORE_REFERENCE_PUBLIC_KEY,
+                              sizeof(STORE_REFERENCE_PUBLIC_KEY));
+    MEMCPY(out_reference, pubkey.data, unsigned char, STORE_ENTRY_SIZE);
+    return;
+  }
+
+  for (i = 0; i < 64; i++)
+  {
+    compact[i] = (unsigned char)(i + 1);
+  }
+  secp256k1_ecdsa_signature_parse_compact(
+    secp256k1_context_static, &sig, compact
+  );
+  MEMCPY(out_reference, sig.data, unsigned char, STORE_ENTRY_SIZE);
+}
+
+static void
+StorePutUint(unsigned char *out_data, uint64_t in_value, int in_len)
+{
+  int i;
+
+  for (i = 0; i < in_len; i++)
+  {
+    out_data[i] = (unsigned char)(in_value >> (8 * i));
+  }
+}
+
+static uint64_t
+StoreGetUint(const unsigned char *in_data, int in_len)
+{
+  uint64_t value;
+  int i;
+
+  value = 0;
+  for (i = in_len - 1; i >= 0; i--)
+  {
+    value = (value << 8) | in_data[i];
+  }
+
+  return value;
+}
+
+/**
+ * Writes a buffer to a file descriptor, retrying short writes.
+ *
+ * \param in_fd file descriptor to write to
+ * \param in_data bytes to be written
+ * \param in_len number of bytes in in_data
+ * \return 0 on success, -1 with errno set on failure
+ */
+static int
+StoreWriteAll(int in_fd, const unsigned char *in_data, size_t in_len)
+{
+  ssize_t written;
+
+  while (in_len > 0)
+  {
+    written = write(in_fd, in_data, in_len);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      return -1;
+    }
+
+    in_data += written;
+    in_len -= (size_t)written;
+  }
+
+  return 0;
+}
+
+/**
+ * Writes entries to a store file, atomically replacing any existing file.
+ *
+ * The store is written to a temporary file in the same directory which is
+ * then renamed over the path. Processes that have the previous store mapped,
+ * including this one, keep reading the previous file, and a failed dump
+ * leaves it intact.
+ *
+ * \param in_path path String of the file
+ * \param in_kind kind of entries
+ * \param in_entries entries to be written
+ * \param in_count number of entries
+ * \return number of bytes written
+ * \raise [SystemCallError] if the file cannot be written
+ */
+static VALUE
+StoreDump(VALUE in_path,
+          StoreKindT in_kind,
+          const void *in_entries,
+          long in_count)
+{
+  unsigned char header[STORE_HEADER_SIZE];
+  const char *path_name;
+  const char *temp_name;
+  VALUE temp_path;
+  size_t entries_len;
+  int saved_errno;
+  int attempt;
+  int failed;
+  int fd;
+
+  path_name = StringValueCStr(in_path);
+  entries_len = (size_t)in_count * STORE_ENTRY_SIZE;
+
+  MEMZERO(header, unsigned char, STORE_HEADER_SIZE);
+  MEMCPY(header, STORE_MAGIC, unsigned char, 8);
+  StorePutUint(header + 8, STORE_VERSION, 4);
+  StorePutUint(header + 12, in_kind, 4);
+  StorePutUint(header + 16, (uint64_t)in_count, 8);
+  StoreReference(in_kind, header + 24);
+  Sha256((const unsigned char*)in_entries, entries_len, header + 88);
+
+  // Temporary names are exclusive, so concurrent dumps from other processes
+  // or Ractors and files left behind by a crash fall through to the next one
+  fd = -1;
+  temp_path = Qnil;
+  temp_name = NULL;
+  for (attempt = 0; fd < 0 && attempt < STORE_TEMP_ATTEMPTS; attempt++)
+  {
+    temp_path = rb_sprintf(
+      "%"PRIsVALUE".%d.%d.tmp", in_path, (int)getpid(), attempt
+    );
+    temp_name = StringValueCStr(temp_path);
+    fd = rb_cloexec_open(
+      temp_name, O_WRONLY | O_CREAT | O_EXCL | O_BINARY, 0666
+    );
+    if (fd < 0 && errno != EEXIST)
+    {
+      rb_sys_fail_str(temp_path);
+    }
+  }
+  if (fd < 0)
+  {
+    rb_sys_fail_str(temp_path);
+  }
+  rb_update_max_fd(fd);
+
+  failed = StoreWriteAll(fd, header, STORE_HEADER_SIZE) != 0 ||
+           StoreWriteAll(fd, in_entries, entries_len) != 0;
+#ifdef HAVE_FSYNC
+  // Make the entries durable before the rename makes them visible
+  failed = failed || fsync(fd) != 0;
+#endif // HAVE_FSYNC
+
+  saved_errno = errno;
+  if (failed)
+  {
+    close(fd);
+  }
+  else if (close(fd) != 0 || rename(temp_name, path_name) != 0)
+  {
+    saved_errno = errno;
+    failed = 1;
+  }
+
+  if (failed)
+  {
+    unlink(temp_name);
+    errno = saved_errno;
+    rb_sys_fail_str(in_path);
+  }
+
+  RB_GC_GUARD(in_path);
+  RB_GC_GUARD(temp_path);
+
+  return SIZET2NUM(STORE_HEADER_SIZE + entries_len);
+}
+
+/**
+ * Checks that a store entry is a key or signature libsecp256k1 can use.
+ *
+ * libsecp256k1 aborts the process when handed a public key whose x
+ * coordinate is zero, so those are rejected before anything else. Every
+ * entry must then survive a serialize and parse round trip, which rejects
+ * points off the curve, non-canonical coordinates, and overflowing scalars.
+ *
+ * \param in_kind kind of entry
+ * \param in_entry 64-byte entry
+ * \return 1 if the entry is valid, 0 otherwise
+ */
+static int
+StoreEntryValid(StoreKindT in_kind, const unsigned char *in_entry)
+{
+  secp256k1_pubkey pubkey;
+  secp256k1_ecdsa_signature sig;
+  unsigned char serialized[UNCOMPRESSED_PUBKEY_SIZE_BYTES];
+  size_t serialized_len;
+  unsigned char x_bits;
+  int i;
+
+  if (in_kind == STORE_PUBLIC_KEYS)
+  {
+    // Parsed public keys start with their 32-byte x coordinate
+    x_bits = 0;
+    for (i = 0; i < 32; i++)
+    {
+      x_bits |= in_entry[i];
+    }
+    if (x_bits == 0)
+    {
+      return 0;
+    }
+
+    MEMCPY(pubkey.data, in_entry, unsigned char, STORE_ENTRY_SIZE);
+    serialized_len = sizeof(serialized);
+    secp256k1_ec_pubkey_serialize(secp256k1_context_static,
+                                  serialized,
+                                  &serialized_len,
+                                  &pubkey,
+                                  SECP256K1_EC_UNCOMPRESSED);
+
+    return secp256k1_ec_pubkey_parse(secp256k1_context_static,
+                                     &pubkey,
+                                     serialized,
+                                     serialized_len) == 1 &&
+           memcmp(pubkey.data, in_entry, STORE_ENTRY_SIZE) == 0;
+  }
+
+  MEMCPY(sig.data, in_entry, unsigned char, STORE_ENTRY_SIZE);
+  secp256k1_ecdsa_signature_serialize_compact(
+    secp256k1_context_static, serialized, &sig
+  );
+
+  return secp256k1_ecdsa_signature_parse_compact(secp256k1_context_static,
+                                                 &sig,
+                                                 serialized) == 1 &&
+         memcmp(sig.data, in_entry, STORE_ENTRY_SIZE) == 0;
+}
+
+// Arguments for checking the entries of a store without the GVL
+typedef struct StoreCheckArgs_dummy {
+  const unsigned char *entries; // Entries of a store not yet visible to Ruby
+  long count; // Number of entries
+  StoreKindT kind; // Kind of entries
+  int verify; // Compute the checksum of the entries if non-zero
+  unsigned char hash32[32]; // SHA-256 of entries, if verify is non-zero
+  long invalid; // Index of the first invalid entry, -1 if all are valid
+} StoreCheckArgs;
+
+static void*
+StoreCheck_without_gvl(void *in_args)
+{
+  StoreCheckArgs *args = (StoreCheckArgs*)in_args;
+  long i;
+
+  if (args->verify)
+  {
+    Sha256(
+      args->entries, (size_t)args->count * STORE_ENTRY_SIZE, args->hash32
+    );
+  }
+
+  args->invalid = -1;
+  for (i = 0; i < args->count; i++)
+  {
+    if (!StoreEntryValid(args->kind, args->entries + i * STORE_ENTRY_SIZE))
+    {
+      args->invalid = i;
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Checks the header and entries of a loaded store.
+ *
+ * Every entry is validated with StoreEntryValid whether or not the checksum
+ * is verified, as the checksum is unkeyed and only detects accidental
+ * corruption.
+ *
+ * \param in_data contents of the store file
+ * \param in_len length of in_data in bytes
+ * \param in_kind kind of entries expected
+ * \param in_verify compare the entries against their checksum if non-zero
+ * \param out_count number of entries in the store
+ * \return NULL if the store is valid, otherwise a description of the problem
+ */
+static const char*
+StoreCheck(const unsigned char *in_data,
+           size_t in_len,
+           StoreKindT in_kind,
+           int in_verify,
+           long *out_count)
+{
+  StoreCheckArgs args;
+  unsigned char reference[STORE_ENTRY_SIZE];
+  uint64_t count;
+
+  if (in_len < STORE_HEADER_SIZE || memcmp(in_data, STORE_MAGIC, 8) != 0)
+  {
+    return "not a public key or signature store";
+  }
+
+  if (StoreGetUint(in_data + 8, 4) != STORE_VERSION)
+  {
+    return "unsupported store version";
+  }
+
+  if (StoreGetUint(in_data + 12, 4) != (uint64_t)in_kind)
+  {
+    return in_kind == STORE_PUBLIC_KEYS ?
+      "store does not hold public keys" :
+      "store does not hold signatures";
+  }
+
+  count = StoreGetUint(in_data + 16, 8);
+  if (count > (in_len - STORE_HEADER_SIZE) / STORE_ENTRY_SIZE ||
+      in_len - STORE_HEADER_SIZE != count * STORE_ENTRY_SIZE)
+  {
+    return "store length does not match its number of entries";
+  }
+
+  StoreReference(in_kind, reference);
+  if (memcmp(in_data + 24, reference, STORE_ENTRY_SIZE) != 0)
+  {
+    return "store was written by an incompatible build of libsecp256k1";
+  }
+
+  args.entries = in_data + STORE_HEADER_SIZE;
+  args.count = (long)count;
+  args.kind = in_kind;
+  args.verify = in_verify;
+  WithoutGVL(StoreCheck_without_gvl, &args);
+
+  if (in_verify && memcmp(in_data + 88, args.hash32, 32) != 0)
+  {
+    return "store checksum does not match";
+  }
+
+  if (args.invalid >= 0)
+  {
+    return in_kind == STORE_PUBLIC_KEYS ?
+      "store holds an invalid public key" :
+      "store holds an invalid signature";
+  }
+
+  *out_count = (long)count;
+
+  return NULL;
+}
+
+/**
+ * Loads a store file, mapping it into memory where supported.
+ *
+ * \param in_path path String of the file
+ * \param in_kind kind of entries expected
+ * \param in_verify compare the entries against their checksum if non-zero
+ * \param out_backing contents of the file, released with ReleaseBacking
+ * \param out_backing_len length of out_backing in bytes
+ * \param out_count number of entries, which start STORE_HEADER_SIZE bytes
+ *   into out_backing
+ * \raise [SystemCallError] if the file cannot be read
+ * \raise [Secp256k1::DeserializationError] if the store is invalid
+ */
+static void
+StoreLoad(VALUE in_path,
+          StoreKindT in_kind,
+          int in_verify,
+          void **out_backing,
+          size_t *out_backing_len,
+          long *out_count)
+{
+  const char *error;
+  void *backing;
+  size_t backing_len;
+#ifdef HAVE_MMAP
+  struct stat file_stat;
+  int saved_errno;
+  int fd;
+
+  fd = rb_cloexec_open(StringValueCStr(in_path), O_RDONLY, 0);
+  if (fd < 0)
+  {
+    rb_sys_fail_str(in_path);
+  }
+  rb_update_max_fd(fd);
+
+  if (fstat(fd, &file_stat) != 0)
+  {
+    saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    rb_sys_fail_str(in_path);
+  }
+
+  backing_len = (size_t)file_stat.st_size;
+  if (backing_len < STORE_HEADER_SIZE)
+  {
+    close(fd);
+    rb_raise(
+      Secp256k1_DeserializationError_class,
+      "not a public key or signature store"
+    );
+  }
+
+  // Private read-only mappings are shared with forked children
+  backing = mmap(NULL, backing_len, PROT_READ, MAP_PRIVATE, fd, 0);
+  saved_errno = errno;
+  close(fd);
+  if (backing == MAP_FAILED)
+  {
+    errno = saved_errno;
+    rb_sys_fail_str(in_path);
+  }
+#else
+  VALUE contents;
+
+  contents = rb_funcall(rb_cFile, rb_intern("binread"), 1, in_path);
+  backing_len = (size_t)RSTRING_LEN(contents);
+  backing = xmalloc(backing_len);
+  MEMCPY(backing, RSTRING_PTR(contents), char, backing_len);
+#endif // HAVE_MMAP
+
+  error = StoreCheck(
+    (const unsigned char*)backing, backing_len, in_kind, in_verify, out_count
+  );
+  if (error != NULL)
+  {
+    ReleaseBacking(backing, backing_len);
+    rb_raise(Secp256k1_DeserializationError_class, "%s", error);
+  }
+
+  *out_backing = backing;
+  *out_backing_len = backing_len;
+}
+
+/**
+ * Reads the verify: keyword argument of the store loaders.
+ *
+ * \param in_opts keyword arguments hash, or Qnil
+ * \return non-zero unless verify: false was given
+ * \raise ArgumentError if an unknown keyword was given
+ */
+static int
+StoreVerifyOption(VALUE in_opts)
+{
+  static ID kwarg_id;
+  VALUE verify;
+
+  if (!kwarg_id)
+  {
+    CONST_ID(kwarg_id, "verify");
+  }
+
+  verify = Qundef;
+  rb_get_kwargs(in_opts, &kwarg_id, 0, 1, &verify);
+
+  return verify == Qundef || RTEST(verify);
+}
+
+//
+// Secp256k1::PublicKeyArray class interface
+//
+
+static VALUE
+PublicKeyArray_alloc(VALUE klass)
+{
+  PublicKeyArray *public_key_array;
+
+  return TypedData_Make_Struct(
+    klass, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+}
+
+/**
+ * Ensures an array has room for more public keys, growing it geometrically.
+ *
+ * \param public_key_array array to be grown
+ * \param in_additional number of public keys about to be appended
+ */
+static void
+PublicKeyArray_reserve(PublicKeyArray *public_key_array, long in_additional)
+{
+  long capacity;
+  secp256k1_pubkey *pubkeys;
+
+  if (public_key_array->size + in_additional <= public_key_array->capacity)
+  {
+    return;
+  }
+
+  capacity = public_key_array->capacity * 2;
+  if (capacity < public_key_array->size + in_additional)
+  {
+    capacity = public_key_array->size + in_additional;
+  }
+
+  if (public_key_array->backing != NULL)
+  {
+    // Loaded stores are read-only, so they are copied to the heap before
+    // anything is appended
+    pubkeys = ALLOC_N(secp256k1_pubkey, capacity);
+    MEMCPY(
+      pubkeys, public_key_array->pubkeys, secp256k1_pubkey, public_key_array->size
+    );
+    ReleaseBacking(public_key_array->backing, public_key_array->backing_len);
+    public_key_array->backing = NULL;
+    public_key_array->backing_len = 0;
+    public_key_array->pubkeys = pubkeys;
+  }
+  else
+  {
+    REALLOC_N(public_key_array->pubkeys, secp256k1_pubkey, capacity);
+  }
+  public_key_array->capacity = capacity;
+}
+
+/**
+ * Creates an empty public key array.
+ *
+ * @param capacity [Integer] (Optional) number of public keys to allocate room
+ *   for up front. Defaults to 0.
+ * @raise [Secp256k1::Error] if capacity is negative.
+ */
+static VALUE
+PublicKeyArray_initialize(int argc, const VALUE *argv, VALUE self)
+{
+  PublicKeyArray *public_key_array;
+  VALUE opts;
+  VALUE capacity;
+  static ID kwarg_ids;
+
+  if (!kwarg_ids)
+  {
+    CONST_ID(kwarg_ids, "capacity");
+  }
+
+  capacity = Qundef;
+  rb_scan_args(argc, argv, ":", &opts);
+  rb_get_kwargs(opts, &kwarg_ids, 0, 1, &capacity);
+
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+  if (capacity != Qundef)
+  {
+    if (NUM2LONG(capacity) < 0)
+    {
+      rb_raise(Secp256k1_Error_class, "capacity must not be negative");
+    }
+
+    PublicKeyArray_reserve(public_key_array, NUM2LONG(capacity));
+  }
+
+  return self;
+}
+
+/**
+ * Appends a copy of a public key.
+ *
+ * @param in_public_key [Secp256k1::PublicKey] public key to append.
+ * @return [Secp256k1::PublicKeyArray] this array.
+ * @raise [FrozenError] if this array is frozen.
+ */
+static VALUE
+PublicKeyArray_push(VALUE self, VALUE in_public_key)
+{
+  PublicKeyArray *public_key_array;
+  PublicKey *public_key;
+
+  rb_check_frozen(self);
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+  TypedData_Get_Struct(in_public_key, PublicKey, &PublicKey_DataType, public_key);
+
+  PublicKeyArray_reserve(public_key_array, 1);
+  public_key_array->pubkeys[public_key_array->size++] = public_key->pubkey;
+
+  return self;
+}
+
+/**
+ * Parses serialized public keys stored back to back and appends them.
+ *
+ * Nothing is appended unless every public key parses.
+ *
+ * \param self array to append to
+ * \param in_buffer String or IO::Buffer of serialized public keys
+ * \param in_key_len length of each serialized public key
+ * \return self
+ * \raise [Secp256k1::Error] if the buffer is not a multiple of in_key_len
+ * \raise [Secp256k1::DeserializationError] if a public key is invalid
+ */
+static VALUE
+PublicKeyArray_append_serialized(VALUE self, VALUE in_buffer, long in_key_len)
+{
+  PublicKeyArray *public_key_array;
+  const unsigned char *data;
+  long data_len;
+  long count;
+  long i;
+
+  rb_check_frozen(self);
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+
+  RequireBorrowBytes(in_buffer, &data, &data_len);
+  if (data_len % in_key_len != 0)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "public key data must be a multiple of %ld bytes",
+      in_key_len
+    );
+  }
+
+  // Growing may run GC, which can move the data of an embedded string
+  count = data_len / in_key_len;
+  PublicKeyArray_reserve(public_key_array, count);
+  RequireBorrowBytes(in_buffer, &data, &data_len);
+
+  for (i = 0; i < count; i++)
+  {
+    if (secp256k1_ec_pubkey_parse(
+          secp256k1_context_static,
+          &(public_key_array->pubkeys[public_key_array->size + i]),
+          data + i * in_key_len,
+          in_key_len) != 1)
+    {
+      rb_raise(
+        Secp256k1_DeserializationError_class,
+        "invalid public key data at offset %ld",
+        i * in_key_len
+      );
+    }
+  }
+  public_key_array->size += count;
+
+  return self;
+}
+
+/**
+ * Parses compressed public keys stored back to back and appends them.
+ *
+ * Nothing is appended unless every public key parses.
+ *
+ * @param in_buffer [String, IO::Buffer] concatenated 33-byte compressed
+ *   public keys.
+ * @return [Secp256k1::PublicKeyArray] this array.
+ * @raise [Secp256k1::Error] if the buffer length is not a multiple of 33.
+ * @raise [Secp256k1::DeserializationError] if a public key is invalid.
+ * @raise [FrozenError] if this array is frozen.
+ */
+static VALUE
+PublicKeyArray_append_compressed(VALUE self, VALUE in_buffer)
+{
+  return PublicKeyArray_append_serialized(
+    self, in_buffer, COMPRESSED_PUBKEY_SIZE_BYTES
+  );
+}
+
+/**
+ * Parses uncompressed public keys stored back to back and appends them.
+ *
+ * Accepts the output of {Context#recover_packed} and
+ * {Context#recover_public_keys_batch} when every entry was recovered. Nothing
+ * is appended unless every public key parses.
+ *
+ * @param in_buffer [String, IO::Buffer] concatenated 65-byte uncompressed
+ *   public keys.
+ * @return [Secp256k1::PublicKeyArray] this array.
+ * @raise [Secp256k1::Error] if the buffer length is not a multiple of 65.
+ * @raise [Secp256k1::DeserializationError] if a public key is invalid.
+ * @raise [FrozenError] if this array is frozen.
+ */
+static VALUE
+PublicKeyArray_append_uncompressed(VALUE self, VALUE in_buffer)
+{
+  return PublicKeyArray_append_serialized(
+    self, in_buffer, UNCOMPRESSED_PUBKEY_SIZE_BYTES
+  );
+}
+
+/**
+ * Returns the public key at an index.
+ *
+ * @param in_index [Integer] index of the public key, negative indexes count
+ *   from the end.
+ * @return [Secp256k1::PublicKey, nil] copy of the public key, nil if the index
+ *   is out of range.
+ */
+static VALUE
+PublicKeyArray_aref(VALUE self, VALUE in_index)
+{
+  PublicKeyArray *public_key_array;
+  PublicKey *public_key;
+  VALUE result;
+  long index;
+
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+
+  index = NUM2LONG(in_index);
+  if (index < 0)
+  {
+    index += public_key_array->size;
+  }
+  if (index < 0 || index >= public_key_array->size)
+  {
+    return Qnil;
+  }
+
+  result = PublicKey_alloc(Secp256k1_PublicKey_class);
+  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+  public_key->pubkey = public_key_array->pubkeys[index];
+
+  return result;
+}
+
+/**
+ * @return [Integer] number of public keys in this array.
+ */
+static VALUE
+PublicKeyArray_size(VALUE self)
+{
+  PublicKeyArray *public_key_array;
+
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+
+  return LONG2NUM(public_key_array->size);
+}
+
+static VALUE
+PublicKeyArray_enum_size(VALUE self, VALUE args, VALUE eobj)
+{
+  return PublicKeyArray_size(self);
+}
+
+/**
+ * Yields a copy of each public key in order.
+ *
+ * @yieldparam public_key [Secp256k1::PublicKey] public key in this array.
+ * @return [Secp256k1::PublicKeyArray, Enumerator] this array, or an
+ *   enumerator if no block was given.
+ */
+static VALUE
+PublicKeyArray_each(VALUE self)
+{
+  PublicKeyArray *public_key_array;
+  long i;
+
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, PublicKeyArray_enum_size);
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+
+  // The block may append to the array, so its size is read on every pass
+  for (i = 0; i < public_key_array->size; i++)
+  {
+    rb_yield(PublicKeyArray_aref(self, LONG2NUM(i)));
+  }
+
+  return self;
+}
+
+/**
+ * Loads public keys from a store written by PublicKeyArray#dump.
+ *
+ * Where supported the store is mapped into memory rather than read, so
+ * loading is cheap and processes sharing a store share its pages. Its
+ * public keys are not parsed again, but each one is validated before the
+ * array is returned.
+ *
+ * @param path [String] path of the store file.
+ * @param verify [Boolean] (Optional) check the public keys against the
+ *   checksum in the store. Defaults to true. The checksum only detects
+ *   accidental corruption, as anyone able to modify the store can recompute
+ *   it.
+ * @return [Secp256k1::PublicKeyArray] public keys held in the store.
+ * @raise [SystemCallError] if the file cannot be read.
+ * @raise [Secp256k1::DeserializationError] if the file is not a store of
+ *   public keys, was written by an incompatible build of libsecp256k1, holds
+ *   an invalid public key, or its checksum does not match.
+ */
+static VALUE
+PublicKeyArray_load(int argc, const VALUE *argv, VALUE klass)
+{
+  PublicKeyArray *public_key_array;
+  VALUE in_path;
+  VALUE opts;
+  VALUE result;
+  void *backing;
+  size_t backing_len;
+  long count;
+  int verify;
+
+  rb_scan_args(argc, argv, "1:", &in_path, &opts);
+  verify = StoreVerifyOption(opts);
+  in_path = rb_get_path(in_path);
+
+  result = PublicKeyArray_alloc(klass);
+  TypedData_Get_Struct(
+    result, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+
+  StoreLoad(in_path, STORE_PUBLIC_KEYS, verify, &backing, &backing_len, &count);
+  public_key_array->backing = backing;
+  public_key_array->backing_len = backing_len;
+  public_key_array->pubkeys = (secp256k1_pubkey*)((unsigned char*)backing + STORE_HEADER_SIZE);
+  public_key_array->size = count;
+  public_key_array->capacity = count;
+
+  return result;
+}
+
+/**
+ * Writes the public keys in this array to a store file.
+ *
+ * Stores hold public keys in the form libsecp256k1 parses them into, so
+ * PublicKeyArray.load can use them without parsing. Any existing file at the
+ * path is replaced.
+ *
+ * @param in_path [String] path of the store file.
+ * @return [Integer] number of bytes written.
+ * @raise [SystemCallError] if the file cannot be written.
+ */
+static VALUE
+PublicKeyArray_dump(VALUE self, VALUE in_path)
+{
+  PublicKeyArray *public_key_array;
+
+  // Converting the path may run Ruby code, so it happens before the
+  // public keys are borrowed
+  in_path = rb_get_path(in_path);
+  TypedData_Get_Struct(
+    self, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+  );
+
+  return StoreDump(
+    in_path, STORE_PUBLIC_KEYS, public_key_array->pubkeys, public_key_array->size
+  );
+}
+
+//
+// Secp256k1::Signature class interface
+//
+
+static VALUE
+Signature_alloc(VALUE klass)
+{
+  Signature *signature;
+
+  return TypedData_Make_Struct(
+    klass, Signature, &Signature_DataType, signature
+  );
+}
+
+// Arguments for walking a buffer of concatenated DER signatures
+typedef struct DerStreamArgs_dummy {
+  VALUE buffer; // String or IO::Buffer holding the signatures
+  int lax; // Accept lax DER if non-zero
+  VALUE output; // String receiving compact signatures, or Qnil to yield
+} DerStreamArgs;
+
+static VALUE
+DerStream_body(VALUE in_args)
+{
+  DerStreamArgs *args = (DerStreamArgs*)in_args;
+  const unsigned char *data;
+  secp256k1_ecdsa_signature parsed;
+  unsigned char compact[64];
+  Signature *signature;
+  VALUE signature_result;
+  long data_len;
+  long offset;
+  long signature_len;
+
+  offset = 0;
+  RequireBorrowBytes(args->buffer, &data, &data_len);
+  while (offset < data_len)
+  {
+    signature_len = ParseDerSignature(
+      data + offset, data_len - offset, args->lax, &parsed
+    );
+    if (signature_len == 0)
+    {
+      rb_raise(
+        Secp256k1_DeserializationError_class,
+        "invalid DER encoded signature at offset %ld",
+        offset
+      );
+    }
+
+    if (NIL_P(args->output))
+    {
+      signature_result = Signature_alloc(Secp256k1_Signature_class);
+      TypedData_Get_Struct(
+        signature_result, Signature, &Signature_DataType, signature
+      );
+      signature->sig = parsed;
+      rb_yield_values(2, signature_result, LONG2NUM(offset));
+    }
+    else
+    {
+      secp256k1_ecdsa_signature_serialize_compact(
+        secp256k1_context_static, compact, &parsed
+      );
+      rb_str_cat(args->output, (const char*)compact, 64);
+    }
+    offset += signature_len;
+
+    // The buffer cannot change length while locked, but allocating or running
+    // the block may let GC compaction move an embedded string
+    RequireBorrowBytes(args->buffer, &data, &data_len);
+  }
+
+  return Qnil;
+}
+
+/**
+ * Deserializes a Signature from 64-byte compact signature data.
+ *
+ * @param in_compact_signature [String, IO::Buffer] 64-byte compact
+ *   signature.
+ * @param normalize [Boolean] (Optional) convert the signature to its lower-S
+ *   form while parsing.
+ * @return [Secp256k1::Signature] object deserialized from compact signature.
+ * @raise [Secp256k1::DeserializationError] if signature data is invalid.
+ */
+static VALUE
+Signature_from_compact(int argc, const VALUE *argv, VALUE klass)
+{
+  Signature *signature;
+  VALUE in_compact_signature;
+  VALUE opts;
+  VALUE signature_result;
+  unsigned char scratch[64];
+  const unsigned char *signature_data;
+  long signature_data_len;
+  int normalize;
+
+  rb_scan_args(argc, argv, "1:", &in_compact_signature, &opts);
+  normalize = NormalizeOption(opts);
+
+  signature_data = InputBytes(
+    in_compact_signature, scratch, sizeof(scratch), &signature_data_len
+  );
+  if (signature_data_len != 64)
+  {
+    rb_raise(Secp256k1_Error_class, "compact signature must be 64 bytes");
+  }
+
+  signature_result = Signature_alloc(Secp256k1_Signature_class);
+  TypedData_Get_Struct(signature_result, Signature, &Signature_DataType, signature);
+
+  if (secp256k1_ecdsa_signature_parse_compact(secp256k1_context_static,
+                                              &(signature->sig),
+                                              signature_data) != 1)
+  {
+    rb_raise(Secp256k1_DeserializationError_class, "invalid compact signature");
+  }
+
+  if (normalize)
+  {
+    secp256k1_ecdsa_signature_normalize(
+      secp256k1_context_static, &(signature->sig), &(signature->sig)
+    );
+  }
+
+  return signature_result;
+}
+
+/**
+ * Converts a DER encoded binary signature into a signature object.
+ *
+ * @param in_der_encoded_signature [String, IO::Buffer] DER encoded
+ *   signature.
+ * @param normalize [Boolean] (Optional) convert the signature to its lower-S
+ *   form while parsing.
+ * @return [Secp256k1::Signature] signature object initialized using signature
+ *   data.
+ * @raise [Secp256k1::DeserializationError] if signature data is invalid.
+ */
+static VALUE
+Signature_from_der_encoded(int argc, const VALUE *argv, VALUE klass)
+{
+  Signature *signature;
+  VALUE in_der_encoded_signature;
+  VALUE opts;
+  VALUE signature_result;
+  unsigned char scratch[72];
+  const unsigned char *signature_data;
+  long signature_data_len;
+  int normalize;
+
+  rb_scan_args(argc, argv, "1:", &in_der_encoded_signature, &opts);
+  normalize = NormalizeOption(opts);
+
+  signature_data = InputBytes(
+    in_der_encoded_signature, scratch, sizeof(scratch), &signature_data_len
+  );
+  // Only memory views are copied into scratch. DER longer than 72 bytes can
+  // only hold overflowing integers, which never verify, so those views are
+  // rejected rather than copied in full
+  if (signature_data == scratch && signature_data_len > (long)sizeof(scratch))
+  {
+    rb_raise(Secp256k1_DeserializationError_class, "invalid DER encoded signature");
+  }
+
+  signature_result = Signature_alloc(Secp256k1_Signature_class);
+  TypedData_Get_Struct(signature_result, Signature, &Signature_DataType, signature);
+
+  if (secp256k1_ecdsa_signature_parse_der(secp256k1_context_static,
+                                          &(signature->sig),
+                                          signature_data,
+                                          signature_data_len) != 1)
+  {
+    rb_raise(Secp256k1_DeserializationError_class, "invalid DER encoded signature");
+  }
+
+  if (normalize)
+  {
+    secp256k1_ecdsa_signature_normalize(
+      secp256k1_context_static, &(signature->sig), &(signature->sig)
+    );
+  }
+
+  return signature_result;
+}
+
+/**
+ * Parses DER encoded signatures stored back to back in one buffer.
+ *
+ * Each signature is parsed in place without slicing the buffer into
+ * substrings. Unfrozen strings and IO::Buffer objects are locked against
+ * modification until iteration finishes.
+ *
+ * @param in_buffer [String, IO::Buffer] concatenated DER encoded signatures.
+ * @param lax [Boolean] (Optional) accept the malformed DER encodings found in
+ *   historical Bitcoin transactions.
+ * @yieldparam signature [Secp256k1::Signature] parsed signature.
+ * @yieldparam offset [Integer] offset of the signature in the buffer.
+ * @return [Enumerator, nil] an enumerator if no block was given.
+ * @raise [Secp256k1::DeserializationError] if a signature is invalid, after
+ *   yielding every signature before it.
+ */
+static VALUE
+Signature_each_der_encoded(int argc, const VALUE *argv, VALUE klass)
+{
+  DerStreamArgs args;
+  VALUE opts;
+  const unsigned char *data;
+  long data_len;
+
+#ifdef RETURN_SIZED_ENUMERATOR_KW
+  RETURN_SIZED_ENUMERATOR_KW(klass, argc, argv, 0, RB_PASS_CALLED_KEYWORDS);
+#else
+  RETURN_ENUMERATOR(klass, argc, argv);
+#endif // RETURN_SIZED_ENUMERATOR_KW
+
+  rb_scan_args(argc, argv, "1:", &args.buffer, &opts);
+  args.lax = LaxDerOption(opts);
+  args.output = Qnil;
+
+  // Reject other types before trying to lock them
+  RequireBorrowBytes(args.buffer, &data, &data_len);
+  WithLockedBuffer(args.buffer, DerStream_body, (VALUE)&args);
+
+  return Qnil;
+}
+
+/**
+ * Converts DER encoded signatures stored back to back into compact form.
+ *
+ * No Signature objects are created.
+ *
+ * @param in_buffer [String, IO::Buffer] concatenated DER encoded signatures.
+ * @param lax [Boolean] (Optional) accept the malformed DER encodings found in
+ *   historical Bitcoin transactions.
+ * @return [String] binary string of 64-byte compact signatures in the same
+ *   order as in the buffer.
+ * @raise [Secp256k1::DeserializationError] if a signature is invalid.
+ */
+static VALUE
+Signature_der_encoded_to_compact(int argc, const VALUE *argv, VALUE klass)
+{
+  DerStreamArgs args;
+  VALUE opts;
+  const unsigned char *data;
+  long data_len;
+
+  rb_scan_args(argc, argv, "1:", &args.buffer, &opts);
+  args.lax = LaxDerOption(opts);
+
+  // Strict DER signatures are at most 72 bytes, so the output is at least
+  // this long
+  RequireBorrowBytes(args.buffer, &data, &data_len);
+  args.output = rb_str_buf_new(data_len / 72 * 64);
+
+  WithLockedBuffer(args.buffer, DerStream_body, (VALUE)&args);
+
+  return args.output;
+}
+
+/**
+ * Return Distinguished Encoding Rules (DER) encoded signature data.
+ *
+ * @return [String] binary string containing DER-encoded signature data.
+ */
+static VALUE
+Signature_der_encoded(VALUE self)
+{
+  // TODO: Cache value after first computation
+  Signature *signature;
+  unsigned long der_signature_len;
+  unsigned char der_signature[72];
+
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  der_signature_len = 72;
+  if (secp256k1_ecdsa_signature_serialize_der(secp256k1_context_static,
+                                              der_signature,
+                                              &der_signature_len,
+                                              &(signature->sig)) != 1)
+  {
+    rb_raise(
+      Secp256k1_SerializationError_class,
+      "could not compute DER encoded signature"
+    );
+  }
+
+  return rb_str_new((char*)der_signature, der_signature_len);
+}
+
+/**
+ * Returns the 64 byte compact representation of this signature.
+ *
+ * @return [String] 64 byte binary string containing signature data.
+ */
+static VALUE
+Signature_compact(VALUE self)
+{
+  // TODO: Cache value after first computation
+  Signature *signature;
+  unsigned char compact_signature[COMPACT_SIG_SIZE_BYTES];
+
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  if (secp256k1_ecdsa_signature_serialize_compact(secp256k1_context_static,
+                                                  compact_signature,
+                                                  &(signature->sig)) != 1)
+  {
+    rb_raise(
+      Secp256k1_SerializationError_class,
+      "unable to compute compact signature"
+    );
+  }
+
+  return rb_str_new((char*)compact_signature, COMPACT_SIG_SIZE_BYTES);
+}
+
+/**
+ * Writes the DER encoded representation of this signature into a buffer.
+ *
+ * @param buffer [String,IO::Buffer] buffer to write into.
+ * @param offset [Integer,nil] (Optional) byte offset to write at. Omit to
+ *   append to a String buffer.
+ * @return [Integer] offset just past the bytes written, at most 72 bytes past
+ *   the starting offset.
+ * @raise [Secp256k1::SerializationError] if the signature cannot be encoded.
+ * @raise [Secp256k1::Error] if the offset is invalid or the data does not fit
+ *   in an IO::Buffer.
+ */
+static VALUE
+Signature_write_der_encoded(int argc, const VALUE *argv, VALUE self)
+{
+  Signature *signature;
+  size_t der_signature_len;
+  unsigned char der_signature[72];
+  VALUE buffer;
+  VALUE offset;
+
+  rb_scan_args(argc, argv, "11", &buffer, &offset);
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  der_signature_len = 72;
+  if (secp256k1_ecdsa_signature_serialize_der(secp256k1_context_static,
+                                              der_signature,
+                                              &der_signature_len,
+                                              &(signature->sig)) != 1)
+  {
+    rb_raise(
+      Secp256k1_SerializationError_class,
+      "could not compute DER encoded signature"
+    );
+  }
+
+  return WriteToBuffer(buffer, offset, der_signature, (long)der_signature_len);
+}
+
+/**
+ * Writes the 64 byte compact representation of this signature into a buffer.
+ *
+ * @param buffer [String,IO::Buffer] buffer to write into.
+ * @param offset [Integer,nil] (Optional) byte offset to write at. Omit to
+ *   append to a String buffer.
+ * @return [Integer] offset just past the 64 bytes written.
+ * @raise [Secp256k1::SerializationError] if the signature cannot be encoded.
+ * @raise [Secp256k1::Error] if the offset is invalid or the data does not fit
+ *   in an IO::Buffer.
+ */
+static VALUE
+Signature_write_compact(int argc, const VALUE *argv, VALUE self)
+{
+  Signature *signature;
+  unsigned char compact_signature[COMPACT_SIG_SIZE_BYTES];
+  VALUE buffer;
+  VALUE offset;
+
+  rb_scan_args(argc, argv, "11", &buffer, &offset);
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  if (secp256k1_ecdsa_signature_serialize_compact(secp256k1_context_static,
+                                                  compact_signature,
+                                                  &(signature->sig)) != 1)
+  {
+    rb_raise(
+      Secp256k1_SerializationError_class,
+      "unable to compute compact signature"
+    );
+  }
+
+  return WriteToBuffer(
+    buffer, offset, compact_signature, COMPACT_SIG_SIZE_BYTES
+  );
+}
+
+/**
+ * Returns the normalized lower-S form of this signature.
+ *
+ * This can be useful when importing signatures generated by other applications
+ * that may not be normalized. Non-normalized signatures are potentially
+ * forgeable.
+ *
+ * @return [Array] first element is a boolean that is `true` if the signature
+ *   was normalized, false otherwise. The second element is a `Signature`
+ *   object corresponding to the normalized signature, which is this signature
+ *   itself if it was already in lower-S form.
+ */
+static VALUE
+Signature_normalized(VALUE self)
+{
+  VALUE result_sig;
+  VALUE was_normalized;
+  VALUE result;
+  Signature *signature;
+  Signature *normalized_signature;
+  secp256k1_ecdsa_signature normalized;
+
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  // Signatures are immutable so one already in lower-S form is returned as is
+  was_normalized = Qfalse;
+  result_sig = self;
+  if (secp256k1_ecdsa_signature_normalize(
+        secp256k1_context_static,
+        &normalized,
+        &(signature->sig)) == 1)
+  {
+    was_normalized = Qtrue;
+    result_sig = Signature_alloc(Secp256k1_Signature_class);
+    TypedData_Get_Struct(
+      result_sig, Signature, &Signature_DataType, normalized_signature
+    );
+    normalized_signature->sig = normalized;
+  }
+
+  result = rb_ary_new2(2);
+  rb_ary_push(result, was_normalized);
+  rb_ary_push(result, result_sig);
+
+  return result;
+}
+
+/**
+ * Checks whether this signature is in normalized lower-S form.
+ *
+ * Unlike {#normalized} no object is allocated, which makes this suitable for
+ * rejecting high-S signatures outright.
+ *
+ * @return [Boolean] true if the S value is at most half the curve order.
+ */
+static VALUE
+Signature_low_s(VALUE self)
+{
+  Signature *signature;
+
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  return secp256k1_ecdsa_signature_normalize(
+    secp256k1_context_static, NULL, &(signature->sig)
+  ) == 1 ? Qfalse : Qtrue;
+}
+
+/**
+ * Compares two signatures.
+ *
+ * Two signatures are equal if their compact encodings are identical.
+ *
+ * @param other [Secp256k1::Signature] signature to compare
+ * @return [Boolean] true if signatures match, false otherwise.
+ */
+static VALUE
+Signature_equals(VALUE self, VALUE other)
+{
+  Signature *lhs;
+  Signature *rhs;
+  unsigned char lhs_compact[64];
+  unsigned char rhs_compact[64];
+
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, lhs);
+  TypedData_Get_Struct(other, Signature, &Signature_DataType, rhs);
+
+  secp256k1_ecdsa_signature_serialize_compact(
+    secp256k1_context_static, lhs_compact, &(lhs->sig)
+  );
+  secp256k1_ecdsa_signature_serialize_compact(
+    secp256k1_context_static, rhs_compact, &(rhs->sig)
+  );
+
+  if (memcmp(lhs_compact, rhs_compact, 64) == 0)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
+}
+
+/**
+ * Compares two signatures for use as hash keys.
+ *
+ * @param other [Object] object to compare.
+ * @return [Boolean] true if other is a signature equal to this one, false
+ *   otherwise.
+ */
+static VALUE
+Signature_eql(VALUE self, VALUE other)
+{
+  if (!rb_typeddata_is_kind_of(other, &Signature_DataType))
+  {
+    return Qfalse;
+  }
+
+  return Signature_equals(self, other);
+}
+
+/**
+ * Computes a hash value for this signature.
+ *
+ * Signatures that are equal have the same hash value.
+ *
+ * @return [Integer] hash of the signature data.
+ */
+static VALUE
+Signature_hash(VALUE self)
+{
+  Signature *signature;
+
+  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+
+  // NOTE: libsecp256k1 stores fully reduced scalars in the signature, so
+  // signatures with identical compact encodings have identical data.
+  return ST2FIX(
+    rb_memhash(&(signature->sig), sizeof(secp256k1_ecdsa_signature))
+  );
+}
+
+//
+// Secp256k1::SignatureArray class interface
+//
+
+static VALUE
+SignatureArray_alloc(VALUE klass)
+{
+  SignatureArray *signature_array;
+
+  return TypedData_Make_Struct(
+    klass, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+}
+
+/**
+ * Ensures an array has room for more signatures, growing it geometrically.
+ *
+ * \param signature_array array to be grown
+ * \param in_additional number of signatures about to be appended
+ */
+static void
+SignatureArray_reserve(SignatureArray *signature_array, long in_additional)
+{
+  long capacity;
+  secp256k1_ecdsa_signature *sigs;
+
+  if (signature_array->size + in_additional <= signature_array->capacity)
+  {
+    return;
+  }
+
+  capacity = signature_array->capacity * 2;
+  if (capacity < signature_array->size + in_additional)
+  {
+    capacity = signature_array->size + in_additional;
+  }
+
+  if (signature_array->backing != NULL)
+  {
+    // Loaded stores are read-only, so they are copied to the heap before
+    // anything is appended
+    sigs = ALLOC_N(secp256k1_ecdsa_signature, capacity);
+    MEMCPY(sigs, signature_array->sigs, secp256k1_ecdsa_signature, signature_array->size);
+    ReleaseBacking(signature_array->backing, signature_array->backing_len);
+    signature_array->backing = NULL;
+    signature_array->backing_len = 0;
+    signature_array->sigs = sigs;
+  }
+  else
+  {
+    REALLOC_N(signature_array->sigs, secp256k1_ecdsa_signature, capacity);
+  }
+  signature_array->capacity = capacity;
+}
+
+/**
+ * Creates an empty signature array.
+ *
+ * @param capacity [Integer] (Optional) number of signatures to allocate room
+ *   for up front. Defaults to 0.
+ * @raise [Secp256k1::Error] if capacity is negative.
+ */
+static VALUE
+SignatureArray_initialize(int argc, const VALUE *argv, VALUE self)
+{
+  SignatureArray *signature_array;
+  VALUE opts;
+  VALUE capacity;
+  static ID kwarg_ids;
+
+  if (!kwarg_ids)
+  {
+    CONST_ID(kwarg_ids, "capacity");
+  }
+
+  capacity = Qundef;
+  rb_scan_args(argc, argv, ":", &opts);
+  rb_get_kwargs(opts, &kwarg_ids, 0, 1, &capacity);
+
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+  if (capacity != Qundef)
+  {
+    if (NUM2LONG(capacity) < 0)
+    {
+      rb_raise(Secp256k1_Error_class, "capacity must not be negative");
+    }
+
+    SignatureArray_reserve(signature_array, NUM2LONG(capacity));
+  }
+
+  return self;
+}
+
+/**
+ * Appends a copy of a signature.
+ *
+ * @param in_signature [Secp256k1::Signature] signature to append.
+ * @return [Secp256k1::SignatureArray] this array.
+ * @raise [FrozenError] if this array is frozen.
+ */
+static VALUE
+SignatureArray_push(VALUE self, VALUE in_signature)
+{
+  SignatureArray *signature_array;
+  Signature *signature;
+
+  rb_check_frozen(self);
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+  TypedData_Get_Struct(in_signature, Signature, &Signature_DataType, signature);
+
+  SignatureArray_reserve(signature_array, 1);
+  signature_array->sigs[signature_array->size++] = signature->sig;
+
+  return self;
+}
+
+/**
+ * Parses compact signatures stored back to back and appends them.
+ *
+ * Nothing is appended unless every signature parses.
+ *
+ * @param in_buffer [String, IO::Buffer] concatenated 64-byte compact
+ *   signatures.
+ * @return [Secp256k1::SignatureArray] this array.
+ * @raise [Secp256k1::Error] if the buffer length is not a multiple of 64.
+ * @raise [Secp256k1::DeserializationError] if a signature is invalid.
+ * @raise [FrozenError] if this array is frozen.
+ */
+static VALUE
+SignatureArray_append_compact(VALUE self, VALUE in_buffer)
+{
+  SignatureArray *signature_array;
+  const unsigned char *data;
+  long data_len;
+  long count;
+  long i;
+
+  rb_check_frozen(self);
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  RequireBorrowBytes(in_buffer, &data, &data_len);
+  if (data_len % 64 != 0)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "compact signature data must be a multiple of 64 bytes"
+    );
+  }
+
+  // Growing may run GC, which can move the data of an embedded string
+  count = data_len / 64;
+  SignatureArray_reserve(signature_array, count);
+  RequireBorrowBytes(in_buffer, &data, &data_len);
+
+  for (i = 0; i < count; i++)
+  {
+    if (secp256k1_ecdsa_signature_parse_compact(
+          secp256k1_context_static,
+          &(signature_array->sigs[signature_array->size + i]),
+          data + i * 64) != 1)
+    {
+      rb_raise(
+        Secp256k1_DeserializationError_class,
+        "invalid compact signature at offset %ld",
+        i * 64
+      );
+    }
+  }
+  signature_array->size += count;
+
+  return self;
+}
+
+/**
+ * Parses DER encoded signatures stored back to back and appends them.
+ *
+ * Nothing is appended unless every signature parses.
+ *
+ * @param in_buffer [String, IO::Buffer] concatenated DER encoded signatures.
+ * @param lax [Boolean] (Optional) accept the malformed DER encodings found in
+ *   historical Bitcoin transactions.
+ * @return [Secp256k1::SignatureArray] this array.
+ * @raise [Secp256k1::DeserializationError] if a signature is invalid.
+ * @raise [FrozenError] if this array is frozen.
+ */
+static VALUE
+SignatureArray_append_der_encoded(int argc, const VALUE *argv, VALUE self)
+{
+  SignatureArray *signature_array;
+  secp256k1_ecdsa_signature parsed;
+  VALUE in_buffer;
+  VALUE opts;
+  const unsigned char *data;
+  long data_len;
+  long offset;
+  long signature_len;
+  long count;
+  int lax;
+
+  rb_scan_args(argc, argv, "1:", &in_buffer, &opts);
+  lax = LaxDerOption(opts);
+
+  rb_check_frozen(self);
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  // Signatures vary in length, so they are counted and checked before
+  // growing the array and parsed into it on a second pass
+  RequireBorrowBytes(in_buffer, &data, &data_len);
+  count = 0;
+  for (offset = 0; offset < data_len; offset += signature_len)
+  {
+    signature_len = ParseDerSignature(
+      data + offset, data_len - offset, lax, &parsed
+    );
+    if (signature_len == 0)
+    {
+      rb_raise(
+        Secp256k1_DeserializationError_class,
+        "invalid DER encoded signature at offset %ld",
+        offset
+      );
+    }
+    count++;
+  }
+
+  SignatureArray_reserve(signature_array, count);
+  RequireBorrowBytes(in_buffer, &data, &data_len);
+  for (offset = 0; offset < data_len; offset += signature_len)
+  {
+    signature_len = ParseDerSignature(
+      data + offset,
+      data_len - offset,
+      lax,
+      &(signature_array->sigs[signature_array->size++])
+    );
+  }
+
+  return self;
+}
+
+/**
+ * Returns the signature at an index.
+ *
+ * @param in_index [Integer] index of the signature, negative indexes count
+ *   from the end.
+ * @return [Secp256k1::Signature, nil] copy of the signature, nil if the index
+ *   is out of range.
+ */
+static VALUE
+SignatureArray_aref(VALUE self, VALUE in_index)
+{
+  SignatureArray *signature_array;
+  Signature *signature;
+  VALUE result;
+  long index;
+
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  index = NUM2LONG(in_index);
+  if (index < 0)
+  {
+    index += signature_array->size;
+  }
+  if (index < 0 || index >= signature_array->size)
+  {
+    return Qnil;
+  }
+
+  result = Signature_alloc(Secp256k1_Signature_class);
+  TypedData_Get_Struct(result, Signature, &Signature_DataType, signature);
+  signature->sig = signature_array->sigs[index];
+
+  return result;
+}
+
+/**
+ * @return [Integer] number of signatures in this array.
+ */
+static VALUE
+SignatureArray_size(VALUE self)
+{
+  SignatureArray *signature_array;
+
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  return LONG2NUM(signature_array->size);
+}
+
+static VALUE
+SignatureArray_enum_size(VALUE self, VALUE args, VALUE eobj)
+{
+  return SignatureArray_size(self);
+}
+
+/**
+ * Yields a copy of each signature in order.
+ *
+ * @yieldparam signature [Secp256k1::Signature] signature in this array.
+ * @return [Secp256k1::SignatureArray, Enumerator] this array, or an
+ *   enumerator if no block was given.
+ */
+static VALUE
+SignatureArray_each(VALUE self)
+{
+  SignatureArray *signature_array;
+  long i;
+
+  RETURN_SIZED_ENUMERATOR(self, 0, 0, SignatureArray_enum_size);
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  // The block may append to the array, so its size is read on every pass
+  for (i = 0; i < signature_array->size; i++)
+  {
+    rb_yield(SignatureArray_aref(self, LONG2NUM(i)));
+  }
+
+  return self;
+}
+
+/**
+ * Loads signatures from a store written by SignatureArray#dump.
+ *
+ * Where supported the store is mapped into memory rather than read, so
+ * loading is cheap and processes sharing a store share its pages. Its
+ * signatures are not parsed again, but each one is validated before the
+ * array is returned.
+ *
+ * @param path [String] path of the store file.
+ * @param verify [Boolean] (Optional) check the signatures against the
+ *   checksum in the store. Defaults to true. The checksum only detects
+ *   accidental corruption, as anyone able to modify the store can recompute
+ *   it.
+ * @return [Secp256k1::SignatureArray] signatures held in the store.
+ * @raise [SystemCallError] if the file cannot be read.
+ * @raise [Secp256k1::DeserializationError] if the file is not a store of
+ *   signatures, was written by an incompatible build of libsecp256k1, holds
+ *   an invalid signature, or its checksum does not match.
+ */
+static VALUE
+SignatureArray_load(int argc, const VALUE *argv, VALUE klass)
+{
+  SignatureArray *signature_array;
+  VALUE in_path;
+  VALUE opts;
+  VALUE result;
+  void *backing;
+  size_t backing_len;
+  long count;
+  int verify;
+
+  rb_scan_args(argc, argv, "1:", &in_path, &opts);
+  verify = StoreVerifyOption(opts);
+  in_path = rb_get_path(in_path);
+
+  result = SignatureArray_alloc(klass);
+  TypedData_Get_Struct(
+    result, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  StoreLoad(in_path, STORE_SIGNATURES, verify, &backing, &backing_len, &count);
+  signature_array->backing = backing;
+  signature_array->backing_len = backing_len;
+  signature_array->sigs = (secp256k1_ecdsa_signature*)((unsigned char*)backing + STORE_HEADER_SIZE);
+  signature_array->size = count;
+  signature_array->capacity = count;
+
+  return result;
+}
+
+/**
+ * Writes the signatures in this array to a store file.
+ *
+ * Stores hold signatures in the form libsecp256k1 parses them into, so
+ * SignatureArray.load can use them without parsing. Any existing file at the
+ * path is replaced.
+ *
+ * @param in_path [String] path of the store file.
+ * @return [Integer] number of bytes written.
+ * @raise [SystemCallError] if the file cannot be written.
+ */
+static VALUE
+SignatureArray_dump(VALUE self, VALUE in_path)
+{
+  SignatureArray *signature_array;
+
+  // Converting the path may run Ruby code, so it happens before the
+  // signatures are borrowed
+  in_path = rb_get_path(in_path);
+  TypedData_Get_Struct(
+    self, SignatureArray, &SignatureArray_DataType, signature_array
+  );
+
+  return StoreDump(
+    in_path, STORE_SIGNATURES, signature_array->sigs, signature_array->size
+  );
+}
+
+//
+// Secp256k1::RecoverableSignature class interface
+//
+
+#ifdef HAVE_SECP256K1_RECOVERY_H
+
+static VALUE
+RecoverableSignature_alloc(VALUE klass)
+{
+  VALUE new_instance;
+  RecoverableSignature *recoverable_signature;
+
+  new_instance = TypedData_Make_Struct(
+    klass,
+    RecoverableSignature,
+    &RecoverableSignature_DataType,
+    recoverable_signature
+  );
+  recoverable_signature->context = Qnil;
+
+  return new_instance;
+}
+
+/**
+ * Returns the compact encoding of recoverable signature.
+ *
+ * @return [Array] first element is the 64 byte compact encoding of signature,
+ *   the second element is the integer recovery ID.
+ * @raise [Secp256k1::SerializationError] if signature serialization fails.
+ */
+static VALUE
+RecoverableSignature_compact(VALUE self)
+{
+  RecoverableSignature *recoverable_signature;
+  unsigned char compact_sig[64];
+  int recovery_id;
+  VALUE result;
+
+  TypedData_Get_Struct(
+    self,
+    RecoverableSignature,
+    &RecoverableSignature_DataType,
+    recoverable_signature
+  );
+
+  if (secp256k1_ecdsa_recoverable_signature_serialize_compact(
+        secp256k1_context_static,
+        compact_sig,
+        &recovery_id,
+        &(recoverable_signature->sig)) != 1)
+  {
+    rb_raise(
+      Secp256k1_SerializationError_class,
+      "unable to serialize recoverable signature"
+    );
+  }
+
+  // Create a new array with room for 2 elements and push data onto it
+  result = rb_ary_new2(2);
+  rb_ary_push(result, rb_str_new((char*)compact_sig, 64));
+  rb_ary_push(result, rb_int_new(recovery_id));
+
+  return result;
+}
+
+/**
+ * Writes the compact encoding of this recoverable signature into a buffer.
+ *
+ * The 64 byte compact signature is written followed by a single byte holding
+ * the recovery ID, the same layout used by records passed to
+ * Context#recover_packed.
+ *
+ * @param buffer [String,IO::Buffer] buffer to write into.
+ * @param offset [Integer,nil] (Optional) byte offset to write at. Omit to
+ *   append to a String buffer.
+ * @return [Integer] offset just past the 65 bytes written.
+ * @raise [Secp256k1::SerializationError] if signature serialization fails.
+ * @raise [Secp256k1::Error] if the offset is invalid or the data does not fit
+ *   in an IO::Buffer.
+ */
+static VALUE
+RecoverableSignature_write_compact(int argc, const VALUE *argv, VALUE self)
+{
+  RecoverableSignature *recoverable_signature;
+  unsigned char compact_sig[65];
+  int recovery_id;
+  VALUE buffer;
+  VALUE offset;
+
+  rb_scan_args(argc, argv, "11", &buffer, &offset);
+  TypedData_Get_Struct(
+    self,
+    RecoverableSignature,
+    &RecoverableSignature_DataType,
+    recoverable_signature
+  );
+
+  if (secp256k1_ecdsa_recoverable_signature_serialize_compact(
+        secp256k1_context_static,
+        compact_sig,
+        &recovery_id,
+        &(recoverable_signature->sig)) != 1)
+  {
+    rb_raise(
+      Secp256k1_SerializationError_class,
+      "unable to serialize recoverable signature"
+    );
+  }
+
+  compact_sig[64] = (unsigned char)recovery_id;
+
+  return WriteToBuffer(buffer, offset, compact_sig, 65);
+}
+
+/**
+ * Convert a recoverable signature to a non-recoverable signature.
+ *
+ * @return [Secp256k1::Signature] non-recoverable signature derived from this
+ *   recoverable signature.
+ */
+static VALUE
+RecoverableSignature_to_signature(VALUE self)
+{
+  RecoverableSignature *recoverable_signature;
+  Signature *signature;
+  VALUE result;
+
+  TypedData_Get_Struct(
+    self,
+    RecoverableSignature,
+    &RecoverableSignature_DataType,
+    recoverable_signature
+  );
+
+  result = Signature_alloc(Secp256k1_Signature_class);
+  TypedData_Get_Struct(
+    result,
+    Signature,
+    &Signature_DataType,
+    signature
+  );
+
+  // NOTE: This method cannot fail
+  secp256k1_ecdsa_recoverable_signature_convert(
+    secp256k1_context_static,
+    &(signature->sig),
+    &(recoverable_signature->sig));
+
+  return result;
+}
+
+/**
+ * Recovers a public key from the signature and hash stored in a set of
+ * arguments.
+ *
+ * \param in_context context to recover with
+ * \param io_args arguments with signature and hash32 already filled in
+ * \return recovered Secp256k1::PublicKey
+ * \raise Secp256k1::DeserializationError if no public key can be recovered
+ */
+static VALUE
+RecoverHash(Context *in_context, RecoverArgs *io_args)
+{
+  PublicKey *public_key;
+  unsigned long long start;
+  VALUE result;
+
+  RequireCapability(in_context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+  io_args->ctx = in_context->ctx;
+
+  start = StatsStart(in_context);
+  WithoutGVL(Recover_without_gvl, io_args);
+  StatsRecord(in_context, STATS_RECOVER, 1, io_args->result != 1, start);
+
+  if (io_args->result == 1)
+  {
+    result = PublicKey_alloc(Secp256k1_PublicKey_class);
+    TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+    public_key->pubkey = io_args->pubkey;
+    return result;
+  }
+
+  rb_raise(Secp256k1_DeserializationError_class, "unable to recover public key");
+}
+
+/**
+ * Attempts to recover the public key associated with this signature.
+ *
+ * @param in_hash32 [String, IO::Buffer] 32-byte SHA-256 hash of data.
+ * @return [Secp256k1::PublicKey] recovered public key.
+ * @raise [Secp256k1::Error] if hash given is not 32 bytes.
+ * @raise [Secp256k1::DeserializationError] if public key could not be
+ *   recovered.
+ */
+static VALUE
+RecoverableSignature_recover_public_key(VALUE self, VALUE in_hash32)
+{
+  RecoverableSignature *recoverable_signature;
+  Context *context;
+  RecoverArgs args;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+
+  hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
+  if (hash32_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+  }
+
+  TypedData_Get_Struct(
+    self,
+    RecoverableSignature,
+    &RecoverableSignature_DataType,
+    recoverable_signature
+  );
+  TypedData_Get_Struct(
+    recoverable_signature->context, Context, &Context_DataType, context
+  );
+
+  args.signature = recoverable_signature->sig;
+  MEMCPY(args.hash32, hash32, unsigned char, 32);
+
+  return RecoverHash(context, &args);
+}
+
+/**
+ * Compares two recoverable signatures.
+ *
+ * Two recoverable signatures their secp256k1_ecdsa_recoverable_signature data
+ * is identical.
+ *
+ * @param other [Secp256k1::RecoverableSignature] recoverable signature to
+ *   compare.
+ * @return [Boolean] true if the recoverable signatures are identical, false
+ *   otherwise.
+ */
+static VALUE
+RecoverableSignature_equals(VALUE self, VALUE other)
+{
+  RecoverableSignature *lhs;
+  RecoverableSignature *rhs;
+
+  TypedData_Get_Struct(
+    self, RecoverableSignature, &RecoverableSignature_DataType, lhs
+  );
+  TypedData_Get_Struct(
+    other, RecoverableSignature, &RecoverableSignature_DataType, rhs
+  );
+
+  // NOTE: It is safe to directly compare these data structures rather than
+  // first serializing and then comparing.
+  if (memcmp(&(lhs->sig),
+             &(rhs->sig),
+             sizeof(secp256k1_ecdsa_recoverable_signature)) == 0)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
+}
+
+/**
+ * Compares two recoverable signatures for use as hash keys.
+ *
+ * @param other [Object] object to compare.
+ * @return [Boolean] true if other is a recoverable signature equal to this
+ *   one, false otherwise.
+ */
+static VALUE
+RecoverableSignature_eql(VALUE self, VALUE other)
+{
+  if (!rb_typeddata_is_kind_of(other, &RecoverableSignature_DataType))
+  {
+    return Qfalse;
+  }
+
+  return RecoverableSignature_equals(self, other);
+}
+
+/**
+ * Computes a hash value for this recoverable signature.
+ *
+ * Recoverable signatures that are equal have the same hash value.
+ *
+ * @return [Integer] hash of the recoverable signature data.
+ */
+static VALUE
+RecoverableSignature_hash(VALUE self)
+{
+  RecoverableSignature *recoverable_signature;
+
+  TypedData_Get_Struct(
+    self,
+    RecoverableSignature,
+    &RecoverableSignature_DataType,
+    recoverable_signature
+  );
+
+  return ST2FIX(
+    rb_memhash(&(recoverable_signature->sig),
+               sizeof(secp256k1_ecdsa_recoverable_signature))
+  );
+}
+
+#endif // HAVE_SECP256K1_RECOVERY_H
+
+//
+// Secp256k1::SharedSecret class interface
+//
+
+#ifdef HAVE_SECP256K1_ECDH_H
+
+static VALUE
+SharedSecret_alloc(VALUE klass)
+{
+  SharedSecret *shared_secret;
+
+  return TypedData_Make_Struct(
+    klass, SharedSecret, &SharedSecret_DataType, shared_secret
+  );
+}
+
+/**
+ * Returns the binary shared secret.
+ *
+ * A new string is created on each call.
+ *
+ * @return [String] 32-byte binary string containing the shared secret.
+ */
+static VALUE
+SharedSecret_data(VALUE self)
+{
+  SharedSecret *shared_secret;
+
+  TypedData_Get_Struct(
+    self, SharedSecret, &SharedSecret_DataType, shared_secret
+  );
+
+  return rb_str_new((char*)shared_secret->data, 32);
+}
+
+#endif // HAVE_SECP256K1_ECDH_H
+
+//
+// Secp256k1::XOnlyPublicKey class interface
+//
+
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+
+static VALUE
+XOnlyPublicKey_alloc(VALUE klass)
+{
+  XOnlyPublicKey *x_only_public_key;
+
+  return TypedData_Make_Struct(
+    klass, XOnlyPublicKey, &XOnlyPublicKey_DataType, x_only_public_key
+  );
+}
+
+/**
+ * Creates an x-only public key object from parsed key data.
+ *
+ * \param in_pubkey x-only public key to be wrapped
+ * \return new Secp256k1::XOnlyPublicKey object
+ */
+static VALUE
+XOnlyPublicKey_create(const secp256k1_xonly_pubkey *in_pubkey)
+{
+  XOnlyPublicKey *x_only_public_key;
+  VALUE result;
+
+  result = XOnlyPublicKey_alloc(Secp256k1_XOnlyPublicKey_class);
+  TypedData_Get_Struct(
+    result, XOnlyPublicKey, &XOnlyPublicKey_DataType, x_only_public_key
+  );
+  x_only_public_key->pubkey = *in_pubkey;
+  secp256k1_xonly_pubkey_serialize(
+    secp256k1_context_static, x_only_public_key->data, in_pubkey
+  );
+
+  return result;
+}
+
+/**
+ * Loads an x-only public key from its 32-byte BIP-340 serialization.
+ *
+ * @param in_public_key_data [String, IO::Buffer] 32-byte x-only public key.
+ * @return [Secp256k1::XOnlyPublicKey] x-only public key parsed from data.
+ * @raise [Secp256k1::DeserializationError] if the data is not a valid x-only
+ *   public key.
+ */
+static VALUE
+XOnlyPublicKey_from_data(VALUE klass, VALUE in_public_key_data)
+{
+  unsigned char scratch[32];
+  const unsigned char *public_key_data;
+  long public_key_data_len;
+  secp256k1_xonly_pubkey pubkey;
+
+  public_key_data = InputBytes(
+    in_public_key_data, scratch, sizeof(scratch), &public_key_data_len
+  );
+  if (public_key_data_len != 32 ||
+      secp256k1_xonly_pubkey_parse(secp256k1_context_static,
+                                   &pubkey,
+                                   public_key_data) != 1)
+  {
+    rb_raise(
+      Secp256k1_DeserializationError_class, "invalid x-only public key data"
+    );
+  }
+
+  return XOnlyPublicKey_create(&pubkey);
+}
+
+/**
+ * @return [String] 32-byte binary string containing the BIP-340
+ *   serialization of this x-only public key.
+ */
+static VALUE
+XOnlyPublicKey_data(VALUE self)
+{
+  XOnlyPublicKey *x_only_public_key;
+
+  TypedData_Get_Struct(
+    self, XOnlyPublicKey, &XOnlyPublicKey_DataType, x_only_public_key
+  );
+
+  return rb_str_new((char*)x_only_public_key->data, 32);
+}
+
+/**
+ * Compares two x-only public keys.
+ *
+ * @param other [Secp256k1::XOnlyPublicKey] x-only public key to compare.
+ * @return [Boolean] true if the keys have the same serialization, false
+ *   otherwise.
+ */
+static VALUE
+XOnlyPublicKey_equals(VALUE self, VALUE other)
+{
+  XOnlyPublicKey *lhs;
+  XOnlyPublicKey *rhs;
+
+  TypedData_Get_Struct(self, XOnlyPublicKey, &XOnlyPublicKey_DataType, lhs);
+  TypedData_Get_Struct(other, XOnlyPublicKey, &XOnlyPublicKey_DataType, rhs);
+
+  if (memcmp(lhs->data, rhs->data, 32) == 0)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
+}
+
+/**
+ * Compares two x-only public keys for use as hash keys.
+ *
+ * @param other [Object] object to compare.
+ * @return [Boolean] true if other is an x-only public key equal to this one,
+ *   false otherwise.
+ */
+static VALUE
+XOnlyPublicKey_eql(VALUE self, VALUE other)
+{
+  if (!rb_typeddata_is_kind_of(other, &XOnlyPublicKey_DataType))
+  {
+    return Qfalse;
+  }
+
+  return XOnlyPublicKey_equals(self, other);
+}
+
+/**
+ * Computes a hash value for this x-only public key.
+ *
+ * @return [Integer] hash of the serialized key.
+ */
+static VALUE
+XOnlyPublicKey_hash(VALUE self)
+{
+  XOnlyPublicKey *x_only_public_key;
+
+  TypedData_Get_Struct(
+    self, XOnlyPublicKey, &XOnlyPublicKey_DataType, x_only_public_key
+  );
+
+  return ST2FIX(rb_memhash(x_only_public_key->data, 32));
+}
+
+/**
+ * Converts this public key to the x-only form used by BIP-340 signatures.
+ *
+ * The x-only form drops the parity of the y coordinate, so a public key and
+ * its negation have the same x-only public key.
+ *
+ * @return [Secp256k1::XOnlyPublicKey] x-only form of this public key.
+ */
+static VALUE
+PublicKey_to_x_only(VALUE self)
+{
+  PublicKey *public_key;
+  secp256k1_xonly_pubkey pubkey;
+
+  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+
+  secp256k1_xonly_pubkey_from_pubkey(
+    secp256k1_context_static, &pubkey, NULL, &(public_key->pubkey)
+  );
+
+  return XOnlyPublicKey_create(&pubkey);
+}
+
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
+//
+// Secp256k1::Context class interface
+//
+
+/* Allocate a new context object */
+static VALUE
+Context_alloc(VALUE klass)
+{
+  VALUE new_instance;
+  Context *context;
+
+  context = ALLOC(Context);
+  MEMZERO(context, Context, 1);
+
+  new_instance = TypedData_Wrap_Struct(klass, &Context_DataType, context);
+
+  return new_instance;
+}
+
+/**
+ * Initialize a new context.
+ *
+ * Context initialization should be infrequent as it is an expensive operation.
+ *
+ * @param context_randomization_bytes [String,nil] (Optional) 32 bytes of
+ *   random data used to randomize the context. If omitted then the
+ *   context remains unrandomized. It is recommended that you provide this
+ *   argument.
+ * @param workers [Integer] (Optional) number of native threads batch
+ *   operations are split across, including the calling thread. Defaults to 1,
+ *   which runs batches entirely on the calling thread.
+ * @param capabilities [Array<Symbol>] (Optional) operations the context
+ *   builds precomputed tables for, any of :sign and :verify. Defaults to
+ *   both. Contexts without :sign skip randomization since it only protects
+ *   signing.
+ * @param stats [Boolean] (Optional) if true the context counts the calls,
+ *   failures, and time spent in libsecp256k1 for each operation, see
+ *   {#stats}. Defaults to false.
+ * @return [Secp256k1::Context] 
+ * @raise [Secp256k1::Error] if context randomization fails, workers is not
+ *   a positive integer, or a capability is unknown.
+ */
+static VALUE
+Context_initialize(int argc, const VALUE* argv, VALUE self)
+{
+  Context *context;
+  VALUE context_randomization_bytes;
+  VALUE workers;
+  VALUE capabilities;
+  VALUE capability;
+  VALUE stats;
+  VALUE kwarg_values[4];
+  VALUE opts;
+  long worker_count;
+  long i;
+  static ID kwarg_ids[4];
+  static ID sign_id;
+  static ID verify_id;
+
+  if (!kwarg_ids[0])
+  {
+    CONST_ID(kwarg_ids[0], "context_randomization_bytes");
+    CONST_ID(kwarg_ids[1], "workers");
+    CONST_ID(kwarg_ids[2], "capabilities");
+    CONST_ID(kwarg_ids[3], "stats");
+    CONST_ID(sign_id, "sign");
+    CONST_ID(verify_id, "verify");
+  }
+
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+
+  // Handle optional second argument containing random bytes to use for
+  // randomization. We pass ":" to rb_scan_args to say that we expect keyword
+  // arguments. We then parse the opts result of the scan in order to grab
+  // context_randomization_bytes from the hash.
+  rb_scan_args(argc, argv, ":", &opts);
+  rb_get_kwargs(opts, kwarg_ids, 0, 4, kwarg_values);
+  context_randomization_bytes = kwarg_values[0];
+  workers = kwarg_values[1];
+  capabilities = kwarg_values[2];
+  stats = kwarg_values[3];
+
+  if (capabilities == Qundef || NIL_P(capabilities))
+  {
+    context->capabilities = (
+      SECP256K1_FLAGS_BIT_CONTEXT_SIGN | SECP256K1_FLAGS_BIT_CONTEXT_VERIFY
+    );
+  }
+  else
+  {
+    Check_Type(capabilities, T_ARRAY);
+    context->capabilities = 0;
+    for (i = 0; i < RARRAY_LEN(capabilities); i++)
+    {
+      capability = rb_ary_entry(capabilities, i);
+      if (SYMBOL_P(capability) && SYM2ID(capability) == sign_id)
+      {
+        context->capabilities |= SECP256K1_FLAGS_BIT_CONTEXT_SIGN;
+      }
+      else if (SYMBOL_P(capability) && SYM2ID(capability) == verify_id)
+      {
+        context->capabilities |= SECP256K1_FLAGS_BIT_CONTEXT_VERIFY;
+      }
+      else
+      {
+        rb_raise(
+          Secp256k1_Error_class,
+          "unknown capability, must be :sign or :verify"
+        );
+      }
+    }
+  }
+
+  context->ctx = secp256k1_context_create(
+    SECP256K1_FLAGS_TYPE_CONTEXT | context->capabilities
+  );
+
+  // We need this check because rb_get_kwargs will set the result to Qundef if
+  // the keyword argument is not provided. This lets us use the NIL_P
+  // predicate.
+  if (context_randomization_bytes == Qundef)
+  {
+    context_randomization_bytes = Qnil;
+  }
+
+  if (workers == Qundef || NIL_P(workers))
+  {
+    workers = INT2FIX(1);
+  }
+
+  Check_Type(workers, T_FIXNUM);
+  worker_count = FIX2LONG(workers);
+  if (worker_count < 1 || worker_count > MAX_WORKERS)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "workers must be in range [1, %d]",
+      MAX_WORKERS
+    );
+  }
+
+  if (stats != Qundef && RTEST(stats) && context->stats == NULL)
+  {
+    context->stats = ZALLOC_N(OpStats, STATS_OP_COUNT);
+  }
+
+#ifdef HAVE_PTHREAD_H
+  if (worker_count > 1)
+  {
+    context->pool = ALLOC(WorkerPool);
+    MEMZERO(context->pool, WorkerPool, 1);
+    context->pool->worker_count = worker_count;
+  }
+#endif // HAVE_PTHREAD_H
+
+  // Randomization blinds the signing tables, so there is nothing to randomize
+  // for contexts that cannot sign.
+  if (!NIL_P(context_randomization_bytes) &&
+      (context->capabilities & SECP256K1_FLAGS_BIT_CONTEXT_SIGN))
+  {
+    // Randomize the context at initialization time rather than before calls so
+    // the same context can be used across threads safely.
+    RandomizeContext(context, context_randomization_bytes);
+  }
+
+  return self;
+}
+
+/**
+ * Re-randomizes the context without rebuilding its precomputed tables.
+ *
+ * Intended to be called in a child process right after fork so that workers
+ * sharing a context built before fork do not share blinding values. Only the
+ * small blinding state is rewritten, so the table pages stay shared with the
+ * parent. Must not be called while other threads are using the context.
+ *
+ * @param context_randomization_bytes [String] 32 bytes of random data.
+ * @return [Secp256k1::Context] this context.
+ * @raise [Secp256k1::Error] if the context cannot sign, the random data is not
+ *   32 bytes, or randomization fails.
+ * @raise [FrozenError] if this context is frozen.
+ */
+static VALUE
+Context_randomize(VALUE self, VALUE context_randomization_bytes)
+{
+  Context *context;
+
+  rb_check_frozen(self);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
+
+  RandomizeContext(context, context_randomization_bytes);
+
+  return self;
+}
+
+/**
+ * Converts binary private key data into a new key pair.
+ *
+ * @param in_private_key_data [String] binary private key data
+ * @return [Secp256k1::KeyPair] key pair initialized from the private key data.
+ * @raise [Secp256k1::Error] if the private key data is invalid or key derivation
+ *   fails.
+ */
+static VALUE
+Context_key_pair_from_private_key(VALUE self, VALUE in_private_key_data)
+{
+  Context *context;
+  secp256k1_pubkey pubkey;
+  unsigned char private_key_data[32];
+
+  Check_Type(in_private_key_data, T_STRING);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+
+  if (RSTRING_LEN(in_private_key_data) != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "private key data must be 32 bytes in length");
+  }
+
+  MEMCPY(private_key_data, RSTRING_PTR(in_private_key_data), unsigned char, 32);
+  if (secp256k1_ec_seckey_verify(secp256k1_context_static,
+                                 private_key_data) != 1)
+  {
+    rb_raise(Secp256k1_Error_class, "invalid private key data");
+  }
+
+  DerivePublicKey(context, private_key_data, &pubkey);
+
+  return KeyPair_create(&pubkey, private_key_data);
+}
+
+/**
+ * Converts concatenated binary private key data into new key pairs.
+ *
+ * Public keys are derived in a single batch which is split across the
+ * context's workers when large enough.
+ *
+ * @param in_private_key_data [String] binary string of concatenated 32-byte
+ *   private keys.
+ * @return [Array<Secp256k1::KeyPair>] key pairs in the same order as the
+ *   private keys.
+ * @raise [Secp256k1::Error] if the data is not a multiple of 32 bytes or a
+ *   private key is invalid.
+ */
+static VALUE
+Context_key_pairs_from_private_key_data(VALUE self, VALUE in_private_key_data)
+{
+  Context *context;
+  PublicKeyBatchArgs args;
+  VALUE items_buffer;
+  VALUE result;
+  unsigned long long start;
+  long failures;
+  long count;
+  long i;
+
+  Check_Type(in_private_key_data, T_STRING);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
+
+  if (RSTRING_LEN(in_private_key_data) % 32 != 0)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "private key data must be a multiple of 32 bytes in length"
+    );
+  }
+
+  count = RSTRING_LEN(in_private_key_data) / 32;
+  args.items = ALLOCV_N(PublicKeyBatchItem, items_buffer, count);
+  for (i = 0; i < count; i++)
+  {
+    MEMCPY(args.items[i].private_key,
+           RSTRING_PTR(in_private_key_data) + i * 32,
+           unsigned char,
+           32);
+  }
+
+  args.ctx = context->ctx;
+  start = StatsStart(context);
+  RunBatch(context, PublicKeyBatch_range, &args, count);
+  if (context->stats != NULL)
+  {
+    failures = 0;
+    for (i = 0; i < count; i++)
+    {
+      failures += args.items[i].result != 1;
+    }
+    StatsRecord(context, STATS_PUBLIC_KEY_CREATE, count, failures, start);
+  }
+
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
+  {
+    if (args.items[i].result != 1)
+    {
+      rb_raise(Secp256k1_Error_class, "invalid private key data");
+    }
+
+    rb_ary_push(
+      result,
+      KeyPair_create(&(args.items[i].pubkey), args.items[i].private_key)
+    );
+  }
+
+  ALLOCV_END(items_buffer);
+
+  return result;
+}
+
+/**
+ * Signs the hash stored in a set of signing arguments.
+ *
+ * \param self context to sign with
+ * \param in_private_key Secp256k1::PrivateKey to sign with
+ * \param io_args arguments with hash32 and nonce already filled in
+ * \return new Secp256k1::Signature
+ * \raise Secp256k1::Error if the signature could not be computed
+ */
+static VALUE
+ContextSignHash(VALUE self, VALUE in_private_key, SignDataArgs *io_args)
+{
+  PrivateKey *private_key;
+  Context *context;
+  Signature *signature;
+  unsigned long long start;
+  VALUE signature_result;
 
-//
-// Secp256k1::KeyPair class interface
-//
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
+  TypedData_Get_Struct(in_private_key, PrivateKey, &PrivateKey_DataType, private_key);
+
+  io_args->ctx = context->ctx;
+  MEMCPY(io_args->private_key, private_key->data, unsigned char, 32);
+
+  // Attempt to sign the hash of the given data
+  start = StatsStart(context);
+  WithoutGVL(SignData_without_gvl, io_args);
+  StatsRecord(context, STATS_SIGN, 1, FAILURE(io_args->result), start);
+
+  if (SUCCESS(io_args->result))
+  {
+    signature_result = Signature_alloc(Secp256k1_Signature_class);
+    TypedData_Get_Struct(signature_result, Signature, &Signature_DataType, signature);
+    signature->sig = io_args->signature;
+    return signature_result;
+  }
+
+  rb_raise(Secp256k1_Error_class, "unable to compute signature");
+}
 
+/**
+ * Computes the ECDSA signature of the data using the secp256k1 elliptic curve.
+ *
+ * @param in_private_key [Secp256k1::PrivateKey] private key to use for
+ *   signing.
+ * @param in_hash32 [String, IO::Buffer] 32-byte SHA-256 hash of data.
+ * @param extra_entropy [String] (Optional) 32 bytes mixed into the RFC6979
+ *   nonce derivation, as in libsecp256k1's ndata argument.
+ * @return [Secp256k1::Signature] signature resulting from signing data.
+ * @raise [Secp256k1::Error] if hash or extra_entropy is not 32 bytes in length
+ *   or signature computation fails.
+ */
 static VALUE
-KeyPair_alloc(VALUE klass)
+Context_sign(int argc, const VALUE *argv, VALUE self)
 {
-  KeyPair *key_pair;
+  SignDataArgs args;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+  VALUE in_private_key;
+  VALUE in_hash32;
+  VALUE opts;
+
+  rb_scan_args(argc, argv, "2:", &in_private_key, &in_hash32, &opts);
+  NonceOptions_init(&(args.nonce), opts);
 
-  key_pair = ALLOC(KeyPair);
+  hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
 
-  return TypedData_Wrap_Struct(klass, &KeyPair_DataType, key_pair);
+  if (hash32_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+  }
+
+  MEMCPY(args.hash32, hash32, unsigned char, 32);
+
+  return ContextSignHash(self, in_private_key, &args);
 }
 
 /**
- * Default constructor.
+ * Verifies a signature against the hash stored in a set of arguments.
  *
- * @param in_public_key [Secp256k1::PublicKey] public key
- * @param in_private_key [Secp256k1::PrivateKey] private key
- * @return [Secp256k1::KeyPair] newly initialized key pair.
+ * \param self context to verify with
+ * \param in_signature Secp256k1::Signature to be verified
+ * \param in_pubkey Secp256k1::PublicKey to verify against
+ * \param io_args arguments with hash32 already filled in
+ * \return Qtrue if the signature is valid, Qfalse otherwise
  */
 static VALUE
-KeyPair_initialize(VALUE self, VALUE in_public_key, VALUE in_private_key)
+ContextVerifyHash(VALUE self,
+                  VALUE in_signature,
+                  VALUE in_pubkey,
+                  VerifyArgs *io_args)
 {
-  KeyPair *key_pair;
+  Context *context;
+  PublicKey *public_key;
+  Signature *signature;
+  unsigned long long start;
 
-  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, key_pair);
-  Check_TypedStruct(in_public_key, &PublicKey_DataType);
-  Check_TypedStruct(in_private_key, &PrivateKey_DataType);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+  TypedData_Get_Struct(in_pubkey, PublicKey, &PublicKey_DataType, public_key);
+  TypedData_Get_Struct(in_signature, Signature, &Signature_DataType, signature);
 
-  key_pair->public_key = in_public_key;
-  key_pair->private_key = in_private_key;
+  io_args->ctx = context->ctx;
+  io_args->signature = signature->sig;
+  io_args->pubkey = public_key->pubkey;
 
-  rb_iv_set(self, "@public_key", in_public_key);
-  rb_iv_set(self, "@private_key", in_private_key);
+  start = StatsStart(context);
+  WithoutGVL(Verify_without_gvl, io_args);
+  StatsRecord(context, STATS_VERIFY, 1, io_args->result != 1, start);
 
-  return self;
+  if (io_args->result == 1)
+  {
+    return Qtrue;
+  }
+
+  return Qfalse;
 }
 
 /**
- * Compare two key pairs.
+ * Verifies that signature matches public key and data.
+ *
+ * @param in_signature [Secp256k1::Signature] signature to be verified.
+ * @param in_pubkey [Secp256k1::PublicKey] public key to verify signature
+ *   against.
+ * @param in_hash32 [String, IO::Buffer] 32-byte SHA-256 hash of data.
+ * @return [Boolean] True if the signature is valid, false otherwise.
+ * @raise [Secp256k1::Error] if hash is not 32-bytes in length.
+ */
+static VALUE
+Context_verify(VALUE self, VALUE in_signature, VALUE in_pubkey, VALUE in_hash32)
+{
+  VerifyArgs args;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+
+  hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
+
+  if (hash32_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32-bytes in length");
+  }
+
+  MEMCPY(args.hash32, hash32, unsigned char, 32);
+
+  return ContextVerifyHash(self, in_signature, in_pubkey, &args);
+}
+
+/**
+ * Hashes a message natively and signs the resulting digest.
  *
- * Two key pairs are equal if they have the same public and private key. The
- * keys are compared using their own comparison operators.
+ * Equivalent to {#sign} with the digest of `in_message`, without creating an
+ * intermediate Ruby string for the hash.
  *
- * @param other [Secp256k1::KeyPair] key pair to compare to.
- * @return [Boolean] true if the keys match, false otherwise.
+ * @param in_private_key [Secp256k1::PrivateKey] private key to sign with.
+ * @param in_message [String, IO::Buffer] message to be hashed and signed.
+ * @param digest [Symbol] (Optional) digest to apply to the message, one of
+ *   :sha256 (default), :double_sha256, or :keccak256.
+ * @param extra_entropy [String] (Optional) see {#sign}.
+ * @return [Secp256k1::Signature] signature of the message digest.
+ * @raise [ArgumentError] if the digest is not supported.
+ * @raise [Secp256k1::Error] if the signature could not be computed.
  */
 static VALUE
-KeyPair_equals(VALUE self, VALUE other)
+Context_sign_message(int argc, const VALUE *argv, VALUE self)
 {
-  KeyPair *lhs;
-  KeyPair *rhs;
-  VALUE public_keys_equal;
-  VALUE private_keys_equal;
+  SignDataArgs args;
+  DigestT digest;
+  VALUE in_private_key;
+  VALUE in_message;
+  VALUE opts;
 
-  TypedData_Get_Struct(self, KeyPair, &KeyPair_DataType, lhs);
-  TypedData_Get_Struct(other, KeyPair, &KeyPair_DataType, rhs);
+  rb_scan_args(argc, argv, "2:", &in_private_key, &in_message, &opts);
+  digest = DigestOption(opts, 1);
+  NonceOptions_init(&(args.nonce), opts);
+  HashMessage(in_message, digest, args.hash32);
+
+  return ContextSignHash(self, in_private_key, &args);
+}
+
+/**
+ * Hashes a message natively and verifies a signature of the digest.
+ *
+ * Equivalent to {#verify} with the digest of `in_message`.
+ *
+ * @param in_signature [Secp256k1::Signature] signature to be verified.
+ * @param in_pubkey [Secp256k1::PublicKey] public key to verify against.
+ * @param in_message [String, IO::Buffer] message that was signed.
+ * @param digest [Symbol] (Optional) digest to apply to the message, one of
+ *   :sha256 (default), :double_sha256, or :keccak256.
+ * @return [Boolean] true if the signature is valid, false otherwise.
+ * @raise [ArgumentError] if the digest is not supported.
+ */
+static VALUE
+Context_verify_message(int argc, const VALUE *argv, VALUE self)
+{
+  VerifyArgs args;
+  DigestT digest;
+  VALUE in_signature;
+  VALUE in_pubkey;
+  VALUE in_message;
+  VALUE opts;
 
-  public_keys_equal = rb_funcall(
-    lhs->public_key, rb_intern("=="), 1, rhs->public_key
+  rb_scan_args(
+    argc, argv, "3:", &in_signature, &in_pubkey, &in_message, &opts
   );
-  private_keys_equal = rb_funcall(
-    lhs->private_key, rb_intern("=="), 1, rhs->private_key
+  digest = DigestOption(opts, 0);
+  HashMessage(in_message, digest, args.hash32);
+
+  return ContextVerifyHash(self, in_signature, in_pubkey, &args);
+}
+
+/**
+ * Returns the number of public keys in an array of public keys.
+ *
+ * \param in_public_keys Array of PublicKey objects or a PublicKeyArray
+ * \return number of public keys
+ * \raise [TypeError] if in_public_keys is neither
+ */
+static long
+PublicKeysLength(VALUE in_public_keys)
+{
+  PublicKeyArray *public_key_array;
+
+  if (rb_typeddata_is_kind_of(in_public_keys, &PublicKeyArray_DataType))
+  {
+    TypedData_Get_Struct(
+      in_public_keys, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+    );
+    return public_key_array->size;
+  }
+
+  Check_Type(in_public_keys, T_ARRAY);
+  return RARRAY_LEN(in_public_keys);
+}
+
+/**
+ * Returns an entry of an array of public keys.
+ *
+ * \param in_public_keys Array of PublicKey objects or a PublicKeyArray
+ * \param in_index index less than PublicKeysLength(in_public_keys)
+ * \return public key, valid until Ruby code next runs
+ * \raise [TypeError] if the entry is not a PublicKey
+ */
+static const secp256k1_pubkey*
+PublicKeysEntry(VALUE in_public_keys, long in_index)
+{
+  PublicKeyArray *public_key_array;
+  PublicKey *public_key;
+
+  if (rb_typeddata_is_kind_of(in_public_keys, &PublicKeyArray_DataType))
+  {
+    TypedData_Get_Struct(
+      in_public_keys, PublicKeyArray, &PublicKeyArray_DataType, public_key_array
+    );
+    return &(public_key_array->pubkeys[in_index]);
+  }
+
+  TypedData_Get_Struct(
+    rb_ary_entry(in_public_keys, in_index),
+    PublicKey,
+    &PublicKey_DataType,
+    public_key
   );
+  return &(public_key->pubkey);
+}
+
+/**
+ * Returns the number of signatures in an array of signatures.
+ *
+ * \param in_signatures Array of Signature objects or a SignatureArray
+ * \return number of signatures
+ * \raise [TypeError] if in_signatures is neither
+ */
+static long
+SignaturesLength(VALUE in_signatures)
+{
+  SignatureArray *signature_array;
 
-  if (public_keys_equal == Qtrue && private_keys_equal == Qtrue)
+  if (rb_typeddata_is_kind_of(in_signatures, &SignatureArray_DataType))
   {
-    return Qtrue;
+    TypedData_Get_Struct(
+      in_signatures, SignatureArray, &SignatureArray_DataType, signature_array
+    );
+    return signature_array->size;
   }
 
-  return Qfalse;
+  Check_Type(in_signatures, T_ARRAY);
+  return RARRAY_LEN(in_signatures);
 }
 
-//
-// Secp256k1::PublicKey class interface
-//
+/**
+ * Returns an entry of an array of signatures.
+ *
+ * \param in_signatures Array of Signature objects or a SignatureArray
+ * \param in_index index less than SignaturesLength(in_signatures)
+ * \return signature, valid until Ruby code next runs
+ * \raise [TypeError] if the entry is not a Signature
+ */
+static const secp256k1_ecdsa_signature*
+SignaturesEntry(VALUE in_signatures, long in_index)
+{
+  SignatureArray *signature_array;
+  Signature *signature;
+
+  if (rb_typeddata_is_kind_of(in_signatures, &SignatureArray_DataType))
+  {
+    TypedData_Get_Struct(
+      in_signatures, SignatureArray, &SignatureArray_DataType, signature_array
+    );
+    return &(signature_array->sigs[in_index]);
+  }
+
+  TypedData_Get_Struct(
+    rb_ary_entry(in_signatures, in_index),
+    Signature,
+    &Signature_DataType,
+    signature
+  );
+  return &(signature->sig);
+}
 
+/**
+ * Verifies many signatures in a single call.
+ *
+ * Entries at the same index in each array are verified together, exactly as
+ * if they had been passed to {#verify}. The GVL is released once for the whole
+ * batch rather than once per signature, and large batches are split across
+ * the context's workers.
+ *
+ * @param in_signatures [Array<Secp256k1::Signature>, Secp256k1::SignatureArray]
+ *   signatures to verify.
+ * @param in_pubkeys [Array<Secp256k1::PublicKey>, Secp256k1::PublicKeyArray]
+ *   public keys to verify signatures against.
+ * @param in_hashes [Array<String>] 32-byte binary strings containing SHA-256
+ *   hashes of signed data.
+ * @param fail_fast [Boolean] (Optional) stop verifying at the first invalid
+ *   signature. Defaults to false.
+ * @return [Array<Boolean,nil>] true for each valid signature and false for
+ *   each invalid one. When fail_fast is set, entries that were not verified
+ *   before the first invalid signature was found are nil.
+ * @raise [Secp256k1::Error] if the arrays differ in length or any hash is not
+ *   32 bytes in length.
+ */
 static VALUE
-PublicKey_alloc(VALUE klass)
+Context_verify_batch(int argc, const VALUE *argv, VALUE self)
 {
+  Context *context;
+  VerifyBatchArgs args;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+  VALUE in_signatures;
+  VALUE in_pubkeys;
+  VALUE in_hashes;
+  VALUE in_hash32;
+  VALUE opts;
+  VALUE fail_fast;
+  VALUE items_buffer;
   VALUE result;
-  PublicKey *public_key;
+  unsigned long long start;
+  long calls;
+  long failures;
+  long count;
+  long pubkeys_count;
+  long i;
+  static ID kwarg_ids;
+
+  fail_fast = Qfalse;
+  if (!kwarg_ids)
+  {
+    CONST_ID(kwarg_ids, "fail_fast");
+  }
+
+  rb_scan_args(argc, argv, "3:", &in_signatures, &in_pubkeys, &in_hashes, &opts);
+  rb_get_kwargs(opts, &kwarg_ids, 0, 1, &fail_fast);
+
+  count = SignaturesLength(in_signatures);
+  pubkeys_count = PublicKeysLength(in_pubkeys);
+  Check_Type(in_hashes, T_ARRAY);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+
+  if (pubkeys_count != count || RARRAY_LEN(in_hashes) != count)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "signatures, public keys, and hashes must have the same length"
+    );
+  }
+
+  // Copy every entry into a temporary buffer before releasing the GVL. The
+  // buffer is owned by the GC so nothing leaks if a type check raises.
+  args.items = ALLOCV_N(VerifyBatchItem, items_buffer, count);
+  for (i = 0; i < count; i++)
+  {
+    in_hash32 = rb_ary_entry(in_hashes, i);
+    hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
+    if (hash32_len != 32)
+    {
+      rb_raise(Secp256k1_Error_class, "in_hash32 is not 32-bytes in length");
+    }
+
+    args.items[i].signature = *SignaturesEntry(in_signatures, i);
+    args.items[i].pubkey = *PublicKeysEntry(in_pubkeys, i);
+    MEMCPY(args.items[i].hash32, hash32, unsigned char, 32);
+    args.items[i].result = -1;
+  }
+
+  args.ctx = context->ctx;
+  args.fail_fast = RTEST(fail_fast) && fail_fast != Qundef;
+  args.failed = 0;
+
+  start = StatsStart(context);
+  RunBatch(context, VerifyBatch_range, &args, count);
+  if (context->stats != NULL)
+  {
+    calls = 0;
+    failures = 0;
+    for (i = 0; i < count; i++)
+    {
+      calls += args.items[i].result != -1;
+      failures += args.items[i].result == 0;
+    }
+    StatsRecord(context, STATS_VERIFY, calls, failures, start);
+  }
+
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
+  {
+    if (args.items[i].result == -1)
+    {
+      rb_ary_push(result, Qnil);
+    }
+    else
+    {
+      rb_ary_push(result, args.items[i].result == 1 ? Qtrue : Qfalse);
+    }
+  }
 
-  public_key = ALLOC(PublicKey);
-  MEMZERO(public_key, PublicKey, 1);
-  result = TypedData_Wrap_Struct(klass, &PublicKey_DataType, public_key);
+  ALLOCV_END(items_buffer);
 
   return result;
 }
 
+/**
+ * Verifies signatures stored as fixed-size records in one binary string.
+ *
+ * Each record is 129 bytes: a 64-byte compact signature, a 33-byte compressed
+ * public key, and the 32-byte hash that was signed. Records are parsed and
+ * verified in C without creating any intermediate Ruby objects, and large
+ * buffers are split across the context's workers.
+ *
+ * @param in_records [String, IO::Buffer] buffer of concatenated records.
+ * @param normalize [Boolean] (Optional) convert each signature to its lower-S
+ *   form before verifying it, so that high-S signatures are accepted.
+ * @return [String] binary string with one byte per record, "\x01" if the
+ *   record's signature is valid and "\x00" if it is invalid or could not be
+ *   parsed.
+ * @raise [Secp256k1::Error] if the buffer length is not a multiple of the
+ *   record size.
+ */
 static VALUE
-PublicKey_create_from_private_key(Context *in_context,
-                                  unsigned char *private_key_data)
+Context_verify_packed(int argc, const VALUE *argv, VALUE self)
 {
-  PublicKey *public_key;
+  Context *context;
+  VerifyPackedArgs args;
+  VALUE in_records;
+  VALUE opts;
   VALUE result;
+  const unsigned char *records;
+  long records_len;
+  unsigned long long start;
+  long count;
 
-  result = PublicKey_alloc(Secp256k1_PublicKey_class);
-  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+  rb_scan_args(argc, argv, "1:", &in_records, &opts);
+  args.normalize = NormalizeOption(opts);
 
-  if (secp256k1_ec_pubkey_create(
-        in_context->ctx,
-        (&public_key->pubkey),
-        private_key_data) != 1)
+  if (!BorrowBytes(in_records, &records, &records_len))
   {
-    rb_raise(Secp256k1_DeserializationError_class, "invalid private key data");
+    rb_raise(
+      rb_eTypeError,
+      "wrong argument type %s (expected String or IO::Buffer)",
+      rb_obj_classname(in_records)
+    );
+  }
+
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+
+  if (records_len % VERIFY_PACKED_RECORD_SIZE != 0)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "packed records must be a multiple of %d bytes",
+      VERIFY_PACKED_RECORD_SIZE
+    );
+  }
+
+  count = records_len / VERIFY_PACKED_RECORD_SIZE;
+  result = rb_str_new(NULL, count);
+
+  args.ctx = context->ctx;
+  args.records = records;
+  args.results = (unsigned char*)RSTRING_PTR(result);
+
+  start = StatsStart(context);
+  RunBatchOverBuffer(context, in_records, VerifyPacked_range, &args, count);
+  if (context->stats != NULL)
+  {
+    StatsRecord(
+      context,
+      STATS_VERIFY,
+      count,
+      CountPackedFailures(args.results, count, 1),
+      start
+    );
   }
 
   return result;
 }
 
+/**
+ * Signs many hashes in a single call.
+ *
+ * Each hash is signed with the private key at the same index, exactly as if
+ * they had been passed to {#sign}. Large batches are split across the
+ * context's workers.
+ *
+ * @param in_private_keys [Array<Secp256k1::PrivateKey>] private keys to sign
+ *   with.
+ * @param in_hashes [Array<String>] 32-byte binary strings with SHA-256 hashes
+ *   of data.
+ * @return [Array<Secp256k1::Signature>] signatures in the same order as the
+ *   hashes.
+ * @raise [Secp256k1::Error] if the arrays differ in length, any hash is not 32
+ *   bytes in length, or a signature could not be computed.
+ */
 static VALUE
-PublicKey_create_from_data(unsigned char *in_public_key_data,
-                           unsigned int in_public_key_data_len)
+Context_sign_batch(VALUE self, VALUE in_private_keys, VALUE in_hashes)
 {
-  PublicKey *public_key;
+  Context *context;
+  PrivateKey *private_key;
+  Signature *signature;
+  SignBatchArgs args;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+  VALUE in_hash32;
+  VALUE items_buffer;
+  VALUE signature_result;
   VALUE result;
+  unsigned long long start;
+  long failures;
+  long count;
+  long i;
 
-  result = PublicKey_alloc(Secp256k1_PublicKey_class);
-  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+  Check_Type(in_private_keys, T_ARRAY);
+  Check_Type(in_hashes, T_ARRAY);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
 
-  if (secp256k1_ec_pubkey_parse(secp256k1_context_no_precomp,
-                                &(public_key->pubkey),
-                                in_public_key_data,
-                                in_public_key_data_len) != 1)
+  count = RARRAY_LEN(in_private_keys);
+  if (RARRAY_LEN(in_hashes) != count)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "private keys and hashes must have the same length"
+    );
+  }
+
+  args.items = ALLOCV_N(SignBatchItem, items_buffer, count);
+  for (i = 0; i < count; i++)
+  {
+    in_hash32 = rb_ary_entry(in_hashes, i);
+    hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
+    if (hash32_len != 32)
+    {
+      rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+    }
+
+    TypedData_Get_Struct(
+      rb_ary_entry(in_private_keys, i),
+      PrivateKey,
+      &PrivateKey_DataType,
+      private_key
+    );
+
+    MEMCPY(args.items[i].private_key, private_key->data, unsigned char, 32);
+    MEMCPY(args.items[i].hash32, hash32, unsigned char, 32);
+  }
+
+  args.ctx = context->ctx;
+  start = StatsStart(context);
+  RunBatch(context, SignBatch_range, &args, count);
+  if (context->stats != NULL)
+  {
+    failures = 0;
+    for (i = 0; i < count; i++)
+    {
+      failures += FAILURE(args.items[i].result);
+    }
+    StatsRecord(context, STATS_SIGN, count, failures, start);
+  }
+
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
   {
-    rb_raise(Secp256k1_DeserializationError_class, "invalid public key data");
+    if (FAILURE(args.items[i].result))
+    {
+      rb_raise(Secp256k1_Error_class, "unable to compute signature");
+    }
+
+    signature_result = Signature_alloc(Secp256k1_Signature_class);
+    TypedData_Get_Struct(
+      signature_result, Signature, &Signature_DataType, signature
+    );
+    signature->sig = args.items[i].signature;
+    rb_ary_push(result, signature_result);
   }
 
+  ALLOCV_END(items_buffer);
+
   return result;
 }
 
 /**
- * Loads a public key from compressed or uncompressed binary data.
+ * Derives the public keys of many private keys in a single call.
  *
- * @param in_public_key_data [String] binary string with compressed or
- *   uncompressed public key data.
- * @return [Secp256k1::PublicKey] public key derived from data.
- * @raise [Secp256k1::DeserializationError] if public key data is invalid.
+ * Large batches are split across the context's workers.
+ *
+ * @param in_private_keys [Array<Secp256k1::PrivateKey>] private keys to derive
+ *   public keys from.
+ * @return [Array<Secp256k1::PublicKey>] public keys in the same order as the
+ *   private keys.
+ * @raise [Secp256k1::DeserializationError] if a public key could not be
+ *   derived.
  */
 static VALUE
-PublicKey_from_data(VALUE klass, VALUE in_public_key_data)
+Context_public_keys_from_private_keys(VALUE self, VALUE in_private_keys)
 {
-  unsigned char *public_key_data;
+  Context *context;
+  PrivateKey *private_key;
+  PublicKey *public_key;
+  PublicKeyBatchArgs args;
+  VALUE items_buffer;
+  VALUE public_key_result;
+  VALUE result;
+  unsigned long long start;
+  long failures;
+  long count;
+  long i;
 
-  Check_Type(in_public_key_data, T_STRING);
+  Check_Type(in_private_keys, T_ARRAY);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
 
-  public_key_data = (unsigned char*)StringValuePtr(in_public_key_data);
-  return PublicKey_create_from_data(
-    public_key_data,
-    (int)RSTRING_LEN(in_public_key_data)
-  );
-}
+  count = RARRAY_LEN(in_private_keys);
+  args.items = ALLOCV_N(PublicKeyBatchItem, items_buffer, count);
+  for (i = 0; i < count; i++)
+  {
+    TypedData_Get_Struct(
+      rb_ary_entry(in_private_keys, i),
+      PrivateKey,
+      &PrivateKey_DataType,
+      private_key
+    );
 
-/**
- * @return [String] binary string containing the uncompressed representation
- *   of this public key.
- */
-static VALUE
-PublicKey_uncompressed(VALUE self)
-{
-  // TODO: Cache value after first computation
-  PublicKey *public_key;
-  size_t serialized_pubkey_len = UNCOMPRESSED_PUBKEY_SIZE_BYTES;
-  unsigned char serialized_pubkey[UNCOMPRESSED_PUBKEY_SIZE_BYTES];
+    MEMCPY(args.items[i].private_key, private_key->data, unsigned char, 32);
+  }
 
-  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
+  args.ctx = context->ctx;
+  start = StatsStart(context);
+  RunBatch(context, PublicKeyBatch_range, &args, count);
+  if (context->stats != NULL)
+  {
+    failures = 0;
+    for (i = 0; i < count; i++)
+    {
+      failures += args.items[i].result != 1;
+    }
+    StatsRecord(context, STATS_PUBLIC_KEY_CREATE, count, failures, start);
+  }
 
-  secp256k1_ec_pubkey_serialize(secp256k1_context_no_precomp,
-                                serialized_pubkey,
-                                &serialized_pubkey_len,
-                                &(public_key->pubkey),
-                                SECP256K1_EC_UNCOMPRESSED);
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
+  {
+    if (args.items[i].result != 1)
+    {
+      rb_raise(Secp256k1_DeserializationError_class, "invalid private key data");
+    }
+
+    public_key_result = PublicKey_alloc(Secp256k1_PublicKey_class);
+    TypedData_Get_Struct(
+      public_key_result, PublicKey, &PublicKey_DataType, public_key
+    );
+    public_key->pubkey = args.items[i].pubkey;
+    rb_ary_push(result, public_key_result);
+  }
 
-  return rb_str_new((char*)serialized_pubkey, serialized_pubkey_len);
+  ALLOCV_END(items_buffer);
+
+  return result;
 }
 
 /**
- * @return [String] binary string containing the compressed representation of
- *   this public key.
+ * Reads a 32-byte tweak argument.
+ *
+ * \param in_tweak String, IO::Buffer, or memory view holding the tweak
+ * \param out_tweak32 copy of the tweak
+ * \raise Secp256k1::Error if the tweak is not 32 bytes
  */
-static VALUE
-PublicKey_compressed(VALUE self)
+static void
+TweakBytes(VALUE in_tweak, unsigned char *out_tweak32)
 {
-  // TODO: Cache value after first computation
-  PublicKey *public_key;
-  size_t serialized_pubkey_len = COMPRESSED_PUBKEY_SIZE_BYTES;
-  unsigned char serialized_pubkey[COMPRESSED_PUBKEY_SIZE_BYTES];
-
-  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, public_key);
-
-  secp256k1_ec_pubkey_serialize(secp256k1_context_no_precomp,
-                                serialized_pubkey,
-                                &serialized_pubkey_len,
-                                &(public_key->pubkey),
-                                SECP256K1_EC_COMPRESSED);
+  const unsigned char *tweak;
+  long tweak_len;
 
-  return rb_str_new((char*)serialized_pubkey, serialized_pubkey_len);
+  tweak = InputBytes(in_tweak, out_tweak32, 32, &tweak_len);
+  if (tweak_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "tweak must be 32 bytes in length");
+  }
+  if (tweak != out_tweak32)
+  {
+    MEMCPY(out_tweak32, tweak, unsigned char, 32);
+  }
 }
 
 /**
- * Compares two public keys.
+ * Applies a tweak to a private key.
  *
- * Public keys are considered equal if their compressed representations match.
- *
- * @param other [Secp256k1::PublicKey] public key to compare.
- * @return [Boolean] true if the public keys are identical, false otherwise.
+ * \param self context the tweak is applied with
+ * \param in_private_key private key to be tweaked
+ * \param in_tweak 32-byte tweak
+ * \param in_tweak_op operation to apply
+ * \return new private key holding the result
+ * \raise Secp256k1::Error if the tweak is invalid or produces an invalid key
  */
 static VALUE
-PublicKey_equals(VALUE self, VALUE other)
+TweakPrivateKey(VALUE self,
+                VALUE in_private_key,
+                VALUE in_tweak,
+                TweakT in_tweak_op)
 {
-  PublicKey *lhs;
-  PublicKey *rhs;
-  unsigned char lhs_compressed[33];
-  unsigned char rhs_compressed[33];
-  size_t lhs_len;
-  size_t rhs_len;
-
-  lhs_len = 33;
-  rhs_len = 33;
-
-  TypedData_Get_Struct(self, PublicKey, &PublicKey_DataType, lhs);
-  TypedData_Get_Struct(other, PublicKey, &PublicKey_DataType, rhs);
+  Context *context;
+  PrivateKey *private_key;
+  unsigned char tweak[32];
+  unsigned char private_key_data[32];
+  int result;
 
-  secp256k1_ec_pubkey_serialize(
-    secp256k1_context_no_precomp,
-    lhs_compressed,
-    &lhs_len,
-    &(lhs->pubkey),
-    SECP256K1_EC_COMPRESSED
-  );
-  secp256k1_ec_pubkey_serialize(
-    secp256k1_context_no_precomp,
-    rhs_compressed,
-    &rhs_len,
-    &(rhs->pubkey),
-    SECP256K1_EC_COMPRESSED
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  TypedData_Get_Struct(
+    in_private_key, PrivateKey, &PrivateKey_DataType, private_key
   );
+  TweakBytes(in_tweak, tweak);
 
-  if (lhs_len == rhs_len &&
-      memcmp(lhs_compressed, rhs_compressed, lhs_len) == 0)
+  MEMCPY(private_key_data, private_key->data, unsigned char, 32);
+  if (in_tweak_op == TWEAK_MUL)
   {
-    return Qtrue;
+    result = secp256k1_ec_seckey_tweak_mul(
+      context->ctx, private_key_data, tweak
+    );
+  }
+  else
+  {
+    result = secp256k1_ec_seckey_tweak_add(
+      context->ctx, private_key_data, tweak
+    );
   }
 
-  return Qfalse;
-}
+  if (result != 1)
+  {
+    rb_raise(Secp256k1_Error_class, "invalid tweak for private key");
+  }
 
-//
-// Secp256k1::PrivateKey class interface
-//
+  return PrivateKey_create(private_key_data);
+}
 
+/**
+ * Applies a tweak to a public key.
+ *
+ * \param self context the tweak is applied with
+ * \param in_public_key public key to be tweaked
+ * \param in_tweak 32-byte tweak
+ * \param in_tweak_op operation to apply
+ * \return new public key holding the result
+ * \raise Secp256k1::Error if the tweak is invalid or produces an invalid key
+ */
 static VALUE
-PrivateKey_alloc(VALUE klass)
+TweakPublicKey(VALUE self,
+               VALUE in_public_key,
+               VALUE in_tweak,
+               TweakT in_tweak_op)
 {
-  VALUE new_instance;
-  PrivateKey *private_key;
+  Context *context;
+  PublicKey *public_key;
+  PublicKeyTweakArgs args;
+  unsigned long long start;
+  VALUE result;
 
-  private_key = ALLOC(PrivateKey);
-  MEMZERO(private_key, PrivateKey, 1);
-  new_instance = TypedData_Wrap_Struct(klass, &PrivateKey_DataType, private_key);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  TypedData_Get_Struct(
+    in_public_key, PublicKey, &PublicKey_DataType, public_key
+  );
+  TweakBytes(in_tweak, args.tweak);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
 
-  return new_instance;
-}
+  args.ctx = context->ctx;
+  args.tweak_op = in_tweak_op;
+  args.pubkey = public_key->pubkey;
 
-static VALUE
-PrivateKey_create(unsigned char *in_private_key_data)
-{
-  PrivateKey *private_key;
-  VALUE result;
+  start = StatsStart(context);
+  WithoutGVL(PublicKeyTweak_without_gvl, &args);
+  StatsRecord(context, STATS_PUBLIC_KEY_TWEAK, 1, args.result != 1, start);
 
-  if (secp256k1_ec_seckey_verify(secp256k1_context_no_precomp,
-                                 in_private_key_data) != 1)
+  if (args.result != 1)
   {
-    rb_raise(Secp256k1_Error_class, "invalid private key data");
+    rb_raise(Secp256k1_Error_class, "invalid tweak for public key");
   }
 
-  result = PrivateKey_alloc(Secp256k1_PrivateKey_class);
-  TypedData_Get_Struct(result, PrivateKey, &PrivateKey_DataType, private_key);
-  MEMCPY(private_key->data, in_private_key_data, char, 32);
-
-  rb_iv_set(result, "@data", rb_str_new((char*)in_private_key_data, 32));
+  result = PublicKey_alloc(Secp256k1_PublicKey_class);
+  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+  public_key->pubkey = args.pubkey;
 
   return result;
 }
 
 /**
- * Load a private key from binary data.
+ * Adds a tweak to a private key modulo the curve order.
  *
- * @param in_private_key_data [String] 32 byte binary string of private key
- *   data.
- * @return [Secp256k1::PrivateKey] private key loaded from the given data.
- * @raise [Secp256k1::Error] if private key data is not 32 bytes or is invalid.
+ * @param private_key [Secp256k1::PrivateKey] private key to be tweaked.
+ * @param tweak [String] 32-byte big-endian scalar.
+ * @return [Secp256k1::PrivateKey] private key plus the tweak.
+ * @raise [Secp256k1::Error] if the tweak is not less than the curve order or
+ *   the result is zero.
  */
 static VALUE
-PrivateKey_from_data(VALUE klass, VALUE in_private_key_data)
+Context_tweak_add_private_key(VALUE self, VALUE private_key, VALUE tweak)
 {
-  unsigned char *private_key_data;
+  return TweakPrivateKey(self, private_key, tweak, TWEAK_ADD);
+}
 
-  Check_Type(in_private_key_data, T_STRING);
-  if (RSTRING_LEN(in_private_key_data) != 32)
-  {
-    rb_raise(
-      Secp256k1_Error_class,
-      "private key data must be 32 bytes in length"
-    );
-  }
+/**
+ * Multiplies a private key by a tweak modulo the curve order.
+ *
+ * @param private_key [Secp256k1::PrivateKey] private key to be tweaked.
+ * @param tweak [String] 32-byte big-endian scalar.
+ * @return [Secp256k1::PrivateKey] private key times the tweak.
+ * @raise [Secp256k1::Error] if the tweak is zero or not less than the curve
+ *   order.
+ */
+static VALUE
+Context_tweak_mul_private_key(VALUE self, VALUE private_key, VALUE tweak)
+{
+  return TweakPrivateKey(self, private_key, tweak, TWEAK_MUL);
+}
 
-  private_key_data = (unsigned char*)StringValuePtr(in_private_key_data);
-  return PrivateKey_create(private_key_data);
+/**
+ * Adds the tweak times the generator to a public key.
+ *
+ * The result is the public key of {#tweak_add_private_key} applied to the
+ * matching private key.
+ *
+ * @param public_key [Secp256k1::PublicKey] public key to be tweaked.
+ * @param tweak [String] 32-byte big-endian scalar.
+ * @return [Secp256k1::PublicKey] tweaked public key.
+ * @raise [Secp256k1::Error] if the tweak is not less than the curve order or
+ *   the result is the point at infinity.
+ */
+static VALUE
+Context_tweak_add_public_key(VALUE self, VALUE public_key, VALUE tweak)
+{
+  return TweakPublicKey(self, public_key, tweak, TWEAK_ADD);
 }
 
 /**
- * Compare two private keys.
+ * Multiplies a public key by a tweak.
  *
- * Private keys are considered equal if their data fields are identical.
+ * The result is the public key of {#tweak_mul_private_key} applied to the
+ * matching private key.
  *
- * @param other [Secp256k1::PrivateKey] private key to compare. 
- * @return [Boolean] true if they are equal, false otherwise.
+ * @param public_key [Secp256k1::PublicKey] public key to be tweaked.
+ * @param tweak [String] 32-byte big-endian scalar.
+ * @return [Secp256k1::PublicKey] tweaked public key.
+ * @raise [Secp256k1::Error] if the tweak is zero or not less than the curve
+ *   order.
  */
 static VALUE
-PrivateKey_equals(VALUE self, VALUE other)
+Context_tweak_mul_public_key(VALUE self, VALUE public_key, VALUE tweak)
 {
-  PrivateKey *lhs;
-  PrivateKey *rhs;
+  return TweakPublicKey(self, public_key, tweak, TWEAK_MUL);
+}
 
-  TypedData_Get_Struct(self, PrivateKey, &PrivateKey_DataType, lhs);
-  TypedData_Get_Struct(other, PrivateKey, &PrivateKey_DataType, rhs);
+/**
+ * Adds public keys together.
+ *
+ * @param in_public_keys [Array<Secp256k1::PublicKey>, Secp256k1::PublicKeyArray]
+ *   public keys to add.
+ * @return [Secp256k1::PublicKey] sum of the public keys.
+ * @raise [ArgumentError] if no public keys are given.
+ * @raise [Secp256k1::Error] if the public keys sum to the point at infinity.
+ */
+static VALUE
+Context_combine_public_keys(VALUE self, VALUE in_public_keys)
+{
+  Context *context;
+  PublicKey *public_key;
+  const secp256k1_pubkey **pubkeys;
+  secp256k1_pubkey combined;
+  VALUE pubkeys_buffer;
+  VALUE result;
+  long count;
+  long i;
+  int combine_result;
 
-  if (memcmp(lhs->data, rhs->data, 32) == 0)
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+
+  count = PublicKeysLength(in_public_keys);
+  if (count == 0)
   {
-    return Qtrue;
+    rb_raise(rb_eArgError, "no public keys to combine");
   }
 
-  return Qfalse;
-}
+  // Addition is cheap compared to releasing the GVL, so the keys are read in
+  // place rather than copied
+  pubkeys = ALLOCV_N(const secp256k1_pubkey*, pubkeys_buffer, count);
+  for (i = 0; i < count; i++)
+  {
+    pubkeys[i] = PublicKeysEntry(in_public_keys, i);
+  }
 
-//
-// Secp256k1::Signature class interface
-//
+  combine_result = secp256k1_ec_pubkey_combine(
+    context->ctx, &combined, pubkeys, (size_t)count
+  );
+  ALLOCV_END(pubkeys_buffer);
 
-static VALUE
-Signature_alloc(VALUE klass)
-{
-  VALUE new_instance;
-  Signature *signature;
+  if (combine_result != 1)
+  {
+    rb_raise(
+      Secp256k1_Error_class, "public keys sum to the point at infinity"
+    );
+  }
 
-  signature = ALLOC(Signature);
-  MEMZERO(signature, Signature, 1);
-  new_instance = TypedData_Wrap_Struct(klass, &Signature_DataType, signature);
+  result = PublicKey_alloc(Secp256k1_PublicKey_class);
+  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
+  public_key->pubkey = combined;
 
-  return new_instance;
+  return result;
 }
 
 /**
- * Deserializes a Signature from 64-byte compact signature data.
+ * Reads the chain code and public key of a BIP-32 extended public key.
  *
- * @param in_compact_signature [String] compact signature as 64-byte binary
- *   string.
- * @return [Secp256k1::Signature] object deserialized from compact signature.
- * @raise [Secp256k1::DeserializationError] if signature data is invalid.
+ * \param in_xpub Base58Check encoded or 78-byte serialized extended key
+ * \param out_chain_code 32-byte chain code
+ * \param out_compressed 33-byte compressed public key
+ * \param out_pubkey parsed public key
+ * \raise Secp256k1::DeserializationError if the extended key is invalid or
+ *   holds a private key
  */
-static VALUE
-Signature_from_compact(VALUE klass, VALUE in_compact_signature)
+static void
+ParseExtendedPublicKey(VALUE in_xpub,
+                       unsigned char *out_chain_code,
+                       unsigned char *out_compressed,
+                       secp256k1_pubkey *out_pubkey)
 {
-  Signature *signature;
-  VALUE signature_result;
-  unsigned char *signature_data;
+  unsigned char serialized[78];
 
-  Check_Type(in_compact_signature, T_STRING);
-
-  if (RSTRING_LEN(in_compact_signature) != 64)
+  StringValue(in_xpub);
+  if (RSTRING_LEN(in_xpub) == 78)
   {
-    rb_raise(Secp256k1_Error_class, "compact signature must be 64 bytes");
+    MEMCPY(serialized, RSTRING_PTR(in_xpub), unsigned char, 78);
   }
-
-  signature_data = (unsigned char*)StringValuePtr(in_compact_signature);
-
-  signature_result = Signature_alloc(Secp256k1_Signature_class);
-  TypedData_Get_Struct(signature_result, Signature, &Signature_DataType, signature);
-
-  if (secp256k1_ecdsa_signature_parse_compact(secp256k1_context_no_precomp,
-                                              &(signature->sig),
-                                              signature_data) != 1)
+  else if (!Base58CheckDecode(RSTRING_PTR(in_xpub),
+                              RSTRING_LEN(in_xpub),
+                              serialized,
+                              78))
   {
-    rb_raise(Secp256k1_DeserializationError_class, "invalid compact signature");
+    rb_raise(
+      Secp256k1_DeserializationError_class, "invalid extended public key"
+    );
   }
 
-  return signature_result;
+  // version(4) || depth(1) || fingerprint(4) || child(4) || chain code(32) ||
+  // key(33), where private keys are prefixed with a zero byte
+  MEMCPY(out_chain_code, serialized + 13, unsigned char, 32);
+  MEMCPY(out_compressed, serialized + 45, unsigned char, 33);
+  if (out_compressed[0] == 0 ||
+      secp256k1_ec_pubkey_parse(secp256k1_context_static,
+                                out_pubkey,
+                                out_compressed,
+                                33) != 1)
+  {
+    rb_raise(
+      Secp256k1_DeserializationError_class,
+      "extended key does not hold a valid public key"
+    );
+  }
 }
 
 /**
- * Converts a DER encoded binary signature into a signature object.
+ * Derives BIP-32 child public keys of an extended public key.
  *
- * @param in_der_encoded_signature [String] DER encoded signature as binary
- *   string.
- * @return [Secp256k1::Signature] signature object initialized using signature
- *   data.
- * @raise [Secp256k1::DeserializationError] if signature data is invalid.
+ * Only normal (non-hardened) children can be derived from a public key. The
+ * HMAC and tweak of every child run in C without the GVL, and large ranges
+ * are split across the context's workers.
+ *
+ * @param in_xpub [String] Base58Check encoded extended public key, such as an
+ *   "xpub" or "tpub" string, or its 78-byte serialization.
+ * @param in_range [Range<Integer>] child indexes to derive, e.g. 0...1000.
+ * @return [Array<Secp256k1::PublicKey, nil>] child public keys in index order.
+ *   An entry is nil in the astronomically unlikely case that BIP-32 defines no
+ *   child for its index.
+ * @raise [Secp256k1::DeserializationError] if the extended key is invalid or
+ *   is a private extended key.
+ * @raise [ArgumentError] if an index is negative or hardened.
  */
 static VALUE
-Signature_from_der_encoded(VALUE klass, VALUE in_der_encoded_signature)
+Context_derive_children(VALUE self, VALUE in_xpub, VALUE in_range)
 {
-  Signature *signature;
-  VALUE signature_result;
-  unsigned char *signature_data;
-
-  Check_Type(in_der_encoded_signature, T_STRING);
+  Context *context;
+  PublicKey *public_key;
+  DeriveChildrenArgs args;
+  unsigned char chain_code[32];
+  VALUE pubkeys_buffer;
+  VALUE results_buffer;
+  VALUE range_begin;
+  VALUE range_end;
+  VALUE public_key_result;
+  VALUE result;
+  unsigned long long start;
+  int exclude_end;
+  long first;
+  long last;
+  long failures;
+  long count;
+  long i;
 
-  signature_data = (unsigned char*)StringValuePtr(in_der_encoded_signature);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  if (!rb_range_values(in_range, &range_begin, &range_end, &exclude_end))
+  {
+    rb_raise(
+      rb_eTypeError,
+      "wrong argument type %s (expected Range)",
+      rb_obj_classname(in_range)
+    );
+  }
+  first = NUM2LONG(range_begin);
+  last = NUM2LONG(range_end) - (exclude_end ? 1 : 0);
+  if (first < 0 || last >= 0x80000000L)
+  {
+    rb_raise(
+      rb_eArgError,
+      "child indexes must be between 0 and 2**31 - 1 (hardened children "
+      "need the private key)"
+    );
+  }
 
-  signature_result = Signature_alloc(Secp256k1_Signature_class);
-  TypedData_Get_Struct(signature_result, Signature, &Signature_DataType, signature);
+  ParseExtendedPublicKey(
+    in_xpub, chain_code, args.parent, &(args.parent_pubkey)
+  );
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+
+  count = last < first ? 0 : last - first + 1;
+  args.ctx = context->ctx;
+  args.first_index = (unsigned long)first;
+  args.pubkeys = ALLOCV_N(secp256k1_pubkey, pubkeys_buffer, count);
+  args.results = ALLOCV_N(int, results_buffer, count);
+  HmacSha512_init(&(args.hmac), chain_code, 32);
+
+  start = StatsStart(context);
+  RunBatch(context, DeriveChildren_range, &args, count);
+  if (context->stats != NULL)
+  {
+    failures = 0;
+    for (i = 0; i < count; i++)
+    {
+      failures += args.results[i] != 1;
+    }
+    StatsRecord(context, STATS_PUBLIC_KEY_TWEAK, count, failures, start);
+  }
 
-  if (secp256k1_ecdsa_signature_parse_der(secp256k1_context_no_precomp,
-                                          &(signature->sig),
-                                          signature_data,
-                                          RSTRING_LEN(in_der_encoded_signature)) != 1)
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
   {
-    rb_raise(Secp256k1_DeserializationError_class, "invalid DER encoded signature");
+    if (args.results[i] != 1)
+    {
+      rb_ary_push(result, Qnil);
+      continue;
+    }
+
+    public_key_result = PublicKey_alloc(Secp256k1_PublicKey_class);
+    TypedData_Get_Struct(
+      public_key_result, PublicKey, &PublicKey_DataType, public_key
+    );
+    public_key->pubkey = args.pubkeys[i];
+    rb_ary_push(result, public_key_result);
   }
 
-  return signature_result;
+  ALLOCV_END(results_buffer);
+  ALLOCV_END(pubkeys_buffer);
+
+  return result;
 }
 
 /**
- * Return Distinguished Encoding Rules (DER) encoded signature data.
- *
- * @return [String] binary string containing DER-encoded signature data.
+ * @return [Array<Symbol>] operations this context has precomputed tables for,
+ *   a subset of [:sign, :verify].
  */
 static VALUE
-Signature_der_encoded(VALUE self)
+Context_capabilities(VALUE self)
 {
-  // TODO: Cache value after first computation
-  Signature *signature;
-  unsigned long der_signature_len;
-  unsigned char der_signature[72];
+  Context *context;
+  VALUE result;
 
-  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
 
-  der_signature_len = 72;
-  if (secp256k1_ecdsa_signature_serialize_der(secp256k1_context_no_precomp,
-                                              der_signature,
-                                              &der_signature_len,
-                                              &(signature->sig)) != 1)
+  result = rb_ary_new2(2);
+  if (context->capabilities & SECP256K1_FLAGS_BIT_CONTEXT_SIGN)
   {
-    rb_raise(
-      Secp256k1_SerializationError_class,
-      "could not compute DER encoded signature"
-    );
+    rb_ary_push(result, ID2SYM(rb_intern("sign")));
+  }
+  if (context->capabilities & SECP256K1_FLAGS_BIT_CONTEXT_VERIFY)
+  {
+    rb_ary_push(result, ID2SYM(rb_intern("verify")));
   }
 
-  return rb_str_new((char*)der_signature, der_signature_len);
+  return result;
 }
 
 /**
- * Returns the 64 byte compact representation of this signature.
+ * Builds a snapshot of the counters of an instrumented context.
  *
- * @return [String] 64 byte binary string containing signature data.
+ * \param in_context context with stats enabled
+ * \param in_reset if non-zero each counter is atomically reset after reading
+ * \return Hash mapping operation names to Hashes of counters
  */
 static VALUE
-Signature_compact(VALUE self)
+StatsToHash(Context *in_context, int in_reset)
 {
-  // TODO: Cache value after first computation
-  Signature *signature;
-  unsigned char compact_signature[COMPACT_SIG_SIZE_BYTES];
-
-  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
+  OpStats *stats;
+  VALUE result;
+  VALUE op_stats;
+  int op;
 
-  if (secp256k1_ecdsa_signature_serialize_compact(secp256k1_context_no_precomp,
-                                                  compact_signature,
-                                                  &(signature->sig)) != 1)
+  result = rb_hash_new();
+  for (op = 0; op < STATS_OP_COUNT; op++)
   {
-    rb_raise(
-      Secp256k1_SerializationError_class,
-      "unable to compute compact signature"
+#ifndef HAVE_SECP256K1_RECOVERY_H
+    if (op == STATS_SIGN_RECOVERABLE || op == STATS_RECOVER)
+    {
+      continue;
+    }
+#endif // HAVE_SECP256K1_RECOVERY_H
+#ifndef HAVE_SECP256K1_ECDH_H
+    if (op == STATS_ECDH)
+    {
+      continue;
+    }
+#endif // HAVE_SECP256K1_ECDH_H
+#ifndef HAVE_SECP256K1_SCHNORRSIG_H
+    if (op == STATS_SIGN_SCHNORR || op == STATS_VERIFY_SCHNORR)
+    {
+      continue;
+    }
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+
+    stats = &(in_context->stats[op]);
+    op_stats = rb_hash_new();
+    rb_hash_aset(
+      op_stats,
+      ID2SYM(rb_intern("calls")),
+      ULL2NUM(in_reset ? STATS_TAKE(stats->calls) : STATS_LOAD(stats->calls))
+    );
+    rb_hash_aset(
+      op_stats,
+      ID2SYM(rb_intern("failures")),
+      ULL2NUM(
+        in_reset ? STATS_TAKE(stats->failures) : STATS_LOAD(stats->failures)
+      )
     );
+    rb_hash_aset(
+      op_stats,
+      ID2SYM(rb_intern("nanoseconds")),
+      ULL2NUM(
+        in_reset ?
+          STATS_TAKE(stats->nanoseconds) :
+          STATS_LOAD(stats->nanoseconds)
+      )
+    );
+    rb_hash_aset(result, ID2SYM(rb_intern(STATS_OP_NAMES[op])), op_stats);
   }
 
-  return rb_str_new((char*)compact_signature, COMPACT_SIG_SIZE_BYTES);
+  return result;
 }
 
 /**
- * Returns the normalized lower-S form of this signature.
+ * Returns the operation counters of a context created with stats: true.
  *
- * This can be useful when importing signatures generated by other applications
- * that may not be normalized. Non-normalized signatures are potentially
- * forgeable.
+ * Each operation maps to the number of entries processed (:calls), the number
+ * that failed or did not verify (:failures), and the cumulative wall-clock
+ * time spent in libsecp256k1 (:nanoseconds). Entries of batch and packed
+ * calls are counted individually, while a batch's time is counted once no
+ * matter how many workers it was split across.
  *
- * @return [Array] first element is a boolean that is `true` if the signature
- *   was normalized, false otherwise. The second element is a `Signature`
- *   object corresponding to the normalized signature.
+ * @return [Hash{Symbol => Hash{Symbol => Integer}}, nil] counters keyed by
+ *   operation, or nil if the context was not created with stats: true.
  */
 static VALUE
-Signature_normalized(VALUE self)
+Context_stats(VALUE self)
 {
-  VALUE result_sig;
-  VALUE was_normalized;
-  VALUE result;
-  Signature *signature;
-  Signature *normalized_signature;
-
-  TypedData_Get_Struct(self, Signature, &Signature_DataType, signature);
-  result_sig = Signature_alloc(Secp256k1_Signature_class);
-  TypedData_Get_Struct(
-    result_sig, Signature, &Signature_DataType, normalized_signature
-  );
+  Context *context;
 
-  was_normalized = Qfalse;
-  if (secp256k1_ecdsa_signature_normalize(
-        secp256k1_context_no_precomp,
-        &(normalized_signature->sig),
-        &(signature->sig)) == 1)
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  if (context->stats == NULL)
   {
-    was_normalized = Qtrue;
+    return Qnil;
   }
 
-  result = rb_ary_new2(2);
-  rb_ary_push(result, was_normalized);
-  rb_ary_push(result, result_sig);
-
-  return result;
+  return StatsToHash(context, 0);
 }
 
 /**
- * Compares two signatures.
+ * Returns the operation counters like {#stats} and resets them to zero.
  *
- * Two signatures are equal if their compact encodings are identical.
+ * Each counter is read and cleared in one atomic step, so counts added by
+ * other threads are never lost between successive calls. This makes it
+ * suitable for periodically shipping deltas to a metrics system.
  *
- * @param other [Secp256k1::Signature] signature to compare
- * @return [Boolean] true if signatures match, false otherwise.
+ * @return [Hash{Symbol => Hash{Symbol => Integer}}, nil] counters keyed by
+ *   operation since the last reset, or nil if the context was not created
+ *   with stats: true.
  */
 static VALUE
-Signature_equals(VALUE self, VALUE other)
+Context_reset_stats(VALUE self)
 {
-  Signature *lhs;
-  Signature *rhs;
-  unsigned char lhs_compact[64];
-  unsigned char rhs_compact[64];
-
-  TypedData_Get_Struct(self, Signature, &Signature_DataType, lhs);
-  TypedData_Get_Struct(other, Signature, &Signature_DataType, rhs);
-
-  secp256k1_ecdsa_signature_serialize_compact(
-    secp256k1_context_no_precomp, lhs_compact, &(lhs->sig)
-  );
-  secp256k1_ecdsa_signature_serialize_compact(
-    secp256k1_context_no_precomp, rhs_compact, &(rhs->sig)
-  );
+  Context *context;
 
-  if (memcmp(lhs_compact, rhs_compact, 64) == 0)
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  if (context->stats == NULL)
   {
-    return Qtrue;
+    return Qnil;
   }
 
-  return Qfalse;
+  return StatsToHash(context, 1);
 }
 
-//
-// Secp256k1::RecoverableSignature class interface
-//
-
-#ifdef HAVE_SECP256K1_RECOVERY_H
-
+/**
+ * @return [Integer] number of native threads batch operations are split
+ *   across, including the calling thread.
+ */
 static VALUE
-RecoverableSignature_alloc(VALUE klass)
+Context_workers(VALUE self)
 {
-  VALUE new_instance;
-  RecoverableSignature *recoverable_signature;
+  Context *context;
 
-  recoverable_signature = ALLOC(RecoverableSignature);
-  MEMZERO(recoverable_signature, RecoverableSignature, 1);
-  new_instance = TypedData_Wrap_Struct(
-    klass, &RecoverableSignature_DataType, recoverable_signature
-  );
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
 
-  return new_instance;
+#ifdef HAVE_PTHREAD_H
+  if (context->pool != NULL)
+  {
+    return LONG2NUM(context->pool->worker_count);
+  }
+#endif // HAVE_PTHREAD_H
+
+  return INT2FIX(1);
 }
 
+// Context recoverable signature methods
+#ifdef HAVE_SECP256K1_RECOVERY_H
+
 /**
- * Returns the compact encoding of recoverable signature.
+ * Computes the recoverable ECDSA signature of data signed with private key.
  *
- * @return [Array] first element is the 64 byte compact encoding of signature,
- *   the second element is the integer recovery ID.
- * @raise [Secp256k1::SerializationError] if signature serialization fails.
+ * @param in_private_key [Secp256k1::PrivateKey] private key to sign with.
+ * @param in_hash32 [String, IO::Buffer] 32-byte SHA-256 hash of data.
+ * @param extra_entropy [String] (Optional) 32 bytes mixed into the RFC6979
+ *   nonce derivation.
+ * @return [Secp256k1::RecoverableSignature] recoverable signature produced by
+ *   signing the SHA-256 hash `in_hash32` with `in_private_key`.
+ * @raise [Secp256k1::Error] if the hash or extra_entropy is not 32 bytes or
+ *   signature could not be computed.
  */
 static VALUE
-RecoverableSignature_compact(VALUE self)
+Context_sign_recoverable(int argc, const VALUE *argv, VALUE self)
 {
+  Context *context;
+  PrivateKey *private_key;
   RecoverableSignature *recoverable_signature;
-  unsigned char compact_sig[64];
-  int recovery_id;
+  RecoverableSignDataArgs args;
+  unsigned long long start;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+  VALUE in_private_key;
+  VALUE in_hash32;
+  VALUE opts;
   VALUE result;
 
+  rb_scan_args(argc, argv, "2:", &in_private_key, &in_hash32, &opts);
+  NonceOptions_init(&(args.nonce), opts);
+
+  hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
+  if (hash32_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+  }
+
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
   TypedData_Get_Struct(
-    self,
-    RecoverableSignature,
-    &RecoverableSignature_DataType,
-    recoverable_signature
+    in_private_key, PrivateKey, &PrivateKey_DataType, private_key
   );
 
-  if (secp256k1_ecdsa_recoverable_signature_serialize_compact(
-        secp256k1_context_no_precomp,
-        compact_sig,
-        &recovery_id,
-        &(recoverable_signature->sig)) != 1)
+  args.ctx = context->ctx;
+  MEMCPY(args.hash32, hash32, unsigned char, 32);
+  MEMCPY(args.private_key, private_key->data, unsigned char, 32);
+
+  start = StatsStart(context);
+  WithoutGVL(RecoverableSignData_without_gvl, &args);
+  StatsRecord(context, STATS_SIGN_RECOVERABLE, 1, FAILURE(args.result), start);
+
+  if (SUCCESS(args.result))
   {
-    rb_raise(
-      Secp256k1_SerializationError_class,
-      "unable to serialize recoverable signature"
+    result = RecoverableSignature_alloc(Secp256k1_RecoverableSignature_class);
+    TypedData_Get_Struct(
+      result,
+      RecoverableSignature,
+      &RecoverableSignature_DataType,
+      recoverable_signature
     );
+    recoverable_signature->sig = args.signature;
+    recoverable_signature->context = self;
+    return result;
   }
 
-  // Create a new array with room for 2 elements and push data onto it
-  result = rb_ary_new2(2);
-  rb_ary_push(result, rb_str_new((char*)compact_sig, 64));
-  rb_ary_push(result, rb_int_new(recovery_id));
-
-  return result;
+  rb_raise(Secp256k1_Error_class, "unable to compute recoverable signature");
 }
 
 /**
- * Convert a recoverable signature to a non-recoverable signature.
+ * Hashes a message natively and recovers the public key that signed it.
  *
- * @return [Secp256k1::Signature] non-recoverable signature derived from this
- *   recoverable signature.
+ * Equivalent to {RecoverableSignature#recover_public_key} with the digest of
+ * `in_message`, using this context for recovery.
+ *
+ * @param in_recoverable_signature [Secp256k1::RecoverableSignature] signature
+ *   of the message digest.
+ * @param in_message [String, IO::Buffer] message that was signed.
+ * @param digest [Symbol] (Optional) digest to apply to the message, one of
+ *   :sha256 (default), :double_sha256, or :keccak256.
+ * @return [Secp256k1::PublicKey] recovered public key.
+ * @raise [ArgumentError] if the digest is not supported.
+ * @raise [Secp256k1::DeserializationError] if public key could not be
+ *   recovered.
  */
 static VALUE
-RecoverableSignature_to_signature(VALUE self)
+Context_recover_message(int argc, const VALUE *argv, VALUE self)
 {
+  Context *context;
   RecoverableSignature *recoverable_signature;
-  Signature *signature;
-  VALUE result;
+  RecoverArgs args;
+  DigestT digest;
+  VALUE in_recoverable_signature;
+  VALUE in_message;
+  VALUE opts;
+
+  rb_scan_args(argc, argv, "2:", &in_recoverable_signature, &in_message, &opts);
+  digest = DigestOption(opts, 0);
 
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
   TypedData_Get_Struct(
-    self,
+    in_recoverable_signature,
     RecoverableSignature,
     &RecoverableSignature_DataType,
     recoverable_signature
   );
 
-  result = Signature_alloc(Secp256k1_Signature_class);
-  TypedData_Get_Struct(
-    result,
-    Signature,
-    &Signature_DataType,
-    signature
-  );
-
-  // NOTE: This method cannot fail
-  secp256k1_ecdsa_recoverable_signature_convert(
-    secp256k1_context_no_precomp,
-    &(signature->sig),
-    &(recoverable_signature->sig));
+  HashMessage(in_message, digest, args.hash32);
+  args.signature = recoverable_signature->sig;
 
-  return result;
+  return RecoverHash(context, &args);
 }
 
 /**
- * Attempts to recover the public key associated with this signature.
+ * Loads recoverable signature from compact representation and recovery ID.
  *
- * @param in_hash32 [String] 32-byte SHA-256 hash of data.
- * @return [Secp256k1::PublicKey] recovered public key.
- * @raise [Secp256k1::Error] if hash given is not 32 bytes.
- * @raise [Secp256k1::DeserializationError] if public key could not be
- *   recovered.
+ * @param in_compact_sig [String, IO::Buffer] 64-byte compact signature.
+ * @param in_recovery_id [Integer] recovery ID (range [0, 3])
+ * @return [Secp256k1::RecoverableSignature] signature parsed from data.
+ * @raise [Secp256k1::DeserializationError] if signature data or recovery ID is
+ *   invalid.
+ * @raise [Secp256k1::Error] if compact signature is not 64 bytes or recovery ID
+ *   is not in range [0, 3].
  */
 static VALUE
-RecoverableSignature_recover_public_key(VALUE self, VALUE in_hash32)
+Context_recoverable_signature_from_compact(
+  VALUE self, VALUE in_compact_sig, VALUE in_recovery_id)
 {
   RecoverableSignature *recoverable_signature;
-  PublicKey *public_key;
+  unsigned char scratch[64];
+  const unsigned char *compact_sig;
+  long compact_sig_len;
+  int recovery_id;
   VALUE result;
-  unsigned char *hash32;
 
-  Check_Type(in_hash32, T_STRING);
-  if (RSTRING_LEN(in_hash32) != 32)
+  Check_Type(in_recovery_id, T_FIXNUM);
+
+  compact_sig = InputBytes(
+    in_compact_sig, scratch, sizeof(scratch), &compact_sig_len
+  );
+  recovery_id = FIX2INT(in_recovery_id);
+
+  if (compact_sig_len != 64)
   {
-    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+    rb_raise(Secp256k1_Error_class, "compact signature is not 64 bytes");
+  }
+
+  if (recovery_id < 0 || recovery_id > 3)
+  {
+    rb_raise(Secp256k1_Error_class, "invalid recovery ID, must be in range [0, 3]");
   }
 
+  result = RecoverableSignature_alloc(Secp256k1_RecoverableSignature_class);
   TypedData_Get_Struct(
-    self,
+    result,
     RecoverableSignature,
     &RecoverableSignature_DataType,
     recoverable_signature
   );
-  hash32 = (unsigned char*)StringValuePtr(in_hash32);
-
-  result = PublicKey_alloc(Secp256k1_PublicKey_class);
-  TypedData_Get_Struct(result, PublicKey, &PublicKey_DataType, public_key);
 
-  if (secp256k1_ecdsa_recover(recoverable_signature->ctx,
-                              &(public_key->pubkey),
-                              &(recoverable_signature->sig),
-                              hash32) == 1)
+  if (secp256k1_ecdsa_recoverable_signature_parse_compact(
+        secp256k1_context_static,
+        &(recoverable_signature->sig),
+        compact_sig,
+        recovery_id) == 1)
   {
+    recoverable_signature->context = self;
     return result;
   }
-
-  rb_raise(Secp256k1_DeserializationError_class, "unable to recover public key");
+  
+  rb_raise(Secp256k1_DeserializationError_class, "unable to parse recoverable signature");
 }
 
 /**
- * Compares two recoverable signatures.
+ * Recovers public keys from fixed-size records stored in one binary string.
  *
- * Two recoverable signatures their secp256k1_ecdsa_recoverable_signature data
- * is identical.
+ * Each record is 97 bytes: a 64-byte compact signature, a one byte recovery
+ * ID, and the 32-byte hash that was signed. Records are parsed and recovered
+ * in C without creating any intermediate Ruby objects, and large buffers are
+ * split across the context's workers.
  *
- * @param other [Secp256k1::RecoverableSignature] recoverable signature to
- *   compare.
- * @return [Boolean] true if the recoverable signatures are identical, false
- *   otherwise.
+ * @param in_records [String, IO::Buffer] buffer of concatenated records.
+ * @return [String] binary string with one 65-byte uncompressed public key per
+ *   record. Records that could not be parsed or recovered produce 65 zero
+ *   bytes.
+ * @raise [Secp256k1::Error] if the buffer length is not a multiple of the
+ *   record size.
  */
 static VALUE
-RecoverableSignature_equals(VALUE self, VALUE other)
+Context_recover_packed(VALUE self, VALUE in_records)
 {
-  RecoverableSignature *lhs;
-  RecoverableSignature *rhs;
+  Context *context;
+  RecoverPackedArgs args;
+  VALUE result;
+  const unsigned char *records;
+  long records_len;
+  unsigned long long start;
+  long count;
 
-  TypedData_Get_Struct(
-    self, RecoverableSignature, &RecoverableSignature_DataType, lhs
-  );
-  TypedData_Get_Struct(
-    other, RecoverableSignature, &RecoverableSignature_DataType, rhs
-  );
+  if (!BorrowBytes(in_records, &records, &records_len))
+  {
+    rb_raise(
+      rb_eTypeError,
+      "wrong argument type %s (expected String or IO::Buffer)",
+      rb_obj_classname(in_records)
+    );
+  }
 
-  // NOTE: It is safe to directly compare these data structures rather than
-  // first serializing and then comparing.
-  if (memcmp(&(lhs->sig),
-             &(rhs->sig),
-             sizeof(secp256k1_ecdsa_recoverable_signature)) == 0)
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+
+  if (records_len % RECOVER_PACKED_RECORD_SIZE != 0)
   {
-    return Qtrue;
+    rb_raise(
+      Secp256k1_Error_class,
+      "packed records must be a multiple of %d bytes",
+      RECOVER_PACKED_RECORD_SIZE
+    );
   }
 
-  return Qfalse;
-}
+  count = records_len / RECOVER_PACKED_RECORD_SIZE;
+  result = rb_str_new(NULL, count * UNCOMPRESSED_PUBKEY_SIZE_BYTES);
 
-#endif // HAVE_SECP256K1_RECOVERY_H
+  args.ctx = context->ctx;
+  args.records = records;
+  args.public_keys = (unsigned char*)RSTRING_PTR(result);
 
-//
-// Secp256k1::SharedSecret class interface
-//
+  start = StatsStart(context);
+  RunBatchOverBuffer(context, in_records, RecoverPacked_range, &args, count);
+  if (context->stats != NULL)
+  {
+    StatsRecord(
+      context,
+      STATS_RECOVER,
+      count,
+      CountPackedFailures(
+        args.public_keys, count, UNCOMPRESSED_PUBKEY_SIZE_BYTES
+      ),
+      start
+    );
+  }
 
-#ifdef HAVE_SECP256K1_ECDH_H
+  return result;
+}
 
+/**
+ * Recovers serialized public keys from compact recoverable signature data.
+ *
+ * Equivalent to calling {#recoverable_signature_from_compact} followed by
+ * {RecoverableSignature#recover_public_key} and {PublicKey#uncompressed} for
+ * each entry, without allocating the intermediate signature and public key
+ * objects.
+ *
+ * @param in_compact_sigs [Array<String>] 64-byte compact signatures.
+ * @param in_recovery_ids [Array<Integer>] recovery ID of each signature.
+ * @param in_hashes [Array<String>] 32-byte hash signed by each signature.
+ * @return [String] binary string with one 65-byte uncompressed public key per
+ *   signature. Signatures that could not be parsed or recovered produce 65
+ *   zero bytes.
+ * @raise [Secp256k1::Error] if the arrays differ in length, a compact
+ *   signature is not 64 bytes, a recovery ID is not in [0, 3], or a hash is
+ *   not 32 bytes.
+ */
 static VALUE
-SharedSecret_alloc(VALUE klass)
+Context_recover_public_keys_batch(VALUE self,
+                                  VALUE in_compact_sigs,
+                                  VALUE in_recovery_ids,
+                                  VALUE in_hashes)
 {
-  VALUE new_instance;
-  SharedSecret *shared_secret;
+  Context *context;
+  RecoverPackedArgs args;
+  unsigned char compact_sig_scratch[64];
+  unsigned char hash32_scratch[32];
+  const unsigned char *compact_sig;
+  const unsigned char *hash32;
+  unsigned char *records;
+  unsigned char *record;
+  long compact_sig_len;
+  long hash32_len;
+  VALUE in_compact_sig;
+  VALUE in_recovery_id;
+  VALUE in_hash32;
+  VALUE records_buffer;
+  VALUE result;
+  int recovery_id;
+  unsigned long long start;
+  long count;
+  long i;
+
+  Check_Type(in_compact_sigs, T_ARRAY);
+  Check_Type(in_recovery_ids, T_ARRAY);
+  Check_Type(in_hashes, T_ARRAY);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+
+  count = RARRAY_LEN(in_compact_sigs);
+  if (RARRAY_LEN(in_recovery_ids) != count || RARRAY_LEN(in_hashes) != count)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "compact signatures, recovery IDs, and hashes must have the same length"
+    );
+  }
 
-  shared_secret = ALLOC(SharedSecret);
-  MEMZERO(shared_secret, SharedSecret, 1);
-  new_instance = TypedData_Wrap_Struct(
-  klass, &SharedSecret_DataType, shared_secret
+  records = ALLOCV_N(
+    unsigned char, records_buffer, count * RECOVER_PACKED_RECORD_SIZE
   );
+  for (i = 0; i < count; i++)
+  {
+    in_compact_sig = rb_ary_entry(in_compact_sigs, i);
+    in_recovery_id = rb_ary_entry(in_recovery_ids, i);
+    in_hash32 = rb_ary_entry(in_hashes, i);
+    compact_sig = InputBytes(
+      in_compact_sig, compact_sig_scratch, 64, &compact_sig_len
+    );
+    Check_Type(in_recovery_id, T_FIXNUM);
+    hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
 
-  return new_instance;
-}
+    if (compact_sig_len != 64)
+    {
+      rb_raise(Secp256k1_Error_class, "compact signature is not 64 bytes");
+    }
 
-#endif // HAVE_SECP256K1_ECDH_H
+    recovery_id = FIX2INT(in_recovery_id);
+    if (recovery_id < 0 || recovery_id > 3)
+    {
+      rb_raise(Secp256k1_Error_class, "invalid recovery ID, must be in range [0, 3]");
+    }
 
-//
-// Secp256k1::Context class interface
-//
+    if (hash32_len != 32)
+    {
+      rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+    }
 
-/* Allocate a new context object */
-static VALUE
-Context_alloc(VALUE klass)
-{
-  VALUE new_instance;
-  Context *context;
+    record = records + i * RECOVER_PACKED_RECORD_SIZE;
+    MEMCPY(record, compact_sig, unsigned char, 64);
+    record[64] = (unsigned char)recovery_id;
+    MEMCPY(record + 65, hash32, unsigned char, 32);
+  }
 
-  context = ALLOC(Context);
-  MEMZERO(context, Context, 1);
+  result = rb_str_new(NULL, count * UNCOMPRESSED_PUBKEY_SIZE_BYTES);
 
-  new_instance = TypedData_Wrap_Struct(klass, &Context_DataType, context);
+  args.ctx = context->ctx;
+  args.records = records;
+  args.public_keys = (unsigned char*)RSTRING_PTR(result);
+  start = StatsStart(context);
+  RunBatch(context, RecoverPacked_range, &args, count);
+  if (context->stats != NULL)
+  {
+    StatsRecord(
+      context,
+      STATS_RECOVER,
+      count,
+      CountPackedFailures(
+        args.public_keys, count, UNCOMPRESSED_PUBKEY_SIZE_BYTES
+      ),
+      start
+    );
+  }
 
-  return new_instance;
+  ALLOCV_END(records_buffer);
+
+  return result;
 }
 
 /**
- * Initialize a new context.
+ * Recovers the public keys of many recoverable signatures in a single call.
  *
- * Context initialization should be infrequent as it is an expensive operation.
+ * Each signature is recovered against the hash at the same index using this
+ * context. Large batches are split across the context's workers.
  *
- * @param context_randomization_bytes [String,nil] (Optional) 32 bytes of
- *   random data used to randomize the context. If omitted then the
- *   context remains unrandomized. It is recommended that you provide this
- *   argument.
- * @return [Secp256k1::Context] 
- * @raise [Secp256k1::Error] if context randomization fails.
+ * @param in_signatures [Array<Secp256k1::RecoverableSignature>] signatures to
+ *   recover public keys from.
+ * @param in_hashes [Array<String>] 32-byte binary strings with SHA-256 hashes
+ *   of signed data.
+ * @return [Array<Secp256k1::PublicKey,nil>] recovered public keys in the same
+ *   order as the signatures, nil where recovery failed.
+ * @raise [Secp256k1::Error] if the arrays differ in length or any hash is not
+ *   32 bytes in length.
  */
 static VALUE
-Context_initialize(int argc, const VALUE* argv, VALUE self)
+Context_recover_batch(VALUE self, VALUE in_signatures, VALUE in_hashes)
 {
   Context *context;
-  unsigned char *seed32;
-  VALUE context_randomization_bytes;
-  VALUE opts;
-  static ID kwarg_ids;
+  RecoverableSignature *recoverable_signature;
+  PublicKey *public_key;
+  RecoverBatchArgs args;
+  unsigned char hash32_scratch[32];
+  const unsigned char *hash32;
+  long hash32_len;
+  VALUE in_hash32;
+  VALUE items_buffer;
+  VALUE public_key_result;
+  VALUE result;
+  unsigned long long start;
+  long failures;
+  long count;
+  long i;
 
-  context_randomization_bytes = Qnil;
-  if (!kwarg_ids)
+  Check_Type(in_signatures, T_ARRAY);
+  Check_Type(in_hashes, T_ARRAY);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+
+  count = RARRAY_LEN(in_signatures);
+  if (RARRAY_LEN(in_hashes) != count)
   {
-    CONST_ID(kwarg_ids, "context_randomization_bytes");
+    rb_raise(
+      Secp256k1_Error_class,
+      "signatures and hashes must have the same length"
+    );
   }
 
-  TypedData_Get_Struct(self, Context, &Context_DataType, context);
-
-  context->ctx = secp256k1_context_create(
-    SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY
-  );
+  args.items = ALLOCV_N(RecoverBatchItem, items_buffer, count);
+  for (i = 0; i < count; i++)
+  {
+    in_hash32 = rb_ary_entry(in_hashes, i);
+    hash32 = InputBytes(in_hash32, hash32_scratch, 32, &hash32_len);
+    if (hash32_len != 32)
+    {
+      rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+    }
 
-  // Handle optional second argument containing random bytes to use for
-  // randomization. We pass ":" to rb_scan_args to say that we expect keyword
-  // arguments. We then parse the opts result of the scan in order to grab
-  // context_randomization_bytes from the hash.
-  rb_scan_args(argc, argv, ":", &opts);
-  rb_get_kwargs(opts, &kwarg_ids, 0, 1, &context_randomization_bytes);
+    TypedData_Get_Struct(
+      rb_ary_entry(in_signatures, i),
+      RecoverableSignature,
+      &RecoverableSignature_DataType,
+      recoverable_signature
+    );
 
-  // We need this check because rb_get_kwargs will set the result to Qundef if
-  // the keyword argument is not provided. This lets us use the NIL_P
-  // predicate.
-  if (context_randomization_bytes == Qundef)
-  {
-    context_randomization_bytes = Qnil;
+    args.items[i].signature = recoverable_signature->sig;
+    MEMCPY(args.items[i].hash32, hash32, unsigned char, 32);
   }
 
-  if (!NIL_P(context_randomization_bytes)) // Random bytes given
+  args.ctx = context->ctx;
+  start = StatsStart(context);
+  RunBatch(context, RecoverBatch_range, &args, count);
+  if (context->stats != NULL)
   {
-    Check_Type(context_randomization_bytes, T_STRING);
-    if (RSTRING_LEN(context_randomization_bytes) != 32)
+    failures = 0;
+    for (i = 0; i < count; i++)
     {
-      rb_raise(
-        Secp256k1_Error_class,
-        "context_randomization_bytes must be 32 bytes in length"
-      );
+      failures += args.items[i].result != 1;
     }
+    StatsRecord(context, STATS_RECOVER, count, failures, start);
+  }
 
-    seed32 = (unsigned char*)StringValuePtr(context_randomization_bytes);
-
-    // Randomize the context at initialization time rather than before calls so
-    // the same context can be used across threads safely.
-    if (secp256k1_context_randomize(context->ctx, seed32) != 1)
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
+  {
+    if (args.items[i].result != 1)
     {
-      rb_raise(
-        Secp256k1_Error_class,
-        "context randomization failed"
-      );
+      rb_ary_push(result, Qnil);
+      continue;
     }
+
+    public_key_result = PublicKey_alloc(Secp256k1_PublicKey_class);
+    TypedData_Get_Struct(
+      public_key_result, PublicKey, &PublicKey_DataType, public_key
+    );
+    public_key->pubkey = args.items[i].pubkey;
+    rb_ary_push(result, public_key_result);
   }
 
-  return self;
+  ALLOCV_END(items_buffer);
+
+  return result;
 }
 
+#endif // HAVE_SECP256K1_RECOVERY_H
+
+// Context EC Diffie-Hellman methods
+#ifdef HAVE_SECP256K1_ECDH_H
+
 /**
- * Converts binary private key data into a new key pair.
+ * Reads the hash: keyword argument of the ECDH methods.
  *
- * @param in_private_key_data [String] binary private key data
- * @return [Secp256k1::KeyPair] key pair initialized from the private key data.
- * @raise [Secp256k1::Error] if the private key data is invalid or key derivation
- *   fails.
+ * \param in_opts keyword arguments hash, or Qnil
+ * \return hash function to pass to secp256k1_ecdh, NULL for the default
+ * \raise ArgumentError if the hash is not supported
  */
-static VALUE
-Context_key_pair_from_private_key(VALUE self, VALUE in_private_key_data)
+static secp256k1_ecdh_hash_function
+EcdhHashOption(VALUE in_opts)
 {
-  Context *context;
-  VALUE public_key;
-  VALUE private_key;
-  unsigned char *private_key_data;
+  static ID kwarg_id;
+  static ID sha256_id;
+  static ID x_coordinate_id;
+  VALUE hash;
 
-  Check_Type(in_private_key_data, T_STRING);
-  TypedData_Get_Struct(self, Context, &Context_DataType, context);
-
-  if (RSTRING_LEN(in_private_key_data) != 32)
+  if (!kwarg_id)
   {
-    rb_raise(Secp256k1_Error_class, "private key data must be 32 bytes in length");
+    CONST_ID(kwarg_id, "hash");
+    CONST_ID(sha256_id, "sha256");
+    CONST_ID(x_coordinate_id, "x_coordinate");
   }
 
-  private_key_data = (unsigned char*)StringValuePtr(in_private_key_data);
-
-  private_key = PrivateKey_create(private_key_data);
-  public_key = PublicKey_create_from_private_key(context, private_key_data);
+  hash = Qundef;
+  rb_get_kwargs(in_opts, &kwarg_id, 0, 1, &hash);
+  if (hash == Qundef || (SYMBOL_P(hash) && SYM2ID(hash) == sha256_id))
+  {
+    return NULL;
+  }
+  if (SYMBOL_P(hash) && SYM2ID(hash) == x_coordinate_id)
+  {
+    return EcdhHashXCoordinate;
+  }
 
-  return rb_funcall(
-    Secp256k1_KeyPair_class,
-    rb_intern("new"),
-    2,
-    public_key,
-    private_key
+  rb_raise(
+    rb_eArgError,
+    "unsupported hash %"PRIsVALUE" (expected :sha256 or :x_coordinate)",
+    rb_inspect(hash)
   );
 }
 
 /**
- * Computes the ECDSA signature of the data using the secp256k1 elliptic curve.
+ * Compute EC Diffie-Hellman secret in constant time.
  *
- * @param in_private_key [Secp256k1::PrivateKey] private key to use for
- *   signing.
- * @param in_hash32 [String] 32-byte binary string with SHA-256 hash of data.
- * @return [Secp256k1::Signature] signature resulting from signing data.
- * @raise [Secp256k1::Error] if hash is not 32-bytes in length or signature
- *   computation fails.
+ * Creates a new shared secret from public_key and private_key.
+ *
+ * @param point [Secp256k1::PublicKey] public-key representing ECDH point.
+ * @param scalar [Secp256k1::PrivateKey] private-key representing ECDH scalar.
+ * @param hash [Symbol] (Optional) :sha256 (default) for the SHA-256 of the
+ *   compressed shared point, or :x_coordinate for its raw x-coordinate.
+ * @return [Secp256k1::SharedSecret] shared secret
+ * @raise [Secp256k1::Error] If scalar was invalid (zero or caused overflow).
+ * @raise [ArgumentError] if the hash is not supported.
  */
 static VALUE
-Context_sign(VALUE self, VALUE in_private_key, VALUE in_hash32)
+Context_ecdh(int argc, const VALUE *argv, VALUE self)
 {
-  unsigned char *hash32;
-  PrivateKey *private_key;
   Context *context;
-  Signature *signature;
-  VALUE signature_result;
-
-  Check_Type(in_hash32, T_STRING);
+  PublicKey *public_key;
+  PrivateKey *private_key;
+  SharedSecret *shared_secret;
+  EcdhArgs args;
+  unsigned long long start;
+  VALUE point;
+  VALUE scalar;
+  VALUE opts;
+  VALUE result;
 
-  if (RSTRING_LEN(in_hash32) != 32)
-  {
-    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
-  }
+  rb_scan_args(argc, argv, "2:", &point, &scalar, &opts);
+  args.hashfp = EcdhHashOption(opts);
 
   TypedData_Get_Struct(self, Context, &Context_DataType, context);
-  TypedData_Get_Struct(in_private_key, PrivateKey, &PrivateKey_DataType, private_key);
-  hash32 = (unsigned char*)StringValuePtr(in_hash32);
+  TypedData_Get_Struct(point, PublicKey, &PublicKey_DataType, public_key);
+  TypedData_Get_Struct(scalar, PrivateKey, &PrivateKey_DataType, private_key);
 
-  signature_result = Signature_alloc(Secp256k1_Signature_class);
-  TypedData_Get_Struct(signature_result, Signature, &Signature_DataType, signature);
- 
-  // Attempt to sign the hash of the given data
-  if (SUCCESS(SignData(context->ctx,
-                       hash32,
-                       private_key->data,
-                       &(signature->sig))))
+  args.ctx = context->ctx;
+  args.pubkey = public_key->pubkey;
+  MEMCPY(args.private_key, private_key->data, unsigned char, 32);
+
+  start = StatsStart(context);
+  WithoutGVL(Ecdh_without_gvl, &args);
+  StatsRecord(context, STATS_ECDH, 1, args.result != 1, start);
+
+  if (args.result != 1)
   {
-    return signature_result;
+    rb_raise(Secp256k1_Error_class, "invalid scalar provided to ecdh");
   }
 
-  rb_raise(Secp256k1_Error_class, "unable to compute signature");
+  result = SharedSecret_alloc(Secp256k1_SharedSecret_class);
+  TypedData_Get_Struct(
+    result, SharedSecret, &SharedSecret_DataType, shared_secret
+  );
+  MEMCPY(shared_secret->data, args.output, unsigned char, 32);
+
+  return result;
 }
 
 /**
- * Verifies that signature matches public key and data.
+ * Computes the EC Diffie-Hellman secrets of one private key with many public
+ * keys.
  *
- * @param in_signature [Secp256k1::Signature] signature to be verified.
- * @param in_pubkey [Secp256k1::PublicKey] public key to verify signature
- *   against.
- * @param in_hash32 [String] 32-byte binary string containing SHA-256 hash of
- *   data.
- * @return [Boolean] True if the signature is valid, false otherwise.
- * @raise [Secp256k1::Error] if hash is not 32-bytes in length.
+ * No Ruby object is created per public key. The GVL is released once for the
+ * whole batch, which is split across the context's workers.
+ *
+ * @param scalar [Secp256k1::PrivateKey] private key shared by every exchange.
+ * @param points [Array<Secp256k1::PublicKey>, Secp256k1::PublicKeyArray]
+ *   public keys to exchange with.
+ * @param hash [Symbol] (Optional) :sha256 (default) or :x_coordinate, as in
+ *   {#ecdh}.
+ * @return [String] binary string of 32-byte shared secrets concatenated in the
+ *   same order as the public keys.
+ * @raise [Secp256k1::Error] if the scalar was invalid.
+ * @raise [ArgumentError] if the hash is not supported.
  */
 static VALUE
-Context_verify(VALUE self, VALUE in_signature, VALUE in_pubkey, VALUE in_hash32)
+Context_ecdh_batch(int argc, const VALUE *argv, VALUE self)
 {
   Context *context;
-  PublicKey *public_key;
-  Signature *signature;
-  unsigned char *hash32;
+  PrivateKey *private_key;
+  EcdhBatchArgs args;
+  secp256k1_pubkey *pubkeys;
+  VALUE pubkeys_buffer;
+  VALUE results_buffer;
+  VALUE scalar;
+  VALUE points;
+  VALUE opts;
+  VALUE result;
+  unsigned long long start;
+  long failures;
+  long count;
+  long i;
+
+  rb_scan_args(argc, argv, "2:", &scalar, &points, &opts);
+  args.hashfp = EcdhHashOption(opts);
+  count = PublicKeysLength(points);
 
-  Check_Type(in_hash32, T_STRING);
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  TypedData_Get_Struct(scalar, PrivateKey, &PrivateKey_DataType, private_key);
 
-  if (RSTRING_LEN(in_hash32) != 32)
+  pubkeys = ALLOCV_N(secp256k1_pubkey, pubkeys_buffer, count);
+  for (i = 0; i < count; i++)
   {
-    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32-bytes in length");
+    pubkeys[i] = *PublicKeysEntry(points, i);
   }
 
-  TypedData_Get_Struct(self, Context, &Context_DataType, context);
-  TypedData_Get_Struct(in_pubkey, PublicKey, &PublicKey_DataType, public_key);
-  TypedData_Get_Struct(in_signature, Signature, &Signature_DataType, signature);
+  result = rb_str_new(NULL, count * 32);
 
-  hash32 = (unsigned char*)StringValuePtr(in_hash32);
-  
-  if (secp256k1_ecdsa_verify(context->ctx,
-                             &(signature->sig),
-                             hash32,
-                             &(public_key->pubkey)) == 1)
+  args.ctx = context->ctx;
+  args.pubkeys = pubkeys;
+  args.output = (unsigned char*)RSTRING_PTR(result);
+  args.results = ALLOCV_N(int, results_buffer, count);
+  MEMCPY(args.private_key, private_key->data, unsigned char, 32);
+
+  start = StatsStart(context);
+  RunBatch(context, EcdhBatch_range, &args, count);
+
+  failures = 0;
+  for (i = 0; i < count; i++)
   {
-    return Qtrue;
+    failures += args.results[i] != 1;
   }
+  StatsRecord(context, STATS_ECDH, count, failures, start);
 
-  return Qfalse;
+  if (failures > 0)
+  {
+    rb_raise(Secp256k1_Error_class, "invalid scalar provided to ecdh");
+  }
+
+  ALLOCV_END(results_buffer);
+  ALLOCV_END(pubkeys_buffer);
+
+  return result;
 }
 
-// Context recoverable signature methods
-#ifdef HAVE_SECP256K1_RECOVERY_H
+#endif // HAVE_SECP256K1_ECDH_H
+
+// Context Schnorr signature methods
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
 
 /**
- * Computes the recoverable ECDSA signature of data signed with private key.
+ * Computes the BIP-340 Schnorr signature of a 32-byte message.
  *
  * @param in_private_key [Secp256k1::PrivateKey] private key to sign with.
- * @param in_hash32 [String] 32-byte binary string with SHA-256 hash of data.
- * @return [Secp256k1::RecoverableSignature] recoverable signature produced by
- *   signing the SHA-256 hash `in_hash32` with `in_private_key`.
- * @raise [Secp256k1::Error] if the hash is not 32 bytes or signature could not
- *   be computed.
+ * @param in_message32 [String, IO::Buffer] 32-byte message, usually a tagged
+ *   hash as described in BIP-340.
+ * @param aux_rand [String] (Optional) 32 bytes of fresh randomness mixed into
+ *   the nonce as recommended by BIP-340. If omitted the nonce is derived from
+ *   the private key and message alone.
+ * @return [String] 64-byte binary string containing the signature.
+ * @raise [Secp256k1::Error] if the message or aux_rand is not 32 bytes, or the
+ *   signature could not be computed.
  */
 static VALUE
-Context_sign_recoverable(VALUE self, VALUE in_private_key, VALUE in_hash32)
+Context_sign_schnorr(int argc, const VALUE *argv, VALUE self)
 {
   Context *context;
   PrivateKey *private_key;
-  RecoverableSignature *recoverable_signature;
-  unsigned char *hash32;
-  VALUE result;
+  SchnorrSignArgs args;
+  unsigned char message32_scratch[32];
+  const unsigned char *message32;
+  long message32_len;
+  unsigned long long start;
+  VALUE in_private_key;
+  VALUE in_message32;
+  VALUE opts;
+  VALUE aux_rand;
+  static ID kwarg_ids;
 
-  Check_Type(in_hash32, T_STRING);
-  if (RSTRING_LEN(in_hash32) != 32)
+  aux_rand = Qundef;
+  if (!kwarg_ids)
   {
-    rb_raise(Secp256k1_Error_class, "in_hash32 is not 32 bytes in length");
+    CONST_ID(kwarg_ids, "aux_rand");
   }
 
-  TypedData_Get_Struct(self, Context, &Context_DataType, context);
-  TypedData_Get_Struct(
-    in_private_key, PrivateKey, &PrivateKey_DataType, private_key
-  );
-  hash32 = (unsigned char*)StringValuePtr(in_hash32);
+  rb_scan_args(argc, argv, "2:", &in_private_key, &in_message32, &opts);
+  rb_get_kwargs(opts, &kwarg_ids, 0, 1, &aux_rand);
 
-  result = RecoverableSignature_alloc(Secp256k1_RecoverableSignature_class);
-  TypedData_Get_Struct(
-    result,
-    RecoverableSignature,
-    &RecoverableSignature_DataType,
-    recoverable_signature
+  message32 = InputBytes(
+    in_message32, message32_scratch, 32, &message32_len
   );
+  if (message32_len != 32)
+  {
+    rb_raise(Secp256k1_Error_class, "in_message32 is not 32 bytes in length");
+  }
+
+  args.has_aux_rand = aux_rand != Qundef && !NIL_P(aux_rand);
+  if (args.has_aux_rand)
+  {
+    Check_Type(aux_rand, T_STRING);
+    if (RSTRING_LEN(aux_rand) != 32)
+    {
+      rb_raise(Secp256k1_Error_class, "aux_rand must be 32 bytes in length");
+    }
+    MEMCPY(args.aux_rand32, RSTRING_PTR(aux_rand), unsigned char, 32);
+  }
+
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_SIGN);
+  TypedData_Get_Struct(in_private_key, PrivateKey, &PrivateKey_DataType, private_key);
 
-  if (SUCCESS(RecoverableSignData(context->ctx,
-                                  hash32,
-                                  private_key->data,
-                                  &(recoverable_signature->sig))))
+  args.ctx = context->ctx;
+  MEMCPY(args.message32, message32, unsigned char, 32);
+  MEMCPY(args.private_key, private_key->data, unsigned char, 32);
+
+  start = StatsStart(context);
+  WithoutGVL(SchnorrSign_without_gvl, &args);
+  StatsRecord(context, STATS_SIGN_SCHNORR, 1, args.result != 1, start);
+
+  if (args.result != 1)
   {
-    recoverable_signature->ctx = secp256k1_context_clone(context->ctx);
-    return result;
+    rb_raise(Secp256k1_Error_class, "unable to compute schnorr signature");
   }
 
-  rb_raise(Secp256k1_Error_class, "unable to compute recoverable signature");
+  return rb_str_new((char*)args.signature, 64);
 }
 
 /**
- * Loads recoverable signature from compact representation and recovery ID.
+ * Copies the inputs of a Schnorr signature verification out of Ruby objects.
  *
- * @param in_compact_sig [String] binary string containing compact signature
- *   data.
- * @param in_recovery_id [Integer] recovery ID (range [0, 3])
- * @return [Secp256k1::RecoverableSignature] signature parsed from data.
- * @raise [Secp256k1::DeserializationError] if signature data or recovery ID is
- *   invalid.
- * @raise [Secp256k1::Error] if compact signature is not 64 bytes or recovery ID
- *   is not in range [0, 3].
+ * \param out_args arguments to be filled in
+ * \param in_signature 64-byte signature String, IO::Buffer, or memory view
+ * \param in_pubkey Secp256k1::XOnlyPublicKey to verify against
+ * \param in_message32 32-byte message String, IO::Buffer, or memory view
+ * \raise Secp256k1::Error if the signature or message has the wrong length
  */
-static VALUE
-Context_recoverable_signature_from_compact(
-  VALUE self, VALUE in_compact_sig, VALUE in_recovery_id)
+static void
+SchnorrVerifyArgs_init(SchnorrVerifyArgs *out_args,
+                       VALUE in_signature,
+                       VALUE in_pubkey,
+                       VALUE in_message32)
 {
-  Context *context;
-  RecoverableSignature *recoverable_signature;
-  unsigned char *compact_sig;
-  int recovery_id;
-  VALUE result;
-
-  Check_Type(in_compact_sig, T_STRING);
-  Check_Type(in_recovery_id, T_FIXNUM);
-  TypedData_Get_Struct(self, Context, &Context_DataType, context);
-
-  compact_sig = (unsigned char*)StringValuePtr(in_compact_sig);
-  recovery_id = FIX2INT(in_recovery_id);
-
-  if (RSTRING_LEN(in_compact_sig) != 64)
+  XOnlyPublicKey *x_only_public_key;
+  unsigned char signature_scratch[64];
+  unsigned char message32_scratch[32];
+  const unsigned char *data;
+  long data_len;
+
+  data = InputBytes(in_signature, signature_scratch, 64, &data_len);
+  if (data_len != 64)
   {
-    rb_raise(Secp256k1_Error_class, "compact signature is not 64 bytes");
+    rb_raise(Secp256k1_Error_class, "schnorr signature must be 64 bytes");
   }
+  MEMCPY(out_args->signature, data, unsigned char, 64);
 
-  if (recovery_id < 0 || recovery_id > 3)
+  data = InputBytes(in_message32, message32_scratch, 32, &data_len);
+  if (data_len != 32)
   {
-    rb_raise(Secp256k1_Error_class, "invalid recovery ID, must be in range [0, 3]");
+    rb_raise(Secp256k1_Error_class, "in_message32 is not 32 bytes in length");
   }
+  MEMCPY(out_args->message32, data, unsigned char, 32);
 
-  result = RecoverableSignature_alloc(Secp256k1_RecoverableSignature_class);
   TypedData_Get_Struct(
-    result,
-    RecoverableSignature,
-    &RecoverableSignature_DataType,
-    recoverable_signature
+    in_pubkey, XOnlyPublicKey, &XOnlyPublicKey_DataType, x_only_public_key
   );
-
-  if (secp256k1_ecdsa_recoverable_signature_parse_compact(
-        secp256k1_context_no_precomp,
-        &(recoverable_signature->sig),
-        compact_sig,
-        recovery_id) == 1)
-  {
-    recoverable_signature->ctx = secp256k1_context_clone(context->ctx);
-    return result;
-  }
-  
-  rb_raise(Secp256k1_DeserializationError_class, "unable to parse recoverable signature");
+  out_args->pubkey = x_only_public_key->pubkey;
+  out_args->result = 0;
 }
 
-#endif // HAVE_SECP256K1_RECOVERY_H
+/**
+ * Verifies a BIP-340 Schnorr signature against an x-only public key.
+ *
+ * @param in_signature [String, IO::Buffer] 64-byte signature.
+ * @param in_pubkey [Secp256k1::XOnlyPublicKey] x-only public key to verify
+ *   the signature against.
+ * @param in_message32 [String, IO::Buffer] 32-byte message that was signed.
+ * @return [Boolean] true if the signature is valid, false otherwise.
+ * @raise [Secp256k1::Error] if the signature is not 64 bytes or the message
+ *   is not 32 bytes.
+ */
+static VALUE
+Context_verify_schnorr(VALUE self,
+                       VALUE in_signature,
+                       VALUE in_pubkey,
+                       VALUE in_message32)
+{
+  Context *context;
+  SchnorrVerifyArgs args;
+  unsigned long long start;
 
-// Context EC Diffie-Hellman methods
-#ifdef HAVE_SECP256K1_ECDH_H
+  TypedData_Get_Struct(self, Context, &Context_DataType, context);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
+  SchnorrVerifyArgs_init(&args, in_signature, in_pubkey, in_message32);
+  args.ctx = context->ctx;
+
+  start = StatsStart(context);
+  WithoutGVL(SchnorrVerify_without_gvl, &args);
+  StatsRecord(context, STATS_VERIFY_SCHNORR, 1, args.result != 1, start);
+
+  return args.result == 1 ? Qtrue : Qfalse;
+}
 
 /**
- * Compute EC Diffie-Hellman secret in constant time.
+ * Verifies many BIP-340 Schnorr signatures in a single call.
  *
- * Creates a new shared secret from public_key and private_key.
+ * Entries at the same index in each array are verified together, exactly as
+ * if they had been passed to {#verify_schnorr}. The GVL is released once for
+ * the whole batch and large batches are split across the context's workers.
  *
- * @param point [Secp256k1::PublicKey] public-key representing ECDH point.
- * @param scalar [Secp256k1::PrivateKey] private-key representing ECDH scalar.
- * @return [Secp256k1::SharedSecret] shared secret
- * @raise [Secp256k1::Error] If scalar was invalid (zero or caused overflow).
+ * @param in_signatures [Array<String>] 64-byte signatures to verify.
+ * @param in_pubkeys [Array<Secp256k1::XOnlyPublicKey>] x-only public keys to
+ *   verify signatures against.
+ * @param in_messages [Array<String>] 32-byte messages that were signed.
+ * @return [Array<Boolean>] true for each valid signature and false for each
+ *   invalid one, in the same order as the signatures.
+ * @raise [Secp256k1::Error] if the arrays differ in length, a signature is not
+ *   64 bytes, or a message is not 32 bytes.
  */
 static VALUE
-Context_ecdh(VALUE self, VALUE point, VALUE scalar)
+Context_verify_schnorr_batch(VALUE self,
+                             VALUE in_signatures,
+                             VALUE in_pubkeys,
+                             VALUE in_messages)
 {
   Context *context;
-  PublicKey *public_key;
-  PrivateKey *private_key;
-  SharedSecret *shared_secret;
+  SchnorrVerifyBatchArgs args;
+  VALUE items_buffer;
   VALUE result;
-
+  unsigned long long start;
+  long failures;
+  long count;
+  long i;
+
+  Check_Type(in_signatures, T_ARRAY);
+  Check_Type(in_pubkeys, T_ARRAY);
+  Check_Type(in_messages, T_ARRAY);
   TypedData_Get_Struct(self, Context, &Context_DataType, context);
-  TypedData_Get_Struct(point, PublicKey, &PublicKey_DataType, public_key);
-  TypedData_Get_Struct(scalar, PrivateKey, &PrivateKey_DataType, private_key);
+  RequireCapability(context, SECP256K1_FLAGS_BIT_CONTEXT_VERIFY);
 
-  result = SharedSecret_alloc(Secp256k1_SharedSecret_class);
-  TypedData_Get_Struct(
-    result, SharedSecret, &SharedSecret_DataType, shared_secret
-  );
+  count = RARRAY_LEN(in_signatures);
+  if (RARRAY_LEN(in_pubkeys) != count || RARRAY_LEN(in_messages) != count)
+  {
+    rb_raise(
+      Secp256k1_Error_class,
+      "signatures, public keys, and messages must have the same length"
+    );
+  }
 
-  if (secp256k1_ecdh(context->ctx,
-                     shared_secret->data,
-                     &(public_key->pubkey),
-                     (unsigned char*)private_key->data,
-                     NULL,
-                     NULL) != 1)
+  args.items = ALLOCV_N(SchnorrVerifyArgs, items_buffer, count);
+  for (i = 0; i < count; i++)
   {
-    rb_raise(Secp256k1_Error_class, "invalid scalar provided to ecdh");
+    SchnorrVerifyArgs_init(
+      &(args.items[i]),
+      rb_ary_entry(in_signatures, i),
+      rb_ary_entry(in_pubkeys, i),
+      rb_ary_entry(in_messages, i)
+    );
+    args.items[i].ctx = context->ctx;
   }
 
-  rb_iv_set(result, "@data", rb_str_new((char*)shared_secret->data, 32));
+  args.ctx = context->ctx;
+  start = StatsStart(context);
+  RunBatch(context, SchnorrVerifyBatch_range, &args, count);
+  if (context->stats != NULL)
+  {
+    failures = 0;
+    for (i = 0; i < count; i++)
+    {
+      failures += args.items[i].result != 1;
+    }
+    StatsRecord(context, STATS_VERIFY_SCHNORR, count, failures, start);
+  }
+
+  result = rb_ary_new2(count);
+  for (i = 0; i < count; i++)
+  {
+    rb_ary_push(result, args.items[i].result == 1 ? Qtrue : Qfalse);
+  }
+
+  ALLOCV_END(items_buffer);
 
   return result;
 }
 
-#endif // HAVE_SECP256K1_ECDH_H
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
 
 //
 // Secp256k1 module methods
@@ -1521,12 +8639,42 @@ Secp256k1_have_ecdh(VALUE module)
 #endif // HAVE_SECP256K1_ECDH_H
 }
 
+/**
+ * Indicates whether or not the libsecp256k1 Schnorr signature module is
+ * installed.
+ *
+ * @return [Boolean] true if libsecp256k1 was built with the extrakeys and
+ *   schnorrsig modules, false otherwise.
+ */
+static VALUE
+Secp256k1_have_schnorrsig(VALUE module)
+{
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+  return Qtrue;
+#else // HAVE_SECP256K1_SCHNORRSIG_H
+  return Qfalse;
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
+}
+
 //
 // Library initialization
 //
 
 void Init_rbsecp256k1()
 {
+#ifdef HAVE_SECP256K1_SELFTEST
+  // Parsing and serialization use the static context without a context
+  // having been created first, which libsecp256k1 only allows after its
+  // self-test. The self-test aborts the process if the library is miscompiled.
+  secp256k1_selftest();
+#endif // HAVE_SECP256K1_SELFTEST
+
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  // Classes are only defined here and objects never write to themselves once
+  // frozen, so the extension can be used from any Ractor.
+  rb_ext_ractor_safe(true);
+#endif // HAVE_RB_EXT_RACTOR_SAFE
+
   // Secp256k1
   Secp256k1_module = rb_define_module("Secp256k1");
   rb_define_singleton_method(
@@ -1541,6 +8689,12 @@ void Init_rbsecp256k1()
     Secp256k1_have_ecdh,
     0
   );
+  rb_define_singleton_method(
+    Secp256k1_module,
+    "have_schnorrsig?",
+    Secp256k1_have_schnorrsig,
+    0
+  );
 
   // Secp256k1 exception hierarchy
   Secp256k1_Error_class = rb_define_class_under(
@@ -1567,14 +8721,89 @@ void Init_rbsecp256k1()
                    "key_pair_from_private_key",
                    Context_key_pair_from_private_key,
                    1);
+  rb_define_method(Secp256k1_Context_class,
+                   "key_pairs_from_private_key_data",
+                   Context_key_pairs_from_private_key_data,
+                   1);
   rb_define_method(Secp256k1_Context_class,
                    "sign",
                    Context_sign,
-                   2);
+                   -1);
   rb_define_method(Secp256k1_Context_class,
                    "verify",
                    Context_verify,
                    3);
+  rb_define_method(Secp256k1_Context_class,
+                   "sign_message",
+                   Context_sign_message,
+                   -1);
+  rb_define_method(Secp256k1_Context_class,
+                   "verify_message",
+                   Context_verify_message,
+                   -1);
+  rb_define_method(Secp256k1_Context_class,
+                   "verify_batch",
+                   Context_verify_batch,
+                   -1);
+  rb_define_method(Secp256k1_Context_class,
+                   "verify_packed",
+                   Context_verify_packed,
+                   -1);
+  rb_define_method(Secp256k1_Context_class,
+                   "sign_batch",
+                   Context_sign_batch,
+                   2);
+  rb_define_method(Secp256k1_Context_class,
+                   "public_keys_from_private_keys",
+                   Context_public_keys_from_private_keys,
+                   1);
+  rb_define_method(Secp256k1_Context_class,
+                   "tweak_add_private_key",
+                   Context_tweak_add_private_key,
+                   2);
+  rb_define_method(Secp256k1_Context_class,
+                   "tweak_mul_private_key",
+                   Context_tweak_mul_private_key,
+                   2);
+  rb_define_method(Secp256k1_Context_class,
+                   "tweak_add_public_key",
+                   Context_tweak_add_public_key,
+                   2);
+  rb_define_method(Secp256k1_Context_class,
+                   "tweak_mul_public_key",
+                   Context_tweak_mul_public_key,
+                   2);
+  rb_define_method(Secp256k1_Context_class,
+                   "combine_public_keys",
+                   Context_combine_public_keys,
+                   1);
+  rb_define_method(Secp256k1_Context_class,
+                   "derive_children",
+                   Context_derive_children,
+                   2);
+  rb_define_method(Secp256k1_Context_class,
+                   "workers",
+                   Context_workers,
+                   0);
+  rb_define_method(Secp256k1_Context_class,
+                   "capabilities",
+                   Context_capabilities,
+                   0);
+  rb_define_method(Secp256k1_Context_class,
+                   "randomize",
+                   Context_randomize,
+                   1);
+  rb_define_method(Secp256k1_Context_class,
+                   "stats",
+                   Context_stats,
+                   0);
+  rb_define_method(Secp256k1_Context_class,
+                   "reset_stats",
+                   Context_reset_stats,
+                   0);
+  rb_define_const(Secp256k1_Context_class,
+                  "VERIFY_PACKED_RECORD_SIZE",
+                  INT2FIX(VERIFY_PACKED_RECORD_SIZE));
 
   // Secp256k1::KeyPair
   Secp256k1_KeyPair_class = rb_define_class_under(Secp256k1_module,
@@ -1582,13 +8811,20 @@ void Init_rbsecp256k1()
                                                   rb_cObject);
   rb_undef_alloc_func(Secp256k1_KeyPair_class);
   rb_define_alloc_func(Secp256k1_KeyPair_class, KeyPair_alloc);
-  rb_define_attr(Secp256k1_KeyPair_class, "public_key", 1, 0);
-  rb_define_attr(Secp256k1_KeyPair_class, "private_key", 1, 0);
+  rb_define_method(
+    Secp256k1_KeyPair_class, "public_key", KeyPair_public_key, 0
+  );
+  rb_define_method(
+    Secp256k1_KeyPair_class, "private_key", KeyPair_private_key, 0
+  );
   rb_define_method(Secp256k1_KeyPair_class,
                    "initialize",
                    KeyPair_initialize,
                    2);
   rb_define_method(Secp256k1_KeyPair_class, "==", KeyPair_equals, 1);
+  rb_define_method(Secp256k1_KeyPair_class, "eql?", KeyPair_eql, 1);
+  rb_define_method(Secp256k1_KeyPair_class, "hash", KeyPair_hash, 0);
+  rb_define_method(Secp256k1_KeyPair_class, "freeze", KeyPair_freeze, 0);
 
   // Secp256k1::PublicKey
   Secp256k1_PublicKey_class = rb_define_class_under(Secp256k1_module,
@@ -1604,6 +8840,14 @@ void Init_rbsecp256k1()
                    "uncompressed",
                    PublicKey_uncompressed,
                    0);
+  rb_define_method(Secp256k1_PublicKey_class,
+                   "write_compressed",
+                   PublicKey_write_compressed,
+                   -1);
+  rb_define_method(Secp256k1_PublicKey_class,
+                   "write_uncompressed",
+                   PublicKey_write_uncompressed,
+                   -1);
   rb_define_singleton_method(
     Secp256k1_PublicKey_class,
     "from_data",
@@ -1611,6 +8855,39 @@ void Init_rbsecp256k1()
     1
   );
   rb_define_method(Secp256k1_PublicKey_class, "==", PublicKey_equals, 1);
+  rb_define_method(Secp256k1_PublicKey_class, "eql?", PublicKey_eql, 1);
+  rb_define_method(Secp256k1_PublicKey_class, "hash", PublicKey_hash, 0);
+  rb_define_method(Secp256k1_PublicKey_class, "freeze", PublicKey_freeze, 0);
+
+  // Secp256k1::PublicKeyArray
+  Secp256k1_PublicKeyArray_class = rb_define_class_under(
+    Secp256k1_module, "PublicKeyArray", rb_cObject
+  );
+  rb_include_module(Secp256k1_PublicKeyArray_class, rb_mEnumerable);
+  rb_define_alloc_func(Secp256k1_PublicKeyArray_class, PublicKeyArray_alloc);
+  rb_define_method(Secp256k1_PublicKeyArray_class,
+                   "initialize",
+                   PublicKeyArray_initialize,
+                   -1);
+  rb_define_method(Secp256k1_PublicKeyArray_class, "<<", PublicKeyArray_push, 1);
+  rb_define_method(Secp256k1_PublicKeyArray_class,
+                   "append_compressed",
+                   PublicKeyArray_append_compressed,
+                   1);
+  rb_define_method(Secp256k1_PublicKeyArray_class,
+                   "append_uncompressed",
+                   PublicKeyArray_append_uncompressed,
+                   1);
+  rb_define_method(Secp256k1_PublicKeyArray_class, "[]", PublicKeyArray_aref, 1);
+  rb_define_method(Secp256k1_PublicKeyArray_class, "size", PublicKeyArray_size, 0);
+  rb_define_method(
+    Secp256k1_PublicKeyArray_class, "length", PublicKeyArray_size, 0
+  );
+  rb_define_method(Secp256k1_PublicKeyArray_class, "each", PublicKeyArray_each, 0);
+  rb_define_singleton_method(
+    Secp256k1_PublicKeyArray_class, "load", PublicKeyArray_load, -1
+  );
+  rb_define_method(Secp256k1_PublicKeyArray_class, "dump", PublicKeyArray_dump, 1);
 
   // Secp256k1::PrivateKey
   Secp256k1_PrivateKey_class = rb_define_class_under(
@@ -1618,8 +8895,10 @@ void Init_rbsecp256k1()
   );
   rb_undef_alloc_func(Secp256k1_PrivateKey_class);
   rb_define_alloc_func(Secp256k1_PrivateKey_class, PrivateKey_alloc);
-  rb_define_attr(Secp256k1_PrivateKey_class, "data", 1, 0);
+  rb_define_method(Secp256k1_PrivateKey_class, "data", PrivateKey_data, 0);
   rb_define_method(Secp256k1_PrivateKey_class, "==", PrivateKey_equals, 1);
+  rb_define_method(Secp256k1_PrivateKey_class, "eql?", PrivateKey_eql, 1);
+  rb_define_method(Secp256k1_PrivateKey_class, "hash", PrivateKey_hash, 0);
   rb_define_singleton_method(
     Secp256k1_PrivateKey_class,
     "from_data",
@@ -1641,26 +8920,88 @@ void Init_rbsecp256k1()
                    "compact",
                    Signature_compact,
                    0);
+  rb_define_method(Secp256k1_Signature_class,
+                   "write_der_encoded",
+                   Signature_write_der_encoded,
+                   -1);
+  rb_define_method(Secp256k1_Signature_class,
+                   "write_compact",
+                   Signature_write_compact,
+                   -1);
   rb_define_method(Secp256k1_Signature_class,
                    "normalized",
                    Signature_normalized,
                    0);
+  rb_define_method(Secp256k1_Signature_class,
+                   "low_s?",
+                   Signature_low_s,
+                   0);
   rb_define_method(Secp256k1_Signature_class,
                    "==",
                    Signature_equals,
                    1);
+  rb_define_method(Secp256k1_Signature_class,
+                   "eql?",
+                   Signature_eql,
+                   1);
+  rb_define_method(Secp256k1_Signature_class,
+                   "hash",
+                   Signature_hash,
+                   0);
   rb_define_singleton_method(
     Secp256k1_Signature_class,
     "from_compact",
     Signature_from_compact,
-    1
+    -1
   );
   rb_define_singleton_method(
     Secp256k1_Signature_class,
     "from_der_encoded",
     Signature_from_der_encoded,
-    1
+    -1
+  );
+  rb_define_singleton_method(
+    Secp256k1_Signature_class,
+    "each_der_encoded",
+    Signature_each_der_encoded,
+    -1
+  );
+  rb_define_singleton_method(
+    Secp256k1_Signature_class,
+    "der_encoded_to_compact",
+    Signature_der_encoded_to_compact,
+    -1
+  );
+
+  // Secp256k1::SignatureArray
+  Secp256k1_SignatureArray_class = rb_define_class_under(
+    Secp256k1_module, "SignatureArray", rb_cObject
+  );
+  rb_include_module(Secp256k1_SignatureArray_class, rb_mEnumerable);
+  rb_define_alloc_func(Secp256k1_SignatureArray_class, SignatureArray_alloc);
+  rb_define_method(Secp256k1_SignatureArray_class,
+                   "initialize",
+                   SignatureArray_initialize,
+                   -1);
+  rb_define_method(Secp256k1_SignatureArray_class, "<<", SignatureArray_push, 1);
+  rb_define_method(Secp256k1_SignatureArray_class,
+                   "append_compact",
+                   SignatureArray_append_compact,
+                   1);
+  rb_define_method(Secp256k1_SignatureArray_class,
+                   "append_der_encoded",
+                   SignatureArray_append_der_encoded,
+                   -1);
+  rb_define_method(Secp256k1_SignatureArray_class, "[]", SignatureArray_aref, 1);
+  rb_define_method(Secp256k1_SignatureArray_class, "size", SignatureArray_size, 0);
+  rb_define_method(
+    Secp256k1_SignatureArray_class, "length", SignatureArray_size, 0
+  );
+  rb_define_method(Secp256k1_SignatureArray_class, "each", SignatureArray_each, 0);
+  rb_define_singleton_method(
+    Secp256k1_SignatureArray_class, "load", SignatureArray_load, -1
   );
+  rb_define_method(Secp256k1_SignatureArray_class, "dump", SignatureArray_dump, 1);
 
 #ifdef HAVE_SECP256K1_RECOVERY_H
   // Secp256k1::RecoverableSignature
@@ -1680,6 +9021,12 @@ void Init_rbsecp256k1()
     RecoverableSignature_compact,
     0
   );
+  rb_define_method(
+    Secp256k1_RecoverableSignature_class,
+    "write_compact",
+    RecoverableSignature_write_compact,
+    -1
+  );
   rb_define_method(
     Secp256k1_RecoverableSignature_class,
     "to_signature",
@@ -1698,13 +9045,31 @@ void Init_rbsecp256k1()
     RecoverableSignature_equals,
     1
   );
+  rb_define_method(
+    Secp256k1_RecoverableSignature_class,
+    "eql?",
+    RecoverableSignature_eql,
+    1
+  );
+  rb_define_method(
+    Secp256k1_RecoverableSignature_class,
+    "hash",
+    RecoverableSignature_hash,
+    0
+  );
 
   // Context recoverable signature methods
   rb_define_method(
     Secp256k1_Context_class,
     "sign_recoverable",
     Context_sign_recoverable,
-    2
+    -1
+  );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "recover_message",
+    Context_recover_message,
+    -1
   );
   rb_define_method(
     Secp256k1_Context_class,
@@ -1712,6 +9077,29 @@ void Init_rbsecp256k1()
     Context_recoverable_signature_from_compact,
     2
   );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "recover_batch",
+    Context_recover_batch,
+    2
+  );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "recover_packed",
+    Context_recover_packed,
+    1
+  );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "recover_public_keys_batch",
+    Context_recover_public_keys_batch,
+    3
+  );
+  rb_define_const(
+    Secp256k1_Context_class,
+    "RECOVER_PACKED_RECORD_SIZE",
+    INT2FIX(RECOVER_PACKED_RECORD_SIZE)
+  );
 #endif // HAVE_SECP256K1_RECOVERY_H
 
 #ifdef HAVE_SECP256K1_ECDH_H
@@ -1722,14 +9110,89 @@ void Init_rbsecp256k1()
   );
   rb_undef_alloc_func(Secp256k1_SharedSecret_class);
   rb_define_alloc_func(Secp256k1_SharedSecret_class, SharedSecret_alloc);
-  rb_define_attr(Secp256k1_SharedSecret_class, "data", 1, 0);
+  rb_define_method(
+    Secp256k1_SharedSecret_class, "data", SharedSecret_data, 0
+  );
 
   // Context EC Diffie-Hellman methods
   rb_define_method(
     Secp256k1_Context_class,
     "ecdh",
     Context_ecdh,
-    2
+    -1
+  );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "ecdh_batch",
+    Context_ecdh_batch,
+    -1
   );
 #endif // HAVE_SECP256K1_ECDH_H
+
+#ifdef HAVE_SECP256K1_SCHNORRSIG_H
+  // Secp256k1::XOnlyPublicKey
+  Secp256k1_XOnlyPublicKey_class = rb_define_class_under(
+    Secp256k1_module,
+    "XOnlyPublicKey",
+    rb_cObject
+  );
+  rb_undef_alloc_func(Secp256k1_XOnlyPublicKey_class);
+  rb_define_alloc_func(Secp256k1_XOnlyPublicKey_class, XOnlyPublicKey_alloc);
+  rb_define_singleton_method(
+    Secp256k1_XOnlyPublicKey_class,
+    "from_data",
+    XOnlyPublicKey_from_data,
+    1
+  );
+  rb_define_method(
+    Secp256k1_XOnlyPublicKey_class,
+    "data",
+    XOnlyPublicKey_data,
+    0
+  );
+  rb_define_method(
+    Secp256k1_XOnlyPublicKey_class,
+    "==",
+    XOnlyPublicKey_equals,
+    1
+  );
+  rb_define_method(
+    Secp256k1_XOnlyPublicKey_class,
+    "eql?",
+    XOnlyPublicKey_eql,
+    1
+  );
+  rb_define_method(
+    Secp256k1_XOnlyPublicKey_class,
+    "hash",
+    XOnlyPublicKey_hash,
+    0
+  );
+  rb_define_method(
+    Secp256k1_PublicKey_class,
+    "to_x_only",
+    PublicKey_to_x_only,
+    0
+  );
+
+  // Context Schnorr signature methods
+  rb_define_method(
+    Secp256k1_Context_class,
+    "sign_schnorr",
+    Context_sign_schnorr,
+    -1
+  );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "verify_schnorr",
+    Context_verify_schnorr,
+    3
+  );
+  rb_define_method(
+    Secp256k1_Context_class,
+    "verify_schnorr_batch",
+    Context_verify_schnorr_batch,
+    3
+  );
+#endif // HAVE_SECP256K1_SCHNORRSIG_H
 }
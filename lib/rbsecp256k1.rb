@@ -5,6 +5,7 @@ module Secp256k1
 end
 
 require 'rbsecp256k1/context'
+require 'rbsecp256k1/public_key_cache'
 require 'rbsecp256k1/util'
 require 'rbsecp256k1/version'
 require 'rbsecp256k1/rbsecp256k1'
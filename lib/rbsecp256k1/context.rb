@@ -7,11 +7,72 @@ module Secp256k1
   class Context
     # Create a new randomized context.
     #
+    # @param options [Hash] additional options passed through to {#initialize}
+    #   such as `workers:`.
     # @return [Secp256k1::Context] randomized context
-    def self.create
-      new(context_randomization_bytes: SecureRandom.random_bytes(32))
+    def self.create(**options)
+      new(context_randomization_bytes: SecureRandom.random_bytes(32), **options)
     end
 
+    # Guards lazy creation of the process-wide default context.
+    DEFAULT_CONTEXT_LOCK = Mutex.new
+    private_constant :DEFAULT_CONTEXT_LOCK
+
+    # Returns a process-wide randomized context.
+    #
+    # Build the context before forking, for example by requiring
+    # `rbsecp256k1/preload` while preloading an application, so that its
+    # precomputed tables are shared with every child process through
+    # copy-on-write. Each child should then call {.after_fork}.
+    #
+    # @return [Secp256k1::Context] shared randomized context.
+    def self.default
+      @default || DEFAULT_CONTEXT_LOCK.synchronize do
+        @default ||= create
+      end
+    end
+
+    # Re-randomizes the default context in a freshly forked child process.
+    #
+    # Only the blinding state of the context is rewritten, so its precomputed
+    # tables remain shared with the parent process. Does nothing if the default
+    # context has not been created.
+    #
+    # @return [nil]
+    def self.after_fork
+      @default&.randomize(SecureRandom.random_bytes(32))
+      nil
+    end
+
+    # Guards lazy creation of the shared verification context.
+    VERIFICATION_CONTEXT_LOCK = Mutex.new
+    private_constant :VERIFICATION_CONTEXT_LOCK
+
+    # Returns a process-wide frozen context that can only verify signatures
+    # and recover public keys.
+    #
+    # The context is created on first use and shared by every caller, saving
+    # the cost of building signing tables in verification-only processes. It
+    # is also shareable between Ractors, but must first be created from the
+    # main Ractor since other Ractors cannot create it.
+    #
+    # @return [Secp256k1::Context] shared verification-only context.
+    def self.verification_context
+      @verification_context || VERIFICATION_CONTEXT_LOCK.synchronize do
+        @verification_context ||= make_shareable(new(capabilities: [:verify]))
+      end
+    end
+
+    # Freezes a context, also making it shareable between Ractors where they
+    # are supported.
+    #
+    # @param context [Secp256k1::Context] context to be shared.
+    # @return [Secp256k1::Context] the frozen context.
+    def self.make_shareable(context)
+      defined?(Ractor) ? Ractor.make_shareable(context) : context.freeze
+    end
+    private_class_method :make_shareable
+
     # Create a new non-randomized context.
     #
     # @return [Secp256k1::Context] non-randomized context
@@ -25,5 +86,57 @@ module Secp256k1
     def generate_key_pair
       key_pair_from_private_key(SecureRandom.random_bytes(32))
     end
+
+    # Generates many new random key pairs.
+    #
+    # All private keys are read from the CSPRNG at once and their public keys
+    # are derived in a single batch.
+    #
+    # @param count [Integer] number of key pairs to generate.
+    # @return [Array<Secp256k1::KeyPair>] public-private key pairs.
+    def generate_key_pairs(count)
+      key_pairs_from_private_key_data(SecureRandom.random_bytes(32 * count))
+    end
+
+    # Verifies a batch of signatures on a background thread.
+    #
+    # Waiting for the returned thread with `value` or `join` only suspends the
+    # calling fiber when a fiber scheduler is set, so other fibers keep running
+    # while the batch is verified. The arrays must not be modified until the
+    # thread finishes.
+    #
+    # @param signatures [Array<Secp256k1::Signature>] signatures to verify.
+    # @param public_keys [Array<Secp256k1::PublicKey>] public keys to verify
+    #   signatures against.
+    # @param hashes [Array<String>] 32-byte hashes of signed data.
+    # @param options [Hash] options passed through to {#verify_batch} such as
+    #   `fail_fast:`.
+    # @return [Thread] thread whose value is the result of {#verify_batch}.
+    #   Errors raised by {#verify_batch} are raised when waiting for it.
+    def verify_batch_async(signatures, public_keys, hashes, **options)
+      run_async { verify_batch(signatures, public_keys, hashes, **options) }
+    end
+
+    # Verifies packed records on a background thread.
+    #
+    # See {#verify_batch_async} for how to wait for the result.
+    #
+    # @param records [String, IO::Buffer] buffer of concatenated records.
+    # @param options [Hash] options passed through to {#verify_packed} such as
+    #   `normalize:`.
+    # @return [Thread] thread whose value is the result of {#verify_packed}.
+    def verify_packed_async(records, **options)
+      run_async { verify_packed(records, **options) }
+    end
+
+    private
+
+    def run_async
+      Thread.new do
+        # Errors are raised in the thread waiting for the result instead
+        Thread.current.report_on_exception = false
+        yield
+      end
+    end
   end
 end
@@ -0,0 +1,24 @@
+# frozen_string_literal: true
+
+require 'rbsecp256k1'
+
+module Secp256k1
+  # Re-randomizes the default context in every child process on Rubies that
+  # route all forks through Process._fork (3.1 and later).
+  module ForkHook
+    # Forks the process, re-randomizing the default context in the child.
+    #
+    # @return [Integer] process ID of the child in the parent, 0 in the child.
+    def _fork
+      pid = super
+      Context.after_fork if pid.zero?
+      pid
+    end
+  end
+end
+
+# Build the default context at require time so that preloading servers create
+# its precomputed tables once, before forking workers.
+Secp256k1::Context.default
+
+Process.singleton_class.prepend(Secp256k1::ForkHook) if Process.respond_to?(:_fork)
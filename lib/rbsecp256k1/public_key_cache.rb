@@ -0,0 +1,94 @@
+# frozen_string_literal: true
+
+module Secp256k1
+  # Bounded least-recently-used cache of parsed public keys.
+  #
+  # Parsing a compressed public key decompresses the point, which costs a
+  # square root modulo the field prime. Services that verify many signatures
+  # from a small set of signers can keep those keys parsed by looking them up
+  # here instead of calling {PublicKey.from_data} for every message.
+  #
+  # The cache is safe to share between threads.
+  class PublicKeyCache
+    # Number of public keys kept when no capacity is given.
+    DEFAULT_CAPACITY = 1024
+
+    # @return [Integer] maximum number of public keys kept in the cache.
+    attr_reader :capacity
+
+    # @return [Integer] number of lookups answered from the cache.
+    attr_reader :hits
+
+    # @return [Integer] number of lookups that had to parse the public key.
+    attr_reader :misses
+
+    # @param capacity [Integer] maximum number of public keys to keep. Once
+    #   full, the least recently used key is evicted to make room.
+    # @raise [ArgumentError] if capacity is not positive.
+    def initialize(capacity = DEFAULT_CAPACITY)
+      raise ArgumentError, 'capacity must be positive' unless capacity.positive?
+
+      @capacity = capacity
+      @entries = {}
+      @hits = 0
+      @misses = 0
+      @lock = Mutex.new
+    end
+
+    # Returns the parsed public key for the given serialized bytes.
+    #
+    # Keys are cached by their serialized bytes exactly as given, so look up
+    # each signer in one consistent form, usually the 33-byte compressed one.
+    #
+    # @param public_key_data [String] compressed or uncompressed public key.
+    # @return [Secp256k1::PublicKey] public key parsed from the data.
+    # @raise [Secp256k1::DeserializationError] if the public key data is
+    #   invalid. Invalid data is never cached.
+    def fetch(public_key_data)
+      public_key = @lock.synchronize do
+        # Re-inserting the key marks it as the most recently used
+        found = @entries.delete(public_key_data)
+        if found
+          @hits += 1
+          @entries[public_key_data] = found
+        end
+      end
+      return public_key if public_key
+
+      # Parse outside the lock so concurrent misses do not serialize
+      public_key = PublicKey.from_data(public_key_data)
+      @lock.synchronize do
+        @misses += 1
+        @entries[public_key_data] = public_key
+        @entries.shift while @entries.size > @capacity
+      end
+
+      public_key
+    end
+    alias [] fetch
+
+    # @param public_key_data [String] serialized public key.
+    # @return [Boolean] true if the public key is currently cached.
+    def include?(public_key_data)
+      @lock.synchronize { @entries.key?(public_key_data) }
+    end
+
+    # @return [Integer] number of public keys currently cached.
+    def size
+      @lock.synchronize { @entries.size }
+    end
+
+    # Removes every cached public key and resets the hit and miss counters.
+    #
+    # @return [Secp256k1::PublicKeyCache] this cache.
+    def clear
+      @lock.synchronize do
+        @entries.clear
+        @hits = 0
+        @misses = 0
+      end
+
+      self
+    end
+  end
+end
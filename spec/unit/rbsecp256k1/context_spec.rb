@@ -1,5 +1,6 @@
 # frozen_string_literal: true
 
+require 'openssl'
 require 'spec_helper'
 
 RSpec.describe Secp256k1::Context do
@@ -24,6 +25,222 @@ RSpec.describe Secp256k1::Context do
     it 'allows for 32 bytes of randomness' do
       Secp256k1::Context.new(context_randomization_bytes: SecureRandom.random_bytes(32))
     end
+
+    it 'defaults to a single worker' do
+      expect(Secp256k1::Context.new.workers).to eq(1)
+    end
+
+    it 'allows the number of workers to be set' do
+      expect(Secp256k1::Context.create(workers: 4).workers).to eq(4)
+    end
+
+    it 'raises an error if workers is not positive' do
+      expect do
+        Secp256k1::Context.new(workers: 0)
+      end.to raise_error(Secp256k1::Error, /workers must be in range/)
+    end
+  end
+
+  describe 'capabilities' do
+    let(:hash32) { sha256('capabilities') }
+    let(:signature) { subject.sign(key_pair.private_key, hash32) }
+
+    it 'defaults to signing and verification' do
+      expect(subject.capabilities).to eq(%i[sign verify])
+    end
+
+    it 'verifies signatures with a verification-only context' do
+      context = Secp256k1::Context.create(capabilities: [:verify])
+
+      expect(context.capabilities).to eq([:verify])
+      expect(context.verify(signature, key_pair.public_key, hash32)).to be true
+    end
+
+    it 'raises an error when signing with a verification-only context' do
+      context = Secp256k1::Context.create(capabilities: [:verify])
+
+      expect do
+        context.sign(key_pair.private_key, hash32)
+      end.to raise_error(Secp256k1::Error, 'context was not created with the :sign capability')
+      expect do
+        context.key_pair_from_private_key(key_pair.private_key.data)
+      end.to raise_error(Secp256k1::Error, 'context was not created with the :sign capability')
+    end
+
+    it 'raises an error when verifying with a signing-only context' do
+      context = Secp256k1::Context.create(capabilities: [:sign])
+
+      expect(context.sign(key_pair.private_key, hash32)).to eq(signature)
+      expect do
+        context.verify(signature, key_pair.public_key, hash32)
+      end.to raise_error(Secp256k1::Error, 'context was not created with the :verify capability')
+      expect do
+        context.verify_batch([signature], [key_pair.public_key], [hash32])
+      end.to raise_error(Secp256k1::Error, 'context was not created with the :verify capability')
+    end
+
+    it 'raises an error for unknown capabilities' do
+      expect do
+        Secp256k1::Context.new(capabilities: [:encrypt])
+      end.to raise_error(Secp256k1::Error, 'unknown capability, must be :sign or :verify')
+    end
+  end
+
+  describe '.verification_context' do
+    it 'returns the same frozen verification-only context' do
+      context = Secp256k1::Context.verification_context
+
+      expect(context).to be_frozen
+      expect(context.capabilities).to eq([:verify])
+      expect(Secp256k1::Context.verification_context).to equal(context)
+    end
+
+    it 'verifies signatures' do
+      hash32 = sha256('verification context')
+      signature = subject.sign(key_pair.private_key, hash32)
+
+      expect(
+        Secp256k1::Context.verification_context.verify(
+          signature, key_pair.public_key, hash32
+        )
+      ).to be true
+    end
+
+    if defined?(Ractor)
+      it 'is shareable with other Ractors' do
+        hash32 = sha256('verification context')
+        signature = Ractor.make_shareable(subject.sign(key_pair.private_key, hash32))
+        public_key = Ractor.make_shareable(key_pair.public_key)
+
+        expect(Ractor.shareable?(Secp256k1::Context.verification_context)).to be true
+        ractor = Ractor.new(signature, public_key, hash32) do |sig, pub, message|
+          Secp256k1::Context.verification_context.verify(sig, pub, message)
+        end
+        expect(ractor.respond_to?(:value) ? ractor.value : ractor.take).to be true
+      end
+    end
+  end
+
+  describe '.default' do
+    it 'returns the same randomized context' do
+      context = Secp256k1::Context.default
+
+      expect(context).to be_a(Secp256k1::Context)
+      expect(Secp256k1::Context.default).to equal(context)
+    end
+
+    it 'is shared with forked child processes', if: Process.respond_to?(:fork) do
+      hash32 = sha256('forked')
+      expected = Secp256k1::Context.default.sign(key_pair.private_key, hash32)
+      reader, writer = IO.pipe
+
+      pid = fork do
+        reader.close
+        Secp256k1::Context.after_fork
+        writer.write(
+          Secp256k1::Context.default.sign(key_pair.private_key, hash32).compact
+        )
+        writer.close
+        exit!(0)
+      end
+      writer.close
+      compact = reader.read
+      Process.wait(pid)
+
+      expect(Secp256k1::Signature.from_compact(compact)).to eq(expected)
+    end
+  end
+
+  describe '.after_fork' do
+    it 'returns nil' do
+      Secp256k1::Context.default
+
+      expect(Secp256k1::Context.after_fork).to be_nil
+    end
+  end
+
+  describe '#randomize' do
+    it 'keeps producing the same deterministic signatures' do
+      hash32 = sha256('randomize')
+      signature = subject.sign(key_pair.private_key, hash32)
+
+      expect(subject.randomize(Random.new.bytes(32))).to equal(subject)
+      expect(subject.sign(key_pair.private_key, hash32)).to eq(signature)
+    end
+
+    it 'raises an error if the random data is not 32 bytes' do
+      expect do
+        subject.randomize('test')
+      end.to raise_error(Secp256k1::Error, 'context_randomization_bytes must be 32 bytes in length')
+    end
+
+    it 'raises an error if the context cannot sign' do
+      context = Secp256k1::Context.new(capabilities: [:verify])
+
+      expect do
+        context.randomize(Random.new.bytes(32))
+      end.to raise_error(Secp256k1::Error, 'context was not created with the :sign capability')
+    end
+
+    it 'raises an error if the context is frozen' do
+      expect do
+        Secp256k1::Context.create.freeze.randomize(Random.new.bytes(32))
+      end.to raise_error(FrozenError)
+    end
+  end
+
+  describe '#stats' do
+    let(:context) { Secp256k1::Context.create(stats: true) }
+
+    it 'is nil for contexts created without stats' do
+      expect(subject.stats).to be_nil
+      expect(subject.reset_stats).to be_nil
+    end
+
+    it 'starts with every counter at zero' do
+      expect(context.stats[:sign]).to eq(calls: 0, failures: 0, nanoseconds: 0)
+    end
+
+    it 'counts calls and failures for each operation' do
+      hash32 = sha256(message)
+      signature = context.sign(key_pair.private_key, hash32)
+      context.verify(signature, key_pair.public_key, hash32)
+      context.verify(signature, key_pair.public_key, sha256('bad message'))
+
+      expect(context.stats[:sign]).to include(calls: 1, failures: 0)
+      expect(context.stats[:verify]).to include(calls: 2, failures: 1)
+      expect(context.stats[:verify][:nanoseconds]).to be > 0
+    end
+
+    it 'counts each entry of a batch' do
+      hashes = Array.new(3) { |i| sha256(i.to_s) }
+      signatures = context.sign_batch([key_pair.private_key] * 3, hashes)
+      hashes[1] = sha256('bad message')
+      context.verify_batch(signatures, [key_pair.public_key] * 3, hashes)
+
+      expect(context.stats[:sign]).to include(calls: 3, failures: 0)
+      expect(context.stats[:verify]).to include(calls: 3, failures: 1)
+    end
+
+    it 'counts failed entries of a packed batch' do
+      hash32 = sha256(message)
+      record = context.sign(key_pair.private_key, hash32).compact +
+               key_pair.public_key.compressed
+      context.verify_packed(record + hash32 + record + sha256('bad message'))
+
+      expect(context.stats[:verify]).to include(calls: 2, failures: 1)
+    end
+  end
+
+  describe '#reset_stats' do
+    let(:context) { Secp256k1::Context.create(stats: true) }
+
+    it 'returns the counters and resets them' do
+      context.sign(key_pair.private_key, sha256(message))
+
+      expect(context.reset_stats[:sign]).to include(calls: 1)
+      expect(context.stats[:sign]).to eq(calls: 0, failures: 0, nanoseconds: 0)
+    end
   end
 
   describe '#generate_key_pair' do
@@ -44,6 +261,50 @@ RSpec.describe Secp256k1::Context do
     end
   end
 
+  describe '#generate_key_pairs' do
+    it 'generates the requested number of distinct key pairs' do
+      key_pairs = subject.generate_key_pairs(20)
+
+      expect(key_pairs.length).to eq(20)
+      expect(key_pairs.uniq.length).to eq(20)
+      key_pairs.each do |key_pair|
+        expect(key_pair).to eq(
+          subject.key_pair_from_private_key(key_pair.private_key.data)
+        )
+      end
+    end
+
+    it 'returns an empty array when no key pairs are requested' do
+      expect(subject.generate_key_pairs(0)).to eq([])
+    end
+  end
+
+  describe '#key_pairs_from_private_key_data' do
+    it 'returns a key pair for each private key' do
+      expected = [private_key_data.b, key_pair.private_key.data].map do |data|
+        subject.key_pair_from_private_key(data)
+      end
+
+      expect(
+        subject.key_pairs_from_private_key_data(
+          private_key_data.b + key_pair.private_key.data
+        )
+      ).to eq(expected)
+    end
+
+    it 'raises an error if the data is not a multiple of 32 bytes' do
+      expect do
+        subject.key_pairs_from_private_key_data(private_key_data + 'a')
+      end.to raise_error(Secp256k1::Error, 'private key data must be a multiple of 32 bytes in length')
+    end
+
+    it 'raises an error if a private key is invalid' do
+      expect do
+        subject.key_pairs_from_private_key_data(private_key_data.b + ("\x00".b * 32))
+      end.to raise_error(Secp256k1::Error, 'invalid private key data')
+    end
+  end
+
   describe '#key_pair_from_private_key' do
     let(:expected_private_key_hex) { '490a5885ae7a7d0a9ba45c8129d49a71fd4809be8e50c52ec61f372d86a0cbf9' }
     let(:expected_compressed_pubkey_hex) { '0224a2e7bb31c47c744ee6e44a2ded9a5baf662d3c14845e51512214c391e4f2b5' }
@@ -91,17 +352,61 @@ RSpec.describe Secp256k1::Context do
       expect(signature).to be_a(Secp256k1::Signature)
     end
 
+    it 'can sign a hash stored in an IO::Buffer', if: defined?(IO::Buffer) do
+      hash32 = sha256(text_message)
+      signature = subject.sign(key_pair.private_key, IO::Buffer.for(hash32))
+
+      expect(signature).to eq(subject.sign(key_pair.private_key, hash32))
+    end
+
     it 'raises an error if private key not given' do
       expect do
         subject.sign(subject, sha256(text_message))
       end.to raise_error(TypeError)
     end
 
+    it 'raises an error if the hash is not binary data' do
+      expect do
+        subject.sign(key_pair.private_key, 1234)
+      end.to raise_error(TypeError)
+    end
+
     it 'raises an error if signature is not 32 bytes' do
       expect do
         subject.sign(key_pair.private_key, text_message)
       end.to raise_error(Secp256k1::Error)
     end
+
+    it 'produces a verifiable signature with extra entropy' do
+      hash32 = sha256(text_message)
+      signature = subject.sign(
+        key_pair.private_key, hash32, extra_entropy: SecureRandom.random_bytes(32)
+      )
+
+      expect(subject.verify(signature, key_pair.public_key, hash32)).to be(true)
+    end
+
+    it 'is deterministic for the same extra entropy' do
+      hash32 = sha256(text_message)
+      extra_entropy = SecureRandom.random_bytes(32)
+
+      expect(subject.sign(key_pair.private_key, hash32, extra_entropy: extra_entropy))
+        .to eq(subject.sign(key_pair.private_key, hash32, extra_entropy: extra_entropy))
+    end
+
+    it 'raises an error if extra entropy is not 32 bytes' do
+      expect do
+        subject.sign(key_pair.private_key, sha256(text_message), extra_entropy: 'short')
+      end.to raise_error(Secp256k1::Error, 'extra_entropy must be 32 bytes in length')
+    end
+
+    it 'does not accept a caller supplied nonce' do
+      expect do
+        subject.sign(
+          key_pair.private_key, sha256(text_message), nonce: SecureRandom.random_bytes(32)
+        )
+      end.to raise_error(ArgumentError)
+    end
   end
 
   describe '#verify' do
@@ -111,6 +416,13 @@ RSpec.describe Secp256k1::Context do
       expect(subject.verify(signature, key_pair.public_key, sha256(message))).to be true
     end
 
+    it 'verifies hashes stored in an IO::Buffer', if: defined?(IO::Buffer) do
+      signature = subject.sign(key_pair.private_key, sha256(message))
+      buffer = IO::Buffer.for(sha256(message))
+
+      expect(subject.verify(signature, key_pair.public_key, buffer)).to be true
+    end
+
     it 'is false when public key does not match' do
       signature = subject.sign(key_pair.private_key, sha256(message))
       bad_key_pair = subject.generate_key_pair
@@ -135,6 +447,442 @@ RSpec.describe Secp256k1::Context do
         subject.verify(signature, bad_key_pair.public_key, message)
       end.to raise_error(Secp256k1::Error)
     end
+
+    it 'verifies signatures concurrently from multiple threads' do
+      signature = subject.sign(key_pair.private_key, sha256(message))
+
+      results = Array.new(4) do
+        Thread.new do
+          Array.new(50) { subject.verify(signature, key_pair.public_key, sha256(message)) }
+        end
+      end.flat_map(&:value)
+
+      expect(results.all?).to be true
+    end
+  end
+
+  describe '#sign_message' do
+    let(:message) { 'This is some text' }
+
+    it 'signs the SHA-256 digest of the message by default' do
+      expect(subject.sign_message(key_pair.private_key, message))
+        .to eq(subject.sign(key_pair.private_key, sha256(message)))
+    end
+
+    it 'signs the double SHA-256 digest of the message' do
+      expect(subject.sign_message(key_pair.private_key, message, digest: :double_sha256))
+        .to eq(subject.sign(key_pair.private_key, sha256(sha256(message))))
+    end
+
+    it 'signs the Keccak-256 digest of the message' do
+      keccak256 = ['c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470'].pack('H*')
+      signature = subject.sign_message(key_pair.private_key, '', digest: :keccak256)
+
+      expect(signature).to eq(subject.sign(key_pair.private_key, keccak256))
+    end
+
+    it 'hashes a message stored in an IO::Buffer', if: defined?(IO::Buffer) do
+      expect(subject.sign_message(key_pair.private_key, IO::Buffer.for(message)))
+        .to eq(subject.sign_message(key_pair.private_key, message))
+    end
+
+    it 'raises an error for an unsupported digest' do
+      expect do
+        subject.sign_message(key_pair.private_key, message, digest: :md5)
+      end.to raise_error(ArgumentError)
+    end
+  end
+
+  describe '#verify_message' do
+    let(:message) { 'This is some text' }
+
+    it 'verifies a signature of the message digest' do
+      signature = subject.sign_message(key_pair.private_key, message, digest: :keccak256)
+
+      expect(subject.verify_message(signature, key_pair.public_key, message, digest: :keccak256))
+        .to be(true)
+      expect(subject.verify_message(signature, key_pair.public_key, message))
+        .to be(false)
+    end
+
+    it 'raises an error for unknown keywords' do
+      signature = subject.sign_message(key_pair.private_key, message)
+
+      expect do
+        subject.verify_message(signature, key_pair.public_key, message, nonce: 'x' * 32)
+      end.to raise_error(ArgumentError)
+    end
+  end
+
+  describe '#verify_batch' do
+    let(:key_pairs) { Array.new(3) { subject.generate_key_pair } }
+    let(:hashes) { %w[first second third].map { |data| sha256(data) } }
+    let(:signatures) do
+      key_pairs.zip(hashes).map { |kp, hash32| subject.sign(kp.private_key, hash32) }
+    end
+    let(:public_keys) { key_pairs.map(&:public_key) }
+
+    it 'verifies every valid signature' do
+      expect(subject.verify_batch(signatures, public_keys, hashes))
+        .to eq([true, true, true])
+    end
+
+    it 'marks invalid signatures as false' do
+      tampered_hashes = hashes.dup
+      tampered_hashes[1] = sha256('tampered')
+
+      expect(subject.verify_batch(signatures, public_keys, tampered_hashes))
+        .to eq([true, false, true])
+    end
+
+    it 'leaves unverified entries nil when failing fast' do
+      tampered_hashes = hashes.dup
+      tampered_hashes[1] = sha256('tampered')
+
+      expect(subject.verify_batch(signatures, public_keys, tampered_hashes, fail_fast: true))
+        .to eq([true, false, nil])
+    end
+
+    it 'accepts signature and public key arrays' do
+      signature_array = Secp256k1::SignatureArray.new
+      signature_array.append_compact(signatures.map(&:compact).join)
+      public_key_array = Secp256k1::PublicKeyArray.new
+      public_key_array.append_compressed(public_keys.map(&:compressed).join)
+
+      expect(subject.verify_batch(signature_array, public_key_array, hashes))
+        .to eq([true, true, true])
+    end
+
+    it 'accepts empty batches' do
+      expect(subject.verify_batch([], [], [])).to eq([])
+    end
+
+    it 'raises an error if the arrays differ in length' do
+      expect do
+        subject.verify_batch(signatures, public_keys.take(2), hashes)
+      end.to raise_error(Secp256k1::Error, 'signatures, public keys, and hashes must have the same length')
+    end
+
+    it 'raises an error if a hash is not 32 bytes' do
+      short_hashes = hashes.dup
+      short_hashes[2] = 'short'
+
+      expect do
+        subject.verify_batch(signatures, public_keys, short_hashes)
+      end.to raise_error(Secp256k1::Error)
+    end
+
+    it 'raises an error if an entry has the wrong type' do
+      expect do
+        subject.verify_batch(public_keys, public_keys, hashes)
+      end.to raise_error(TypeError)
+    end
+
+    it 'splits large batches across workers' do
+      context = Secp256k1::Context.create(workers: 4)
+      key_pair = context.generate_key_pair
+      batch_hashes = Array.new(100) { |i| sha256(i.to_s) }
+      batch_signatures = batch_hashes.map { |hash32| context.sign(key_pair.private_key, hash32) }
+      batch_hashes[42] = sha256('tampered')
+
+      results = context.verify_batch(
+        batch_signatures, [key_pair.public_key] * 100, batch_hashes
+      )
+
+      expect(results.count(true)).to eq(99)
+      expect(results[42]).to be false
+    end
+
+    if defined?(Ractor)
+      it 'verifies from several Ractors sharing a frozen context' do
+        context = Ractor.make_shareable(Secp256k1::Context.create(workers: 4))
+        key_pair = context.generate_key_pair
+        batch_hashes = Array.new(50) { |i| sha256(i.to_s) }
+        batch_signatures = batch_hashes.map { |hash32| context.sign(key_pair.private_key, hash32) }
+        batch = Ractor.make_shareable(
+          [batch_signatures, [key_pair.public_key] * 50, batch_hashes]
+        )
+
+        ractors = Array.new(4) do
+          Ractor.new(context, batch) do |shared_context, shared_batch|
+            Array.new(10) { shared_context.verify_batch(*shared_batch).all? }.all?
+          end
+        end
+
+        results = ractors.map { |ractor| ractor.respond_to?(:value) ? ractor.value : ractor.take }
+        expect(results).to eq([true] * 4)
+      end
+    end
+  end
+
+  describe '#verify_batch_async' do
+    let(:hashes) { Array.new(20) { |i| sha256(i.to_s) } }
+    let(:signatures) { hashes.map { |hash32| subject.sign(key_pair.private_key, hash32) } }
+    let(:public_keys) { [key_pair.public_key] * 20 }
+
+    it 'returns a thread whose value is the verification result' do
+      thread = subject.verify_batch_async(signatures, public_keys, hashes)
+
+      expect(thread).to be_a(Thread)
+      expect(thread.value).to eq([true] * 20)
+    end
+
+    it 'passes options through to verify_batch' do
+      tampered_hashes = hashes.dup
+      tampered_hashes[0] = sha256('tampered')
+
+      thread = subject.verify_batch_async(
+        signatures, public_keys, tampered_hashes, fail_fast: true
+      )
+
+      expect(thread.value).to eq([false] + [nil] * 19)
+    end
+
+    it 'raises errors when waiting for the result' do
+      thread = subject.verify_batch_async(signatures, public_keys.take(2), hashes)
+
+      expect { thread.value }.to raise_error(Secp256k1::Error)
+    end
+  end
+
+  describe '#verify_packed' do
+    let(:hashes) { Array.new(20) { |i| sha256(i.to_s) } }
+    let(:records) do
+      hashes.map do |hash32|
+        subject.sign(key_pair.private_key, hash32).compact +
+          key_pair.public_key.compressed + hash32
+      end
+    end
+
+    it 'returns one result byte per record' do
+      records[3] = records[3].byteslice(0, 128) + "\x00".b
+      packed = records.join.freeze
+
+      expected = Array.new(20, 1)
+      expected[3] = 0
+      expect(subject.verify_packed(packed).bytes).to eq(expected)
+    end
+
+    it 'marks records with unparsable public keys as invalid' do
+      records[0] = records[0].byteslice(0, 64) + ("\x00".b * 33) +
+                   records[0].byteslice(97, 32)
+
+      expect(subject.verify_packed(records.join).bytes.first).to eq(0)
+    end
+
+    it 'returns an empty string for an empty buffer' do
+      expect(subject.verify_packed(''.b)).to eq(''.b)
+    end
+
+    it 'accepts high-S signatures only when normalizing' do
+      # Testnet transaction 8ccc87b72d766ab3128f03176bb1c98293f2d1f85ebfaf07b82cc81ea6891fa9
+      # input 3, taken from rust-secp256k1
+      record = Secp256k1::Util.hex_to_bin(
+        '839c1fbc5304de944f697c9f4b1d01d1faeba32d751c0f7acb21ac8a0f436a72' \
+        'e89bd46bb3a5a62adc679f659b7ce876d83ee297c7a5587b2011c4fcc72eab45' \
+        '031ee99d2b786ab3b0991325f2de8489246a6a3fdb700f6d0511b1d80cf5f4cd43' \
+        'a4965ca63b7d8562736ceec36dfa5a11bf426eb65be8ea3f7a49ae363032da0d'
+      )
+
+      expect(subject.verify_packed(record)).to eq("\x00".b)
+      expect(subject.verify_packed(record, normalize: true)).to eq("\x01".b)
+    end
+
+    it 'raises an error if the buffer is not a multiple of the record size' do
+      expect do
+        subject.verify_packed(records.join + "\x00".b)
+      end.to raise_error(Secp256k1::Error, 'packed records must be a multiple of 129 bytes')
+    end
+
+    it 'unlocks the buffer after verification' do
+      packed = records.join
+      subject.verify_packed(packed)
+
+      expect { packed << "\x00".b }.not_to raise_error
+    end
+
+    it 'reads records from an IO::Buffer', if: defined?(IO::Buffer) do
+      buffer = IO::Buffer.for(records.join.dup)
+
+      expect(subject.verify_packed(buffer).bytes).to eq(Array.new(20, 1))
+      expect(buffer.locked?).to be false
+    end
+  end
+
+  describe '#verify_packed_async' do
+    it 'returns a thread whose value is the verification result' do
+      hash32 = sha256('async packed')
+      record = subject.sign(key_pair.private_key, hash32).compact +
+               key_pair.public_key.compressed + hash32
+
+      thread = subject.verify_packed_async((record * 20).freeze)
+
+      expect(thread).to be_a(Thread)
+      expect(thread.value).to eq("\x01".b * 20)
+    end
+  end
+
+  describe '#sign_batch' do
+    let(:hashes) { Array.new(20) { |i| sha256(i.to_s) } }
+
+    it 'signs each hash with the matching private key' do
+      signatures = subject.sign_batch([key_pair.private_key] * 20, hashes)
+
+      expect(signatures).to eq(hashes.map { |hash32| subject.sign(key_pair.private_key, hash32) })
+    end
+
+    it 'raises an error if the arrays differ in length' do
+      expect do
+        subject.sign_batch([key_pair.private_key], hashes)
+      end.to raise_error(Secp256k1::Error, 'private keys and hashes must have the same length')
+    end
+  end
+
+  describe '#public_keys_from_private_keys' do
+    it 'derives the public key of each private key' do
+      key_pairs = Array.new(20) { subject.generate_key_pair }
+
+      expect(subject.public_keys_from_private_keys(key_pairs.map(&:private_key)))
+        .to eq(key_pairs.map(&:public_key))
+    end
+
+    it 'raises an error if an entry is not a private key' do
+      expect do
+        subject.public_keys_from_private_keys([key_pair.public_key])
+      end.to raise_error(TypeError)
+    end
+  end
+
+  describe '#tweak_add_private_key' do
+    let(:tweak) { sha256('tweak') }
+
+    it 'matches tweaking the public key' do
+      tweaked = subject.tweak_add_private_key(key_pair.private_key, tweak)
+
+      expect(subject.key_pair_from_private_key(tweaked.data).public_key)
+        .to eq(subject.tweak_add_public_key(key_pair.public_key, tweak))
+    end
+
+    it 'raises an error if the tweak is not less than the curve order' do
+      order = Secp256k1::Util.hex_to_bin(
+        'fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141'
+      )
+
+      expect do
+        subject.tweak_add_private_key(key_pair.private_key, order)
+      end.to raise_error(Secp256k1::Error, 'invalid tweak for private key')
+    end
+
+    it 'raises an error if the tweak is not 32 bytes' do
+      expect do
+        subject.tweak_add_private_key(key_pair.private_key, 'short')
+      end.to raise_error(Secp256k1::Error, 'tweak must be 32 bytes in length')
+    end
+  end
+
+  describe '#tweak_mul_private_key' do
+    it 'matches tweaking the public key' do
+      tweak = sha256('tweak')
+      tweaked = subject.tweak_mul_private_key(key_pair.private_key, tweak)
+
+      expect(subject.key_pair_from_private_key(tweaked.data).public_key)
+        .to eq(subject.tweak_mul_public_key(key_pair.public_key, tweak))
+    end
+  end
+
+  describe '#tweak_add_public_key' do
+    it 'raises an error if the context cannot verify' do
+      context = Secp256k1::Context.create(capabilities: [:sign])
+
+      expect do
+        context.tweak_add_public_key(key_pair.public_key, sha256('tweak'))
+      end.to raise_error(Secp256k1::Error)
+    end
+  end
+
+  describe '#combine_public_keys' do
+    it 'returns the public key of the summed private keys' do
+      other = subject.generate_key_pair
+
+      combined = subject.combine_public_keys(
+        [key_pair.public_key, other.public_key]
+      )
+
+      summed = subject.tweak_add_private_key(
+        key_pair.private_key, other.private_key.data
+      )
+      expect(combined)
+        .to eq(subject.key_pair_from_private_key(summed.data).public_key)
+    end
+
+    it 'raises an error if no public keys are given' do
+      expect do
+        subject.combine_public_keys([])
+      end.to raise_error(ArgumentError)
+    end
+  end
+
+  describe '#derive_children' do
+    # BIP-32 test vector 1, chain m/0H
+    let(:xpub) do
+      'xpub68Gmy5EdvgibQVfPdqkBBCHxA5htiqg55crXYuXoQRKfDBFA1WEjWgP6LHhwBZeNK1VT' \
+        'sfTFUHCdrfp1bgwQ9xv5ski8PX9rL2dZXvgGDnw'
+    end
+    let(:chain_code) do
+      Secp256k1::Util.hex_to_bin(
+        '47fdacbd0f1097043b78c63c20c34ef4ed9a111d980047ad16282c7ae6236141'
+      )
+    end
+    let(:parent) do
+      Secp256k1::PublicKey.from_data(
+        Secp256k1::Util.hex_to_bin(
+          '035a784662a4a20a65bf6aab9ae98a6c068a81c52e4b032c0fb5400c706cfccc56'
+        )
+      )
+    end
+
+    it 'derives the child public keys of the test vectors' do
+      child = subject.derive_children(xpub, 1..1).first
+
+      expect(Secp256k1::Util.bin_to_hex(child.compressed))
+        .to eq('03501e454bf00751f24b1b489aa925215d66af2234e3891c3b21a52bedb3cd711c')
+    end
+
+    it 'derives every index in the range' do
+      children = subject.derive_children(xpub, 10...20)
+
+      expected = (10...20).map do |index|
+        hmac = OpenSSL::HMAC.digest(
+          'SHA512', chain_code, parent.compressed + [index].pack('N')
+        )
+        subject.tweak_add_public_key(parent, hmac.byteslice(0, 32))
+      end
+      expect(children).to eq(expected)
+    end
+
+    it 'accepts the 78-byte serialization of the extended key' do
+      serialized = "\x04\x88\xB2\x1E".b + ("\x00".b * 9) + chain_code +
+                   parent.compressed
+
+      expect(subject.derive_children(serialized, 0..3))
+        .to eq(subject.derive_children(xpub, 0..3))
+    end
+
+    it 'returns an empty array for an empty range' do
+      expect(subject.derive_children(xpub, 5...5)).to eq([])
+    end
+
+    it 'raises an error for hardened indexes' do
+      expect do
+        subject.derive_children(xpub, 0..2**31)
+      end.to raise_error(ArgumentError)
+    end
+
+    it 'raises an error if the checksum does not match' do
+      expect do
+        subject.derive_children(xpub.sub(/.\z/, 'x'), 0..1)
+      end.to raise_error(Secp256k1::DeserializationError)
+    end
   end
 
   if Secp256k1.have_recovery?
@@ -165,6 +913,35 @@ RSpec.describe Secp256k1::Context do
           subject.sign_recoverable(subject, text_message)
         end.to raise_error(Secp256k1::Error)
       end
+
+      it 'recovers the signer from a signature made with extra entropy' do
+        hash32 = sha256(text_message)
+        signature = subject.sign_recoverable(
+          key_pair.private_key, hash32, extra_entropy: SecureRandom.random_bytes(32)
+        )
+
+        expect(signature.recover_public_key(hash32)).to eq(key_pair.public_key)
+      end
+
+      it 'raises an error if extra entropy is not 32 bytes' do
+        expect do
+          subject.sign_recoverable(
+            key_pair.private_key, sha256(text_message), extra_entropy: 'short'
+          )
+        end.to raise_error(Secp256k1::Error, 'extra_entropy must be 32 bytes in length')
+      end
+    end
+
+    describe '#recover_message' do
+      it 'recovers the public key that signed the message digest' do
+        message = 'This is some text'
+        signature = subject.sign_recoverable(
+          key_pair.private_key, sha256(sha256(message))
+        )
+
+        expect(subject.recover_message(signature, message, digest: :double_sha256))
+          .to eq(key_pair.public_key)
+      end
     end
 
     describe '#recoverable_signature_from_compact' do
@@ -210,6 +987,96 @@ RSpec.describe Secp256k1::Context do
         end.to raise_error(Secp256k1::Error, /invalid recovery ID/)
       end
     end
+
+    describe '#recover_batch' do
+      let(:hashes) { Array.new(20) { |i| sha256(i.to_s) } }
+      let(:signatures) do
+        hashes.map { |hash32| subject.sign_recoverable(key_pair.private_key, hash32) }
+      end
+
+      it 'recovers the public key of each signature' do
+        expect(subject.recover_batch(signatures, hashes))
+          .to eq([key_pair.public_key] * 20)
+      end
+
+      it 'raises an error if the arrays differ in length' do
+        expect do
+          subject.recover_batch(signatures, hashes.take(1))
+        end.to raise_error(Secp256k1::Error, 'signatures and hashes must have the same length')
+      end
+    end
+
+    describe '#recover_public_keys_batch' do
+      let(:hashes) { Array.new(20) { |i| sha256(i.to_s) } }
+      let(:compact_signatures) do
+        hashes.map do |hash32|
+          subject.sign_recoverable(key_pair.private_key, hash32).compact
+        end
+      end
+
+      it 'returns one uncompressed public key per signature' do
+        public_keys = subject.recover_public_keys_batch(
+          compact_signatures.map(&:first), compact_signatures.map(&:last), hashes
+        )
+
+        expect(public_keys.scan(/.{65}/mn))
+          .to eq([key_pair.public_key.uncompressed] * 20)
+      end
+
+      it 'returns zero bytes for signatures that cannot be recovered' do
+        signatures = compact_signatures.map(&:first)
+        signatures[2] = "\xFF".b * 64
+        public_keys = subject.recover_public_keys_batch(
+          signatures, compact_signatures.map(&:last), hashes
+        )
+
+        expect(public_keys.byteslice(2 * 65, 65)).to eq("\x00".b * 65)
+      end
+
+      it 'raises an error if the arrays differ in length' do
+        expect do
+          subject.recover_public_keys_batch(
+            compact_signatures.map(&:first), [0], hashes
+          )
+        end.to raise_error(Secp256k1::Error, 'compact signatures, recovery IDs, and hashes must have the same length')
+      end
+
+      it 'raises an error if a recovery ID is invalid' do
+        expect do
+          subject.recover_public_keys_batch(
+            compact_signatures.map(&:first).take(1), [4], hashes.take(1)
+          )
+        end.to raise_error(Secp256k1::Error, 'invalid recovery ID, must be in range [0, 3]')
+      end
+    end
+
+    describe '#recover_packed' do
+      let(:hashes) { Array.new(20) { |i| sha256(i.to_s) } }
+      let(:records) do
+        hashes.map do |hash32|
+          compact, recovery_id = subject.sign_recoverable(
+            key_pair.private_key, hash32
+          ).compact
+          compact + recovery_id.chr + hash32
+        end
+      end
+
+      it 'returns one uncompressed public key per record' do
+        records[5] = records[5].byteslice(0, 64) + "\x04".b +
+                     records[5].byteslice(65, 32)
+        public_keys = subject.recover_packed(records.join)
+
+        expected = Array.new(20, key_pair.public_key.uncompressed)
+        expected[5] = "\x00".b * 65
+        expect(public_keys.scan(/.{65}/mn)).to eq(expected)
+      end
+
+      it 'raises an error if the buffer is not a multiple of the record size' do
+        expect do
+          subject.recover_packed(records.join.byteslice(0, 96))
+        end.to raise_error(Secp256k1::Error, 'packed records must be a multiple of 97 bytes')
+      end
+    end
   end
 
   if Secp256k1.have_ecdh?
@@ -221,6 +1088,143 @@ RSpec.describe Secp256k1::Context do
         expect(shared_secret.data).to be_a(String)
         expect(shared_secret.data.length).to eq(32)
       end
+
+      it 'returns the x-coordinate of the shared point when asked' do
+        shared_secret = subject.ecdh(
+          key_pair.public_key, key_pair.private_key, hash: :x_coordinate
+        )
+
+        expect(shared_secret.data.length).to eq(32)
+        expect(shared_secret.data).not_to eq(
+          subject.ecdh(key_pair.public_key, key_pair.private_key).data
+        )
+      end
+
+      it 'raises an error for an unsupported hash' do
+        expect do
+          subject.ecdh(key_pair.public_key, key_pair.private_key, hash: :md5)
+        end.to raise_error(ArgumentError)
+      end
+    end
+
+    describe '#ecdh_batch' do
+      let(:public_keys) { Array.new(5) { subject.generate_key_pair.public_key } }
+
+      it 'returns the shared secret with every public key in order' do
+        secrets = subject.ecdh_batch(key_pair.private_key, public_keys)
+
+        expect(secrets.length).to eq(32 * public_keys.length)
+        public_keys.each_with_index do |public_key, i|
+          expect(secrets[i * 32, 32])
+            .to eq(subject.ecdh(public_key, key_pair.private_key).data)
+        end
+      end
+
+      it 'returns x-coordinates when asked' do
+        secrets = subject.ecdh_batch(
+          key_pair.private_key, public_keys, hash: :x_coordinate
+        )
+
+        public_keys.each_with_index do |public_key, i|
+          expect(secrets[i * 32, 32]).to eq(
+            subject.ecdh(public_key, key_pair.private_key, hash: :x_coordinate).data
+          )
+        end
+      end
+
+      it 'returns an empty string for no public keys' do
+        expect(subject.ecdh_batch(key_pair.private_key, [])).to eq('')
+      end
+
+      it 'raises an error if public keys is not an array' do
+        expect do
+          subject.ecdh_batch(key_pair.private_key, key_pair.public_key)
+        end.to raise_error(TypeError)
+      end
+    end
+  end
+
+  if Secp256k1.have_schnorrsig?
+    describe '#sign_schnorr' do
+      let(:message32) { sha256('schnorr message') }
+
+      it 'produces a 64-byte signature' do
+        signature = subject.sign_schnorr(key_pair.private_key, message32)
+
+        expect(signature).to be_a(String)
+        expect(signature.length).to eq(64)
+      end
+
+      it 'accepts auxiliary randomness' do
+        signature = subject.sign_schnorr(
+          key_pair.private_key, message32, aux_rand: SecureRandom.random_bytes(32)
+        )
+
+        expect(
+          subject.verify_schnorr(signature, key_pair.public_key.to_x_only, message32)
+        ).to be(true)
+      end
+
+      it 'raises an error if aux_rand is not 32 bytes' do
+        expect do
+          subject.sign_schnorr(key_pair.private_key, message32, aux_rand: 'short')
+        end.to raise_error(Secp256k1::Error, 'aux_rand must be 32 bytes in length')
+      end
+
+      it 'raises an error if the message is not 32 bytes' do
+        expect do
+          subject.sign_schnorr(key_pair.private_key, 'short')
+        end.to raise_error(Secp256k1::Error, 'in_message32 is not 32 bytes in length')
+      end
+    end
+
+    describe '#verify_schnorr' do
+      let(:message32) { sha256('schnorr message') }
+      let(:signature) { subject.sign_schnorr(key_pair.private_key, message32) }
+      let(:x_only_public_key) { key_pair.public_key.to_x_only }
+
+      it 'verifies a valid signature' do
+        expect(subject.verify_schnorr(signature, x_only_public_key, message32))
+          .to be(true)
+      end
+
+      it 'rejects a signature over a different message' do
+        expect(
+          subject.verify_schnorr(signature, x_only_public_key, sha256('other'))
+        ).to be(false)
+      end
+
+      it 'raises an error if the signature is not 64 bytes' do
+        expect do
+          subject.verify_schnorr(signature[0, 63], x_only_public_key, message32)
+        end.to raise_error(Secp256k1::Error, 'schnorr signature must be 64 bytes')
+      end
+    end
+
+    describe '#verify_schnorr_batch' do
+      let(:key_pairs) { Array.new(3) { subject.generate_key_pair } }
+      let(:messages) { %w[first second third].map { |data| sha256(data) } }
+      let(:signatures) do
+        key_pairs.zip(messages).map do |kp, message32|
+          subject.sign_schnorr(kp.private_key, message32)
+        end
+      end
+      let(:x_only_public_keys) { key_pairs.map { |kp| kp.public_key.to_x_only } }
+
+      it 'marks each signature as valid or invalid' do
+        tampered_messages = messages.dup
+        tampered_messages[1] = sha256('tampered')
+
+        expect(
+          subject.verify_schnorr_batch(signatures, x_only_public_keys, tampered_messages)
+        ).to eq([true, false, true])
+      end
+
+      it 'raises an error if the arrays differ in length' do
+        expect do
+          subject.verify_schnorr_batch(signatures, x_only_public_keys, messages[0, 2])
+        end.to raise_error(Secp256k1::Error)
+      end
     end
   end
 end
@@ -19,4 +19,64 @@ RSpec.describe Secp256k1::KeyPair do
       end.to raise_error(TypeError, /wrong argument type PublicKey/)
     end
   end
+
+  describe '#public_key' do
+    it 'returns the same public key object on every call' do
+      expect(key_pair.public_key).to equal(key_pair.public_key)
+    end
+
+    it 'returns the public key corresponding to the private key' do
+      derived = context.key_pair_from_private_key(key_pair.private_key.data)
+
+      expect(key_pair.public_key).to eq(derived.public_key)
+    end
+  end
+
+  describe '#private_key' do
+    it 'returns the same private key object on every call' do
+      expect(key_pair.private_key).to equal(key_pair.private_key)
+    end
+
+    it 'returns the keys it was initialized with' do
+      copy = Secp256k1::KeyPair.new(key_pair.public_key, key_pair.private_key)
+
+      expect(copy.private_key).to equal(key_pair.private_key)
+      expect(copy.public_key).to equal(key_pair.public_key)
+      expect(copy).to eq(key_pair)
+    end
+  end
+
+  describe '#hash' do
+    it 'allows equal key pairs to be used as the same hash key' do
+      copy = context.key_pair_from_private_key(key_pair.private_key.data)
+
+      expect(copy.hash).to eq(key_pair.hash)
+      expect(copy).to eql(key_pair)
+      expect({ key_pair => 1, copy => 2 }.size).to eq(1)
+    end
+
+    it 'differs for different key pairs' do
+      expect(context.generate_key_pair.hash).not_to eq(key_pair.hash)
+    end
+  end
+
+  describe '#freeze' do
+    it 'freezes the public and private keys of the pair' do
+      expect(key_pair.freeze).to equal(key_pair)
+      expect(key_pair.public_key).to be_frozen
+      expect(key_pair.private_key).to be_frozen
+    end
+
+    if defined?(Ractor)
+      it 'makes the key pair shareable with other Ractors' do
+        expect(Ractor.shareable?(key_pair.freeze)).to be true
+      end
+    end
+  end
+
+  describe '#eql?' do
+    it 'returns false for objects that are not key pairs' do
+      expect(key_pair).not_to eql(key_pair.public_key)
+    end
+  end
 end
@@ -42,4 +42,20 @@ RSpec.describe Secp256k1::PrivateKey do
       end.to raise_error(TypeError)
     end
   end
+
+  describe '#hash' do
+    it 'allows equal private keys to be used as the same hash key' do
+      copy = Secp256k1::PrivateKey.from_data(key_pair.private_key.data)
+
+      expect(copy.hash).to eq(key_pair.private_key.hash)
+      expect(copy).to eql(key_pair.private_key)
+      expect([copy, key_pair.private_key].uniq.length).to eq(1)
+    end
+  end
+
+  describe '#eql?' do
+    it 'returns false for objects that are not private keys' do
+      expect(key_pair.private_key).not_to eql(key_pair.private_key.data)
+    end
+  end
 end
@@ -0,0 +1,247 @@
+# frozen_string_literal: true
+
+require 'objspace'
+require 'spec_helper'
+require 'tmpdir'
+
+RSpec.describe Secp256k1::PublicKeyArray do
+  let(:context) { Secp256k1::Context.create }
+  let(:public_keys) { Array.new(5) { context.generate_key_pair.public_key } }
+
+  describe '.new' do
+    it 'creates an empty array' do
+      expect(Secp256k1::PublicKeyArray.new.size).to eq(0)
+    end
+
+    it 'reserves room for the given capacity' do
+      empty = Secp256k1::PublicKeyArray.new
+      reserved = Secp256k1::PublicKeyArray.new(capacity: 1000)
+
+      expect(ObjectSpace.memsize_of(reserved))
+        .to be >= ObjectSpace.memsize_of(empty) + 1000 * 64
+      expect(reserved.size).to eq(0)
+    end
+
+    it 'raises an error if capacity is negative' do
+      expect do
+        Secp256k1::PublicKeyArray.new(capacity: -1)
+      end.to raise_error(Secp256k1::Error, 'capacity must not be negative')
+    end
+  end
+
+  describe '#<<' do
+    it 'appends copies of public keys' do
+      array = Secp256k1::PublicKeyArray.new
+      public_keys.each { |public_key| array << public_key }
+
+      expect(array.size).to eq(5)
+      expect(array.to_a).to eq(public_keys)
+    end
+
+    it 'raises an error for objects that are not public keys' do
+      expect do
+        Secp256k1::PublicKeyArray.new << public_keys.first.compressed
+      end.to raise_error(TypeError)
+    end
+
+    it 'raises an error if the array is frozen' do
+      expect do
+        Secp256k1::PublicKeyArray.new.freeze << public_keys.first
+      end.to raise_error(FrozenError)
+    end
+  end
+
+  describe '#append_compressed' do
+    it 'parses concatenated compressed public keys' do
+      array = Secp256k1::PublicKeyArray.new
+      array.append_compressed(public_keys.map(&:compressed).join)
+
+      expect(array.to_a).to eq(public_keys)
+    end
+
+    it 'appends nothing if a public key is invalid' do
+      array = Secp256k1::PublicKeyArray.new
+      data = public_keys.map(&:compressed)
+      data[2] = "\x05".b * 33
+
+      expect do
+        array.append_compressed(data.join)
+      end.to raise_error(Secp256k1::DeserializationError, 'invalid public key data at offset 66')
+      expect(array.size).to eq(0)
+    end
+
+    it 'raises an error if the data is not a multiple of 33 bytes' do
+      expect do
+        Secp256k1::PublicKeyArray.new.append_compressed("\x02".b * 34)
+      end.to raise_error(Secp256k1::Error, 'public key data must be a multiple of 33 bytes')
+    end
+  end
+
+  describe '#append_uncompressed' do
+    it 'parses concatenated uncompressed public keys' do
+      array = Secp256k1::PublicKeyArray.new
+      array.append_uncompressed(public_keys.map(&:uncompressed).join)
+
+      expect(array.to_a).to eq(public_keys)
+    end
+  end
+
+  describe '#[]' do
+    let(:array) do
+      Secp256k1::PublicKeyArray.new.append_compressed(
+        public_keys.map(&:compressed).join
+      )
+    end
+
+    it 'returns the public key at the index' do
+      expect(array[1]).to eq(public_keys[1])
+      expect(array[-1]).to eq(public_keys[-1])
+    end
+
+    it 'returns nil for indexes out of range' do
+      expect(array[5]).to be_nil
+      expect(array[-6]).to be_nil
+    end
+  end
+
+  describe '#each' do
+    it 'returns a sized enumerator without a block' do
+      array = Secp256k1::PublicKeyArray.new << public_keys.first
+
+      expect(array.each.size).to eq(1)
+      expect(array.each.to_a).to eq([public_keys.first])
+    end
+  end
+
+  describe '.load' do
+    let(:array) do
+      public_keys.each_with_object(Secp256k1::PublicKeyArray.new) do |key, keys|
+        keys << key
+      end
+    end
+    let(:dir) { Dir.mktmpdir }
+    let(:path) { File.join(dir, 'public_keys.store') }
+
+    after { FileUtils.remove_entry(dir) }
+
+    it 'round trips the public keys written by #dump' do
+      expect(array.dump(path)).to eq(128 + 5 * 64)
+
+      loaded = Secp256k1::PublicKeyArray.load(path)
+
+      expect(loaded.to_a).to eq(public_keys)
+    end
+
+    it 'copies the store before appending to it' do
+      array.dump(path)
+      loaded = Secp256k1::PublicKeyArray.load(path)
+
+      loaded << public_keys.first
+
+      expect(loaded.size).to eq(6)
+      expect(loaded[5]).to eq(public_keys.first)
+      expect(Secp256k1::PublicKeyArray.load(path).size).to eq(5)
+    end
+
+    it 'dumps a loaded array over the store it was loaded from' do
+      array.dump(path)
+      loaded = Secp256k1::PublicKeyArray.load(path)
+      other = Secp256k1::PublicKeyArray.load(path)
+
+      expect(loaded.dump(path)).to eq(128 + 5 * 64)
+      expect(other.to_a).to eq(public_keys)
+      expect(Secp256k1::PublicKeyArray.load(path).to_a).to eq(public_keys)
+      expect(Dir.children(dir)).to eq(['public_keys.store'])
+    end
+
+    it 'raises an error if the checksum does not match' do
+      array.dump(path)
+      # Swapping two entries keeps every public key valid
+      data = File.binread(path)
+      data[128, 128] = data.byteslice(192, 64) + data.byteslice(128, 64)
+      File.binwrite(path, data)
+
+      expect do
+        Secp256k1::PublicKeyArray.load(path)
+      end.to raise_error(
+        Secp256k1::DeserializationError, 'store checksum does not match'
+      )
+      expect(Secp256k1::PublicKeyArray.load(path, verify: false).first(2))
+        .to eq(public_keys.first(2).reverse)
+    end
+
+    it 'raises an error if the store holds an invalid public key' do
+      array.dump(path)
+      ["\x00".b * 64, "\xff".b * 64].each do |entry|
+        # Overwrite the third entry and recompute the unkeyed checksum
+        data = File.binread(path)
+        data[128 + 2 * 64, 64] = entry
+        data[88, 32] = sha256(data.byteslice(128..))
+        File.binwrite(path, data)
+
+        [true, false].each do |verify|
+          expect do
+            Secp256k1::PublicKeyArray.load(path, verify: verify)
+          end.to raise_error(
+            Secp256k1::DeserializationError, 'store holds an invalid public key'
+          )
+        end
+      end
+    end
+
+    it 'raises an error if the store holds signatures' do
+      Secp256k1::SignatureArray.new.dump(path)
+
+      expect do
+        Secp256k1::PublicKeyArray.load(path)
+      end.to raise_error(
+        Secp256k1::DeserializationError, 'store does not hold public keys'
+      )
+    end
+
+    it 'raises an error if the store is truncated' do
+      array.dump(path)
+      File.truncate(path, File.size(path) - 1)
+
+      expect do
+        Secp256k1::PublicKeyArray.load(path)
+      end.to raise_error(
+        Secp256k1::DeserializationError,
+        'store length does not match its number of entries'
+      )
+    end
+
+    it 'raises an error if the store version is not supported' do
+      array.dump(path)
+      data = File.binread(path)
+      data[8, 4] = [2].pack('V')
+      File.binwrite(path, data)
+
+      expect do
+        Secp256k1::PublicKeyArray.load(path)
+      end.to raise_error(
+        Secp256k1::DeserializationError, 'unsupported store version'
+      )
+    end
+
+    it 'raises an error if the file is not a store' do
+      File.binwrite(path, 'not a store')
+
+      expect do
+        Secp256k1::PublicKeyArray.load(path)
+      end.to raise_error(
+        Secp256k1::DeserializationError, 'not a public key or signature store'
+      )
+    end
+  end
+
+  if defined?(Ractor)
+    describe '#freeze' do
+      it 'makes the array shareable with other Ractors' do
+        array = Secp256k1::PublicKeyArray.new << public_keys.first
+
+        expect(Ractor.shareable?(array.freeze)).to be true
+      end
+    end
+  end
+end
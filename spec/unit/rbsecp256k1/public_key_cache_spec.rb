@@ -0,0 +1,65 @@
+# frozen_string_literal: true
+
+require 'spec_helper'
+
+RSpec.describe Secp256k1::PublicKeyCache do
+  subject { Secp256k1::PublicKeyCache.new(2) }
+  let(:context) { Secp256k1::Context.create }
+  let(:key_pairs) { Array.new(3) { context.generate_key_pair } }
+  let(:compressed) { key_pairs.map { |kp| kp.public_key.compressed } }
+
+  describe '#initialize' do
+    it 'raises an error if capacity is not positive' do
+      expect do
+        Secp256k1::PublicKeyCache.new(0)
+      end.to raise_error(ArgumentError, 'capacity must be positive')
+    end
+  end
+
+  describe '#fetch' do
+    it 'returns the parsed public key' do
+      expect(subject.fetch(compressed[0])).to eq(key_pairs[0].public_key)
+    end
+
+    it 'returns the same object on repeated lookups' do
+      public_key = subject.fetch(compressed[0])
+
+      expect(subject.fetch(compressed[0])).to equal(public_key)
+      expect(subject.hits).to eq(1)
+      expect(subject.misses).to eq(1)
+    end
+
+    it 'evicts the least recently used public key when full' do
+      subject.fetch(compressed[0])
+      subject.fetch(compressed[1])
+      subject.fetch(compressed[0])
+      subject.fetch(compressed[2])
+
+      expect(subject.size).to eq(2)
+      expect(subject.include?(compressed[0])).to be(true)
+      expect(subject.include?(compressed[1])).to be(false)
+      expect(subject.include?(compressed[2])).to be(true)
+    end
+
+    it 'does not cache invalid public key data' do
+      expect do
+        subject.fetch(Random.new.bytes(64))
+      end.to raise_error(Secp256k1::DeserializationError)
+
+      expect(subject.size).to eq(0)
+    end
+  end
+
+  describe '#clear' do
+    it 'removes every public key and resets counters' do
+      subject.fetch(compressed[0])
+      subject.fetch(compressed[0])
+
+      subject.clear
+
+      expect(subject.size).to eq(0)
+      expect(subject.hits).to eq(0)
+      expect(subject.misses).to eq(0)
+    end
+  end
+end
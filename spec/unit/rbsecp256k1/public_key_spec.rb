@@ -1,5 +1,6 @@
 # frozen_string_literal: true
 
+require 'objspace'
 require 'spec_helper'
 
 RSpec.describe Secp256k1::PublicKey do
@@ -12,6 +13,13 @@ RSpec.describe Secp256k1::PublicKey do
       expect(uncompressed).to be_a(String)
       expect(uncompressed.length).to eq(65)
     end
+
+    it 'returns a new string on each call' do
+      public_key = key_pair.public_key
+      public_key.uncompressed.replace('')
+
+      expect(public_key.uncompressed.length).to eq(65)
+    end
   end
 
   describe '#compressed' do
@@ -20,6 +28,28 @@ RSpec.describe Secp256k1::PublicKey do
       expect(compressed).to be_a(String)
       expect(compressed.length).to eq(33)
     end
+
+    it 'returns a new string on each call' do
+      public_key = key_pair.public_key
+      public_key.compressed.replace('')
+
+      expect(public_key.compressed.length).to eq(33)
+    end
+  end
+
+  describe '#hash' do
+    it 'is the same for equal public keys' do
+      compressed = Secp256k1::PublicKey.from_data(key_pair.public_key.compressed)
+      uncompressed = Secp256k1::PublicKey.from_data(key_pair.public_key.uncompressed)
+
+      expect(compressed.hash).to eq(key_pair.public_key.hash)
+      expect(uncompressed.hash).to eq(key_pair.public_key.hash)
+    end
+
+    it 'differs for different public keys' do
+      expect(context.generate_key_pair.public_key.hash)
+        .not_to eq(key_pair.public_key.hash)
+    end
   end
 
   describe '.from_data' do
@@ -33,6 +63,26 @@ RSpec.describe Secp256k1::PublicKey do
       expect(public_key).to eq(key_pair.public_key)
     end
 
+    it 'serializes loaded keys in both forms' do
+      compressed = Secp256k1::PublicKey.from_data(key_pair.public_key.compressed)
+      uncompressed = Secp256k1::PublicKey.from_data(key_pair.public_key.uncompressed)
+
+      expect(compressed.uncompressed).to eq(key_pair.public_key.uncompressed)
+      expect(uncompressed.compressed).to eq(key_pair.public_key.compressed)
+    end
+
+    it 'loads public key data from an IO::Buffer', if: defined?(IO::Buffer) do
+      buffer = IO::Buffer.for(key_pair.public_key.compressed)
+
+      expect(Secp256k1::PublicKey.from_data(buffer)).to eq(key_pair.public_key)
+    end
+
+    it 'raises an error if public key data is too long' do
+      expect do
+        Secp256k1::PublicKey.from_data(key_pair.public_key.uncompressed + "\x00".b)
+      end.to raise_error(Secp256k1::DeserializationError, 'invalid public key data')
+    end
+
     it 'raises an error if public key is invalid' do
       expect do
         Secp256k1::PublicKey.from_data(Random.new.bytes(64))
@@ -45,4 +95,76 @@ RSpec.describe Secp256k1::PublicKey do
       end.to raise_error(TypeError)
     end
   end
+
+  describe '#eql?' do
+    it 'allows equal public keys to be used as the same hash key' do
+      copy = Secp256k1::PublicKey.from_data(key_pair.public_key.uncompressed)
+
+      expect(copy).to eql(key_pair.public_key)
+      expect({ key_pair.public_key => 1, copy => 2 }.size).to eq(1)
+    end
+
+    it 'returns false for objects that are not public keys' do
+      expect(key_pair.public_key).not_to eql(key_pair.public_key.compressed)
+    end
+  end
+
+  it 'reports its memory usage to ObjectSpace' do
+    expect(ObjectSpace.memsize_of(key_pair.public_key)).to be > 0
+  end
+
+  it 'keeps its data when the heap is compacted', if: GC.respond_to?(:compact) do
+    public_keys = Array.new(100) { context.generate_key_pair.public_key }
+    expected = public_keys.map(&:compressed)
+    GC.compact
+
+    expect(public_keys.map(&:compressed)).to eq(expected)
+  end
+
+  describe '#write_compressed' do
+    it 'appends the compressed public key to a string' do
+      buffer = String.new
+
+      expect(key_pair.public_key.write_compressed(buffer)).to eq(33)
+      expect(buffer).to eq(key_pair.public_key.compressed)
+    end
+
+    it 'writes into an IO::Buffer', if: defined?(IO::Buffer) do
+      buffer = IO::Buffer.new(33)
+
+      expect(key_pair.public_key.write_compressed(buffer, 0)).to eq(33)
+      expect(buffer.get_string).to eq(key_pair.public_key.compressed)
+    end
+
+    it 'requires an offset for an IO::Buffer', if: defined?(IO::Buffer) do
+      expect do
+        key_pair.public_key.write_compressed(IO::Buffer.new(33))
+      end.to raise_error(Secp256k1::Error, 'offset is required when writing to an IO::Buffer')
+    end
+  end
+
+  describe '#freeze' do
+    it 'returns the frozen public key' do
+      public_key = key_pair.public_key
+
+      expect(public_key.freeze).to equal(public_key)
+      expect(public_key).to be_frozen
+      expect(public_key.compressed).to eq(key_pair.public_key.compressed)
+    end
+
+    if defined?(Ractor)
+      it 'makes the public key shareable with other Ractors' do
+        expect(Ractor.shareable?(key_pair.public_key.freeze)).to be true
+      end
+    end
+  end
+
+  describe '#write_uncompressed' do
+    it 'writes the uncompressed public key at an offset' do
+      buffer = "\x00".b * 70
+
+      expect(key_pair.public_key.write_uncompressed(buffer, 5)).to eq(70)
+      expect(buffer.byteslice(5, 65)).to eq(key_pair.public_key.uncompressed)
+    end
+  end
 end
@@ -47,6 +47,18 @@ if Secp256k1.have_recovery?
           .to eq(key_pair.public_key.compressed.bytes)
       end
 
+      it 'recovers the public key after the context is no longer referenced' do
+        private_key = key_pair.private_key
+        expected_public_key = key_pair.public_key
+        recoverable_signature = Secp256k1::Context.create.sign_recoverable(
+          private_key, text_message
+        )
+        GC.start
+
+        expect(recoverable_signature.recover_public_key(text_message))
+          .to eq(expected_public_key)
+      end
+
       it 'bad data to result in wrong public key' do
         recoverable_signature = context.sign_recoverable(
           key_pair.private_key, text_message
@@ -61,5 +73,43 @@ if Secp256k1.have_recovery?
           .not_to eq(key_pair.public_key.compressed.bytes)
       end
     end
+
+    describe '#hash' do
+      it 'allows equal signatures to be used as the same hash key' do
+        recoverable_signature = context.sign_recoverable(
+          key_pair.private_key, text_message
+        )
+        copy = context.recoverable_signature_from_compact(
+          *recoverable_signature.compact
+        )
+
+        expect(copy.hash).to eq(recoverable_signature.hash)
+        expect(copy).to eql(recoverable_signature)
+        expect({ recoverable_signature => 1, copy => 2 }.size).to eq(1)
+      end
+    end
+
+    describe '#eql?' do
+      it 'returns false for objects that are not recoverable signatures' do
+        recoverable_signature = context.sign_recoverable(
+          key_pair.private_key, text_message
+        )
+
+        expect(recoverable_signature).not_to eql(recoverable_signature.to_signature)
+      end
+    end
+
+    describe '#write_compact' do
+      it 'writes the compact signature followed by the recovery ID' do
+        recoverable_signature = context.sign_recoverable(
+          key_pair.private_key, text_message
+        )
+        compact, recovery_id = recoverable_signature.compact
+        buffer = String.new
+
+        expect(recoverable_signature.write_compact(buffer)).to eq(65)
+        expect(buffer).to eq(compact + recovery_id.chr)
+      end
+    end
   end
 end
@@ -0,0 +1,133 @@
+# frozen_string_literal: true
+
+require 'spec_helper'
+require 'tmpdir'
+
+RSpec.describe Secp256k1::SignatureArray do
+  let(:context) { Secp256k1::Context.create }
+  let(:key_pair) { context.generate_key_pair }
+  let(:signatures) do
+    Array.new(5) { |i| context.sign(key_pair.private_key, sha256(i.to_s)) }
+  end
+
+  describe '.new' do
+    it 'creates an empty array' do
+      expect(Secp256k1::SignatureArray.new(capacity: 10).size).to eq(0)
+    end
+  end
+
+  describe '#<<' do
+    it 'appends copies of signatures' do
+      array = Secp256k1::SignatureArray.new
+      signatures.each { |signature| array << signature }
+
+      expect(array.to_a).to eq(signatures)
+    end
+
+    it 'raises an error if the array is frozen' do
+      expect do
+        Secp256k1::SignatureArray.new.freeze << signatures.first
+      end.to raise_error(FrozenError)
+    end
+  end
+
+  describe '#append_compact' do
+    it 'parses concatenated compact signatures' do
+      array = Secp256k1::SignatureArray.new
+      array.append_compact(signatures.map(&:compact).join)
+
+      expect(array.to_a).to eq(signatures)
+    end
+
+    it 'raises an error if the data is not a multiple of 64 bytes' do
+      expect do
+        Secp256k1::SignatureArray.new.append_compact("\x01".b * 65)
+      end.to raise_error(Secp256k1::Error, 'compact signature data must be a multiple of 64 bytes')
+    end
+  end
+
+  describe '#append_der_encoded' do
+    it 'parses concatenated DER encoded signatures' do
+      array = Secp256k1::SignatureArray.new
+      array.append_der_encoded(signatures.map(&:der_encoded).join)
+
+      expect(array.to_a).to eq(signatures)
+    end
+
+    it 'appends nothing if a signature is invalid' do
+      array = Secp256k1::SignatureArray.new
+      data = signatures.first.der_encoded + "\x30\x00".b
+
+      expect do
+        array.append_der_encoded(data)
+      end.to raise_error(
+        Secp256k1::DeserializationError,
+        "invalid DER encoded signature at offset #{signatures.first.der_encoded.bytesize}"
+      )
+      expect(array.size).to eq(0)
+    end
+  end
+
+  describe '#[]' do
+    it 'returns the signature at the index' do
+      array = Secp256k1::SignatureArray.new
+      array.append_compact(signatures.map(&:compact).join)
+
+      expect(array[0]).to eq(signatures[0])
+      expect(array[-2]).to eq(signatures[-2])
+      expect(array[5]).to be_nil
+    end
+  end
+
+  describe '.load' do
+    let(:dir) { Dir.mktmpdir }
+    let(:path) { File.join(dir, 'signatures.store') }
+
+    after { FileUtils.remove_entry(dir) }
+
+    it 'round trips the signatures written by #dump' do
+      array = Secp256k1::SignatureArray.new
+      array.append_compact(signatures.map(&:compact).join)
+
+      expect(array.dump(path)).to eq(128 + 5 * 64)
+      expect(Secp256k1::SignatureArray.load(path).to_a).to eq(signatures)
+    end
+
+    it 'dumps a loaded array over the store it was loaded from' do
+      array = Secp256k1::SignatureArray.new
+      array.append_compact(signatures.map(&:compact).join)
+      array.dump(path)
+      loaded = Secp256k1::SignatureArray.load(path)
+
+      expect(loaded.dump(path)).to eq(128 + 5 * 64)
+      expect(loaded.to_a).to eq(signatures)
+      expect(Secp256k1::SignatureArray.load(path).to_a).to eq(signatures)
+    end
+
+    it 'raises an error if the store holds an invalid signature' do
+      array = Secp256k1::SignatureArray.new
+      array.append_compact(signatures.map(&:compact).join)
+      array.dump(path)
+      data = File.binread(path)
+      data[128, 64] = "\xff".b * 64
+      data[88, 32] = sha256(data.byteslice(128..))
+      File.binwrite(path, data)
+
+      expect do
+        Secp256k1::SignatureArray.load(path, verify: false)
+      end.to raise_error(
+        Secp256k1::DeserializationError, 'store holds an invalid signature'
+      )
+    end
+
+    it 'raises an error if the store holds public keys' do
+      Secp256k1::PublicKeyArray.new.dump(path)
+
+      expect do
+        Secp256k1::SignatureArray.load(path)
+      end.to raise_error(
+        Secp256k1::DeserializationError, 'store does not hold signatures'
+      )
+    end
+  end
+end
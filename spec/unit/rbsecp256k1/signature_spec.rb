@@ -8,6 +8,18 @@ RSpec.describe Secp256k1::Signature do
   let(:key_pair) { context.generate_key_pair }
   let(:signature) { context.sign(key_pair.private_key, sha256(message)) }
 
+  # Data taken from https://github.com/rust-bitcoin/rust-secp256k1/blob/master/src/lib.rs
+  # Original note:
+  # nb this is a transaction on testnet
+  # txid 8ccc87b72d766ab3128f03176bb1c98293f2d1f85ebfaf07b82cc81ea6891fa9
+  #      input number 3
+  let(:unnormalized_der_sig) do
+    '3046022100839c1fbc5304de944f697c9f4b1d01d1faeba32d751c0f7acb21ac8a0f436a72022100e89bd46bb3a5a62adc679f659b7ce876d83ee297c7a5587b2011c4fcc72eab45'
+  end
+  let(:unnormalized_compact_sig) do
+    '839c1fbc5304de944f697c9f4b1d01d1faeba32d751c0f7acb21ac8a0f436a72e89bd46bb3a5a62adc679f659b7ce876d83ee297c7a5587b2011c4fcc72eab45'
+  end
+
   describe '.from_compact' do
     it 'can load a compact signature' do
       signature = context.sign(key_pair.private_key, sha256(message))
@@ -17,11 +29,26 @@ RSpec.describe Secp256k1::Signature do
       expect(result).to eq(signature)
     end
 
+    it 'can load a compact signature from an IO::Buffer', if: defined?(IO::Buffer) do
+      result = Secp256k1::Signature.from_compact(IO::Buffer.for(signature.compact))
+
+      expect(result).to eq(signature)
+    end
+
     it 'raises an error if invalid signature data type is given' do
       expect do
         Secp256k1::Signature.from_compact(123)
       end.to raise_error(TypeError)
     end
+
+    it 'normalizes the signature when asked' do
+      compact = Secp256k1::Util.hex_to_bin(unnormalized_compact_sig)
+
+      result = Secp256k1::Signature.from_compact(compact, normalize: true)
+
+      expect(result.low_s?).to be true
+      expect(result).to eq(Secp256k1::Signature.from_compact(compact).normalized[1])
+    end
   end
 
   describe '.from_der_encoded' do
@@ -33,11 +60,135 @@ RSpec.describe Secp256k1::Signature do
       expect(result).to eq(signature)
     end
 
+    it 'can load a der encoded signature from an IO::Buffer', if: defined?(IO::Buffer) do
+      result = Secp256k1::Signature.from_der_encoded(
+        IO::Buffer.for(signature.der_encoded)
+      )
+
+      expect(result).to eq(signature)
+    end
+
+    it 'parses strings longer than any signature with in-range values' do
+      # R is 35 bytes and overflows the curve order, which libsecp256k1 parses
+      # as zero
+      der_encoded = "\x30\x47\x02\x23\x01".b + ("\x00".b * 34) +
+                    "\x02\x20".b + ("\x01".b * 32)
+
+      result = Secp256k1::Signature.from_der_encoded(der_encoded)
+
+      expect(der_encoded.length).to eq(73)
+      expect(result.compact).to eq(("\x00".b * 32) + ("\x01".b * 32))
+    end
+
     it 'raises an error if signature data is not string' do
       expect do
         Secp256k1::Signature.from_der_encoded(123)
       end.to raise_error(TypeError)
     end
+
+    it 'normalizes the signature when asked' do
+      der_encoded = Secp256k1::Util.hex_to_bin(unnormalized_der_sig)
+
+      result = Secp256k1::Signature.from_der_encoded(der_encoded, normalize: true)
+
+      expect(result.low_s?).to be true
+      expect(result).to eq(
+        Secp256k1::Signature.from_der_encoded(der_encoded).normalized[1]
+      )
+    end
+  end
+
+  describe '.each_der_encoded' do
+    let(:signatures) do
+      Array.new(4) { |i| context.sign(key_pair.private_key, sha256(i.to_s)) }
+    end
+    let(:buffer) { signatures.map(&:der_encoded).join }
+
+    it 'yields each signature with its offset' do
+      offsets = signatures.map(&:der_encoded).map(&:length)
+                          .inject([0]) { |sums, length| sums << sums.last + length }
+
+      results = []
+      Secp256k1::Signature.each_der_encoded(buffer) do |signature, offset|
+        results << [signature, offset]
+      end
+
+      expect(results).to eq(signatures.zip(offsets))
+    end
+
+    it 'returns an enumerator without a block' do
+      enumerator = Secp256k1::Signature.each_der_encoded(buffer, lax: true)
+
+      expect(enumerator).to be_a(Enumerator)
+      expect(enumerator.map { |signature, _offset| signature }).to eq(signatures)
+    end
+
+    it 'accepts padded integers and long form lengths in lax mode' do
+      compact = signatures.first.compact
+      lax_der = "\x30\x81\x49".b + "\x02\x21\x00".b + compact.byteslice(0, 32) +
+                "\x02\x82\x00\x21\x00".b + compact.byteslice(32, 32)
+
+      expect(Secp256k1::Signature.each_der_encoded(lax_der, lax: true).to_a)
+        .to eq([[signatures.first, 0]])
+      expect do
+        Secp256k1::Signature.each_der_encoded(lax_der).to_a
+      end.to raise_error(Secp256k1::DeserializationError)
+    end
+
+    it 'raises an error with the offset of an invalid signature' do
+      expect do
+        Secp256k1::Signature.each_der_encoded(buffer + "\x30".b).to_a
+      end.to raise_error(
+        Secp256k1::DeserializationError,
+        "invalid DER encoded signature at offset #{buffer.length}"
+      )
+    end
+
+    it 'raises an error if a sequence length exceeds the input' do
+      [
+        "\x30\x84\x80\x00\x00\x00".b + buffer,
+        "\x30\x82\xff\xff".b + buffer,
+        "\x30\x7f".b + signatures.first.der_encoded
+      ].each do |hostile|
+        expect do
+          Secp256k1::Signature.each_der_encoded(hostile).to_a
+        end.to raise_error(
+          Secp256k1::DeserializationError,
+          'invalid DER encoded signature at offset 0'
+        )
+      end
+    end
+
+    it 'locks the buffer while iterating' do
+      expect do
+        Secp256k1::Signature.each_der_encoded(buffer) { buffer << "\x00".b }
+      end.to raise_error(RuntimeError)
+      expect { buffer << "\x00".b }.not_to raise_error
+    end
+  end
+
+  describe '.der_encoded_to_compact' do
+    it 'returns the compact form of every signature' do
+      signatures = Array.new(4) do |i|
+        context.sign(key_pair.private_key, sha256(i.to_s))
+      end
+
+      result = Secp256k1::Signature.der_encoded_to_compact(
+        signatures.map(&:der_encoded).join
+      )
+
+      expect(result).to eq(signatures.map(&:compact).join)
+    end
+
+    it 'returns an empty string for an empty buffer' do
+      expect(Secp256k1::Signature.der_encoded_to_compact(''.b)).to eq(''.b)
+    end
+
+    it 'raises an error if the buffer is not a String or IO::Buffer' do
+      expect do
+        Secp256k1::Signature.der_encoded_to_compact(123)
+      end.to raise_error(TypeError)
+    end
   end
 
   describe '#der_encoded' do
@@ -60,21 +211,6 @@ RSpec.describe Secp256k1::Signature do
   end
 
   describe '#normalized' do
-    # Data taken from https://github.com/rust-bitcoin/rust-secp256k1/blob/master/src/lib.rs
-    # Original note:
-    # nb this is a transaction on testnet
-    # txid 8ccc87b72d766ab3128f03176bb1c98293f2d1f85ebfaf07b82cc81ea6891fa9
-    #      input number 3
-    let(:unnormalized_der_sig) do
-      '3046022100839c1fbc5304de944f697c9f4b1d01d1faeba32d751c0f7acb21ac8a0f436a72022100e89bd46bb3a5a62adc679f659b7ce876d83ee297c7a5587b2011c4fcc72eab45'
-    end
-    let(:public_key_data) do
-      '031ee99d2b786ab3b0991325f2de8489246a6a3fdb700f6d0511b1d80cf5f4cd43'
-    end
-    let(:message_hash) do
-      'a4965ca63b7d8562736ceec36dfa5a11bf426eb65be8ea3f7a49ae363032da0d'
-    end
-
     it 'returns the normalized form of the signature' do
       was_normalized, normalized = signature.normalized
 
@@ -83,6 +219,12 @@ RSpec.describe Secp256k1::Signature do
       expect(normalized).to eq(signature)
     end
 
+    it 'returns the signature itself if it is already normalized' do
+      _, normalized = signature.normalized
+
+      expect(normalized).to be(signature)
+    end
+
     it 'computes normalized form of signature' do
       signature = Secp256k1::Signature.from_der_encoded(
         Secp256k1::Util.hex_to_bin(unnormalized_der_sig)
@@ -93,4 +235,114 @@ RSpec.describe Secp256k1::Signature do
       expect(normalized).not_to eq(signature)
     end
   end
+
+  describe '#low_s?' do
+    it 'returns true for signatures produced by the library' do
+      expect(signature.low_s?).to be true
+    end
+
+    it 'returns false for signatures with a high S value' do
+      signature = Secp256k1::Signature.from_compact(
+        Secp256k1::Util.hex_to_bin(unnormalized_compact_sig)
+      )
+
+      expect(signature.low_s?).to be false
+    end
+  end
+
+  describe '#hash' do
+    it 'allows equal signatures to be used as the same hash key' do
+      copy = Secp256k1::Signature.from_compact(signature.compact)
+
+      expect(copy.hash).to eq(signature.hash)
+      expect(copy).to eql(signature)
+      expect([copy, signature].uniq.length).to eq(1)
+    end
+
+    it 'differs for different signatures' do
+      other = context.sign(key_pair.private_key, sha256('other message'))
+
+      expect(other.hash).not_to eq(signature.hash)
+    end
+  end
+
+  describe '#eql?' do
+    it 'returns false for objects that are not signatures' do
+      expect(signature).not_to eql(signature.compact)
+    end
+  end
+
+  if defined?(Ractor)
+    describe '#freeze' do
+      it 'makes the signature shareable with other Ractors' do
+        expect(Ractor.shareable?(signature.freeze)).to be true
+      end
+    end
+  end
+
+  describe '#write_compact' do
+    it 'appends the compact signature to a string' do
+      buffer = 'prefix'.b
+
+      expect(signature.write_compact(buffer)).to eq(70)
+      expect(buffer).to eq('prefix'.b + signature.compact)
+    end
+
+    it 'writes the compact signature at an offset' do
+      buffer = "\x00".b * 80
+
+      expect(signature.write_compact(buffer, 10)).to eq(74)
+      expect(buffer.byteslice(10, 64)).to eq(signature.compact)
+      expect(buffer.length).to eq(80)
+    end
+
+    it 'grows a string when writing past its end' do
+      buffer = "\x00".b * 10
+
+      expect(signature.write_compact(buffer, 10)).to eq(74)
+      expect(buffer.byteslice(10, 64)).to eq(signature.compact)
+    end
+
+    it 'writes into an IO::Buffer', if: defined?(IO::Buffer) do
+      buffer = IO::Buffer.new(128)
+
+      expect(signature.write_compact(buffer, 64)).to eq(128)
+      expect(buffer.get_string(64, 64)).to eq(signature.compact)
+    end
+
+    it 'raises an error if an IO::Buffer is too small', if: defined?(IO::Buffer) do
+      expect do
+        signature.write_compact(IO::Buffer.new(32), 0)
+      end.to raise_error(Secp256k1::Error, 'buffer is too small')
+    end
+
+    it 'raises an error if the offset is outside of the string' do
+      expect do
+        signature.write_compact(+'', 1)
+      end.to raise_error(Secp256k1::Error, 'offset is outside of the buffer')
+    end
+
+    it 'raises an error if the string is frozen' do
+      expect do
+        signature.write_compact('frozen')
+      end.to raise_error(FrozenError)
+    end
+
+    it 'raises an error if the buffer is not a string or IO::Buffer' do
+      expect do
+        signature.write_compact([])
+      end.to raise_error(TypeError)
+    end
+  end
+
+  describe '#write_der_encoded' do
+    it 'appends the DER encoded signature and returns the new offset' do
+      buffer = String.new
+      offset = signature.write_der_encoded(buffer)
+      offset = signature.write_der_encoded(buffer, offset)
+
+      expect(offset).to eq(2 * signature.der_encoded.length)
+      expect(buffer).to eq(signature.der_encoded * 2)
+    end
+  end
 end
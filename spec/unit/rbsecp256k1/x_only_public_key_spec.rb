@@ -0,0 +1,55 @@
+# frozen_string_literal: true
+
+require 'spec_helper'
+
+if Secp256k1.have_schnorrsig?
+  RSpec.describe Secp256k1::XOnlyPublicKey do
+    let(:context) { Secp256k1::Context.create }
+    let(:key_pair) { context.generate_key_pair }
+    let(:message) { sha256('schnorr test message') }
+
+    describe '.from_data' do
+      it 'round trips the serialized x-only public key' do
+        x_only_public_key = key_pair.public_key.to_x_only
+
+        loaded = Secp256k1::XOnlyPublicKey.from_data(x_only_public_key.data)
+
+        expect(loaded).to eq(x_only_public_key)
+      end
+
+      it 'raises an error if data is not 32 bytes' do
+        expect do
+          Secp256k1::XOnlyPublicKey.from_data("\x02" * 33)
+        end.to raise_error(Secp256k1::DeserializationError)
+      end
+    end
+
+    describe '#data' do
+      it 'matches the x coordinate of the compressed public key' do
+        x_only_public_key = key_pair.public_key.to_x_only
+
+        expect(x_only_public_key.data.length).to eq(32)
+        expect(x_only_public_key.data).to eq(key_pair.public_key.compressed[1..])
+      end
+    end
+
+    describe '#hash' do
+      it 'allows equal keys to be used as the same hash key' do
+        x_only_public_key = key_pair.public_key.to_x_only
+        copy = Secp256k1::XOnlyPublicKey.from_data(x_only_public_key.data)
+
+        expect(copy.hash).to eq(x_only_public_key.hash)
+        expect(copy).to eql(x_only_public_key)
+        expect({ x_only_public_key => 1, copy => 2 }.size).to eq(1)
+      end
+    end
+
+    describe '#eql?' do
+      it 'returns false for objects that are not x-only public keys' do
+        x_only_public_key = key_pair.public_key.to_x_only
+
+        expect(x_only_public_key).not_to eql(x_only_public_key.data)
+      end
+    end
+  end
+end
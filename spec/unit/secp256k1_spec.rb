@@ -24,4 +24,10 @@ RSpec.describe Secp256k1 do
       expect(Secp256k1.have_ecdh?).to eq(with_ecdh)
     end
   end
+
+  describe '.have_schnorrsig?' do
+    it 'reports whether the schnorrsig module is available' do
+      expect([true, false]).to include(Secp256k1.have_schnorrsig?)
+    end
+  end
 end